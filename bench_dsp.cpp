@@ -0,0 +1,53 @@
+// DSP kernel cycle counts on target - compile and upload with env:dsp-bench
+#include <Arduino.h>
+#include "AudioDsp.h"
+
+static const size_t N = 256;            // One capture frame
+static const int ITERATIONS = 1000;
+
+static int16_t stereo[N * 2];
+static int16_t mono[N];
+static volatile uint32_t sink;
+
+template <class Op>
+static void bench(const char* name, Op op) {
+    op();  // Warm caches
+    uint32_t best = UINT32_MAX;
+    uint64_t total = 0;
+    for (int i = 0; i < ITERATIONS; i++) {
+        uint32_t start = AudioDsp::cycleCount();
+        op();
+        uint32_t cycles = AudioDsp::cycleCount() - start;
+        total += cycles;
+        if (cycles < best) best = cycles;
+    }
+    Serial.printf("%-24s best %6u cycles  avg %6u cycles  %5.2f cycles/sample\n",
+                  name, best, (uint32_t)(total / ITERATIONS), (float)best / N);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(2000);
+
+    Serial.println("\n========================================");
+    Serial.println("     DSP KERNEL BENCH - ESP32-KORVO");
+    Serial.println("========================================\n");
+    Serial.printf("CPU Freq: %d MHz, frame = %d samples\n\n", ESP.getCpuFreqMHz(), N);
+
+    for (size_t i = 0; i < N * 2; i++) stereo[i] = (int16_t)(i * 97);
+
+    const int16_t weights[] = {AudioDsp::Q15_HALF, AudioDsp::Q15_HALF};
+    AudioDsp::DcBlocker dc;
+
+    bench("downmixStereo", []() { AudioDsp::downmixStereo(stereo, mono, N); });
+    bench("downmix (weighted)", [&]() { AudioDsp::downmix(stereo, mono, N, 2, weights); });
+    bench("applyGain", []() { sink = AudioDsp::applyGain(mono, N, AudioDsp::GAIN_UNITY + 100); });
+    bench("measureLevel", []() { sink = AudioDsp::measureLevel(mono, N).peak; });
+    bench("removeDc", [&]() { AudioDsp::removeDc(dc, mono, N); });
+
+    Serial.println("\nDone");
+}
+
+void loop() {
+    delay(1000);
+}
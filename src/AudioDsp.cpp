@@ -0,0 +1,227 @@
+#include "AudioDsp.h"
+#include <math.h>
+
+#if defined(__XTENSA__)
+#include <xtensa/config/core-isa.h>
+#endif
+
+#if defined(__XTENSA__) && XCHAL_HAVE_MAC16
+#define AUDIO_DSP_MAC16 1
+#else
+#define AUDIO_DSP_MAC16 0
+#endif
+
+namespace AudioDsp {
+
+void downmixStereo(const int16_t* stereo, int16_t* mono, size_t frames) {
+    size_t i = 0;
+    for (; i + 4 <= frames; i += 4) {
+        const int16_t* s = stereo + i * 2;
+        int16_t a = (s[0] + s[1]) / 2;
+        int16_t b = (s[2] + s[3]) / 2;
+        int16_t c = (s[4] + s[5]) / 2;
+        int16_t d = (s[6] + s[7]) / 2;
+        mono[i] = a;
+        mono[i + 1] = b;
+        mono[i + 2] = c;
+        mono[i + 3] = d;
+    }
+    for (; i < frames; i++) {
+        mono[i] = (stereo[i * 2] + stereo[i * 2 + 1]) / 2;
+    }
+}
+
+void downmix(const int16_t* in, int16_t* out, size_t frames, size_t channels,
+             const int16_t* weightsQ15) {
+    if (channels == 2) {
+        // Hot path: the I2S RX format on this board
+        const int32_t wl = weightsQ15[0];
+        const int32_t wr = weightsQ15[1];
+        size_t i = 0;
+        for (; i + 2 <= frames; i += 2) {
+            const int16_t* s = in + i * 2;
+            int32_t a = (s[0] * wl + s[1] * wr) >> 15;
+            int32_t b = (s[2] * wl + s[3] * wr) >> 15;
+            out[i] = saturate16(a);
+            out[i + 1] = saturate16(b);
+        }
+        for (; i < frames; i++) {
+            out[i] = saturate16((in[i * 2] * wl + in[i * 2 + 1] * wr) >> 15);
+        }
+        return;
+    }
+
+    for (size_t i = 0; i < frames; i++) {
+        const int16_t* s = in + i * channels;
+        int32_t acc = 0;
+        for (size_t c = 0; c < channels; c++) acc += s[c] * (int32_t)weightsQ15[c];
+        out[i] = saturate16(acc >> 15);
+    }
+}
+
+void unpackTdm(const uint32_t* words, size_t slots, int16_t* out, size_t frames,
+               size_t channels) {
+    const size_t stride = slots / 2;
+    for (size_t i = 0; i < frames; i++) {
+        const uint32_t* w = words + i * stride;
+        for (size_t c = 0; c < channels; c++) {
+            uint32_t word = w[c >> 1];
+            *out++ = (int16_t)((c & 1) ? (word & 0xFFFF) : (word >> 16));
+        }
+    }
+}
+
+size_t applyGain(int16_t* pcm, size_t n, int32_t gainQ12) {
+    if (gainQ12 == GAIN_UNITY) return 0;
+
+    size_t clipped = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32_t a = (pcm[i] * gainQ12) >> 12;
+        int32_t b = (pcm[i + 1] * gainQ12) >> 12;
+        int32_t c = (pcm[i + 2] * gainQ12) >> 12;
+        int32_t d = (pcm[i + 3] * gainQ12) >> 12;
+        clipped += (a > 32767 || a < -32768) + (b > 32767 || b < -32768) +
+                   (c > 32767 || c < -32768) + (d > 32767 || d < -32768);
+        pcm[i] = saturate16(a);
+        pcm[i + 1] = saturate16(b);
+        pcm[i + 2] = saturate16(c);
+        pcm[i + 3] = saturate16(d);
+    }
+    for (; i < n; i++) {
+        int32_t v = (pcm[i] * gainQ12) >> 12;
+        clipped += (v > 32767 || v < -32768);
+        pcm[i] = saturate16(v);
+    }
+    return clipped;
+}
+
+#if AUDIO_DSP_MAC16
+// MAC16 accumulator: 40 bits, so sum at most 256 full-scale squares per block
+static inline void macClear() {
+    int32_t zero = 0;
+    __asm__ __volatile__("wsr %0, acclo\n\twsr %0, acchi" :: "r"(zero));
+}
+
+static inline void macSquare(int32_t x) {
+    __asm__ __volatile__("mula.aa.ll %0, %0" :: "r"(x));
+}
+
+static inline uint64_t macRead() {
+    uint32_t lo, hi;
+    __asm__ __volatile__("rsr %0, acclo\n\trsr %1, acchi" : "=r"(lo), "=r"(hi));
+    return ((uint64_t)(hi & 0xFF) << 32) | lo;
+}
+#endif
+
+static inline void track(int32_t v, int32_t& maxV, int32_t& minV) {
+    if (v > maxV) maxV = v;
+    if (v < minV) minV = v;
+}
+
+Level measureLevel(const int16_t* pcm, size_t n) {
+    Level level;
+    level.count = n;
+    int32_t maxV = 0;
+    int32_t minV = 0;
+    uint64_t energy = 0;
+
+#if AUDIO_DSP_MAC16
+    size_t i = 0;
+    while (i < n) {
+        size_t end = (n - i > 256) ? i + 256 : n;
+        macClear();
+        for (; i + 4 <= end; i += 4) {
+            int32_t a = pcm[i], b = pcm[i + 1], c = pcm[i + 2], d = pcm[i + 3];
+            macSquare(a);
+            macSquare(b);
+            macSquare(c);
+            macSquare(d);
+            track(a, maxV, minV);
+            track(b, maxV, minV);
+            track(c, maxV, minV);
+            track(d, maxV, minV);
+        }
+        for (; i < end; i++) {
+            int32_t a = pcm[i];
+            macSquare(a);
+            track(a, maxV, minV);
+        }
+        energy += macRead();
+    }
+#else
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        int32_t a = pcm[i], b = pcm[i + 1], c = pcm[i + 2], d = pcm[i + 3];
+        energy += (uint32_t)(a * a) + (uint32_t)(b * b);
+        energy += (uint32_t)(c * c) + (uint32_t)(d * d);
+        track(a, maxV, minV);
+        track(b, maxV, minV);
+        track(c, maxV, minV);
+        track(d, maxV, minV);
+    }
+    for (; i < n; i++) {
+        int32_t a = pcm[i];
+        energy += (uint32_t)(a * a);
+        track(a, maxV, minV);
+    }
+#endif
+
+    level.peak = (uint16_t)((-minV > maxV) ? -minV : maxV);
+    level.energy = energy;
+    return level;
+}
+
+uint16_t Level::rms() const {
+    if (count == 0) return 0;
+    uint32_t r = isqrt64(energy / count);
+    return r > 32768 ? 32768 : (uint16_t)r;
+}
+
+void removeDc(DcBlocker& st, int16_t* pcm, size_t n) {
+    int32_t x1 = st.x1;
+    int32_t y1 = st.y1;
+    const int64_t a = st.coeffQ15;
+
+    for (size_t i = 0; i < n; i++) {
+        int32_t x = pcm[i];
+        y1 = (x - x1) * 256 + (int32_t)((a * y1) >> 15);
+        x1 = x;
+        pcm[i] = saturate16(y1 >> 8);
+    }
+
+    st.x1 = (int16_t)x1;
+    st.y1 = y1;
+}
+
+uint32_t isqrt64(uint64_t v) {
+    uint64_t result = 0;
+    uint64_t bit = (uint64_t)1 << 62;
+    while (bit > v) bit >>= 2;
+    while (bit) {
+        if (v >= result + bit) {
+            v -= result + bit;
+            result = (result >> 1) + bit;
+        } else {
+            result >>= 1;
+        }
+        bit >>= 2;
+    }
+    return (uint32_t)result;
+}
+
+float goertzelPower(const int16_t* pcm, size_t n, size_t stride, float freqHz,
+                    uint32_t sampleRate) {
+    if (n == 0) return 0;
+    const float coeff = 2.0f * cosf(2.0f * (float)M_PI * freqHz / sampleRate);
+    float s1 = 0, s2 = 0;
+    for (size_t i = 0; i < n; i++) {
+        float s0 = pcm[i * stride] + coeff * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+    float power = s1 * s1 + s2 * s2 - coeff * s1 * s2;  // |X(f)|^2
+    return 2.0f * power / ((float)n * n);
+}
+
+}  // namespace AudioDsp
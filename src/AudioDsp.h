@@ -0,0 +1,87 @@
+#ifndef AUDIO_DSP_H
+#define AUDIO_DSP_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#if defined(__XTENSA__)
+#include <xtensa/hal.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Portable PCM kernels used by the capture and playback paths.
+// No Arduino dependencies, so they also build in the native test env.
+//
+// Inner loops are unrolled by four. On the ESP32 the sum of squares runs on
+// the MAC16 unit (40-bit accumulator, one MULA per sample); elsewhere it
+// falls back to a 64-bit accumulate.
+
+namespace AudioDsp {
+
+static const int16_t Q15_HALF = 16384;
+static const int32_t GAIN_UNITY = 4096;  // Q12: 1.0
+
+inline int16_t saturate16(int32_t v) {
+    if (v > 32767) return 32767;
+    if (v < -32768) return -32768;
+    return (int16_t)v;
+}
+
+// CPU cycle counter for benchmarks (CCOUNT on Xtensa, TSC on x86, else 0).
+inline uint32_t cycleCount() {
+#if defined(__XTENSA__)
+    return xthal_get_ccount();
+#elif defined(__x86_64__) || defined(__i386__)
+    return (uint32_t)__rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Interleaved stereo -> mono, (L + R) / 2. mono may alias stereo.
+void downmixStereo(const int16_t* stereo, int16_t* mono, size_t frames);
+
+// Interleaved N-channel -> mono with per-channel Q15 weights, saturating.
+// out may alias in.
+void downmix(const int16_t* in, int16_t* out, size_t frames, size_t channels,
+             const int16_t* weightsQ15);
+
+// TDM slots carried as 32-bit stereo words -> interleaved 16-bit channels.
+// Slot k of a frame is the high (even k) or low (odd k) half of word k / 2;
+// the first `channels` of `slots` slots are kept.
+void unpackTdm(const uint32_t* words, size_t slots, int16_t* out, size_t frames,
+               size_t channels);
+
+// Saturating gain, Q12 (GAIN_UNITY = 1.0). Returns how many samples clipped.
+size_t applyGain(int16_t* pcm, size_t n, int32_t gainQ12);
+
+// Peak and energy in a single pass.
+struct Level {
+    uint16_t peak;      // max |x|, 0..32768
+    uint64_t energy;    // sum of x^2
+    uint32_t count;     // samples measured
+
+    uint16_t rms() const;
+};
+Level measureLevel(const int16_t* pcm, size_t n);
+
+// One-pole DC blocker: y[n] = x[n] - x[n-1] + a * y[n-1].
+// The feedback state keeps 8 extra fractional bits to avoid limit cycles.
+struct DcBlocker {
+    int16_t coeffQ15 = 32604;   // a = 0.995 (~19 Hz corner @ 24 kHz)
+    int16_t x1 = 0;
+    int32_t y1 = 0;             // Q8 extended
+};
+void removeDc(DcBlocker& state, int16_t* pcm, size_t n);
+
+uint32_t isqrt64(uint64_t v);
+
+// Goertzel: mean power of the freqHz component (A^2 / 2 for a sine of
+// amplitude A) in n samples read every `stride` entries of pcm.
+float goertzelPower(const int16_t* pcm, size_t n, size_t stride, float freqHz,
+                    uint32_t sampleRate);
+
+}  // namespace AudioDsp
+
+#endif
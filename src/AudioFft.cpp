@@ -0,0 +1,316 @@
+#include "AudioFft.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+RealFft::~RealFft() {
+    free(_twiddle);
+    free(_split);
+    free(_bitrev);
+}
+
+bool RealFft::begin(size_t n) {
+    if (n < 4 || (n & (n - 1)) || n / 2 > 65535) return false;
+
+    free(_twiddle);
+    free(_split);
+    free(_bitrev);
+    _n = n;
+    size_t half = n / 2;
+    _twiddle = (float*)malloc(sizeof(float) * 2 * (half / 2));
+    _split = (float*)malloc(sizeof(float) * 2 * half);
+    _bitrev = (uint16_t*)malloc(sizeof(uint16_t) * half);
+    if (!_twiddle || !_split || !_bitrev) {
+        _n = 0;
+        return false;
+    }
+
+    for (size_t k = 0; k < half / 2; k++) {
+        double a = -2.0 * M_PI * k / half;
+        _twiddle[2 * k] = (float)cos(a);
+        _twiddle[2 * k + 1] = (float)sin(a);
+    }
+    for (size_t k = 0; k < half; k++) {
+        double a = -2.0 * M_PI * k / n;
+        _split[2 * k] = (float)cos(a);
+        _split[2 * k + 1] = (float)sin(a);
+    }
+
+    size_t bits = 0;
+    while (((size_t)1 << bits) < half) bits++;
+    for (size_t i = 0; i < half; i++) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++) {
+            if (i & ((size_t)1 << b)) r |= (size_t)1 << (bits - 1 - b);
+        }
+        _bitrev[i] = (uint16_t)r;
+    }
+    return true;
+}
+
+// In-place iterative radix-2 on n/2 interleaved complex values
+void RealFft::complexFft(float* z, bool inverse) {
+    const size_t m = _n / 2;
+
+    for (size_t i = 0; i < m; i++) {
+        size_t j = _bitrev[i];
+        if (j > i) {
+            float tr = z[2 * i], ti = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = tr;
+            z[2 * j + 1] = ti;
+        }
+    }
+
+    const float sign = inverse ? -1.0f : 1.0f;
+    for (size_t len = 2; len <= m; len <<= 1) {
+        size_t halfLen = len / 2;
+        size_t step = m / len;
+        for (size_t start = 0; start < m; start += len) {
+            for (size_t k = 0; k < halfLen; k++) {
+                float wr = _twiddle[2 * k * step];
+                float wi = sign * _twiddle[2 * k * step + 1];
+                float* a = z + 2 * (start + k);
+                float* b = z + 2 * (start + k + halfLen);
+                float br = b[0] * wr - b[1] * wi;
+                float bi = b[0] * wi + b[1] * wr;
+                b[0] = a[0] - br;
+                b[1] = a[1] - bi;
+                a[0] += br;
+                a[1] += bi;
+            }
+        }
+    }
+}
+
+void RealFft::forward(const float* in, float* out) {
+    const size_t m = _n / 2;
+
+    // Pack even/odd samples as one complex sequence of half the length
+    memcpy(out, in, sizeof(float) * _n);
+    complexFft(out, false);
+
+    // Split: X[k] = (Z[k] + Z*[m-k]) / 2 - i W^k (Z[k] - Z*[m-k]) / 2
+    float z0r = out[0], z0i = out[1];
+    out[0] = z0r + z0i;
+    out[1] = 0;
+    out[2 * m] = z0r - z0i;
+    out[2 * m + 1] = 0;
+
+    for (size_t k = 1; k <= m / 2; k++) {
+        size_t j = m - k;
+        float ar = out[2 * k], ai = out[2 * k + 1];
+        float br = out[2 * j], bi = out[2 * j + 1];
+
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai - bi);   // Even part
+        float orr = 0.5f * (ai + bi), oi = -0.5f * (ar - br); // Odd part (times -i)
+
+        float wr = _split[2 * k], wi = _split[2 * k + 1];
+        float tr = orr * wr - oi * wi;
+        float ti = orr * wi + oi * wr;
+        out[2 * k] = er + tr;
+        out[2 * k + 1] = ei + ti;
+
+        // Mirror bin j uses conj symmetry of the even/odd parts
+        float wjr = _split[2 * j], wji = _split[2 * j + 1];
+        float tjr = orr * wjr + oi * wji;
+        float tji = orr * wji - oi * wjr;
+        out[2 * j] = er + tjr;
+        out[2 * j + 1] = -ei + tji;
+    }
+}
+
+void RealFft::inverse(const float* in, float* out) {
+    const size_t m = _n / 2;
+
+    // Undo the split into Z[k] = E[k] + i O[k], E/O from X[k] and X*[m-k]
+    float x0 = in[0], xm = in[2 * m];
+    out[0] = 0.5f * (x0 + xm);
+    out[1] = 0.5f * (x0 - xm);
+
+    for (size_t k = 1; k < m; k++) {
+        size_t j = m - k;
+        float ar = in[2 * k], ai = in[2 * k + 1];
+        float br = in[2 * j], bi = -in[2 * j + 1];  // X*[m-k]
+
+        float er = 0.5f * (ar + br), ei = 0.5f * (ai + bi);
+        float dr = 0.5f * (ar - br), di = 0.5f * (ai - bi);
+
+        // O[k] = (X[k] - X*[m-k]) / 2 * conj(W^k)
+        float wr = _split[2 * k], wi = -_split[2 * k + 1];
+        float orr = dr * wr - di * wi;
+        float oi = dr * wi + di * wr;
+
+        // Z[k] = E[k] + i O[k]
+        out[2 * k] = er - oi;
+        out[2 * k + 1] = ei + orr;
+    }
+
+    complexFft(out, true);
+
+    const float scale = 1.0f / m;
+    for (size_t i = 0; i < _n; i++) out[i] *= scale;
+}
+
+// ---------------------------------------------------------------------------
+// Fixed point
+// ---------------------------------------------------------------------------
+
+static inline int16_t q15(double v) {
+    long r = lround(v * 32768.0);
+    if (r > 32767) r = 32767;
+    if (r < -32768) r = -32768;
+    return (int16_t)r;
+}
+
+// a * w (Q15), rounded
+static inline int32_t mulQ15(int32_t a, int32_t w) {
+    return (int32_t)(((int64_t)a * w + 16384) >> 15);
+}
+
+RealFftFixed::~RealFftFixed() {
+    free(_twiddle);
+    free(_split);
+    free(_bitrev);
+}
+
+bool RealFftFixed::begin(size_t n) {
+    if (n < 4 || (n & (n - 1)) || n / 2 > 65535) return false;
+
+    free(_twiddle);
+    free(_split);
+    free(_bitrev);
+    _n = n;
+    size_t half = n / 2;
+    _twiddle = (int16_t*)malloc(sizeof(int16_t) * 2 * (half / 2));
+    _split = (int16_t*)malloc(sizeof(int16_t) * 2 * half);
+    _bitrev = (uint16_t*)malloc(sizeof(uint16_t) * half);
+    if (!_twiddle || !_split || !_bitrev) {
+        _n = 0;
+        return false;
+    }
+
+    for (size_t k = 0; k < half / 2; k++) {
+        double a = -2.0 * M_PI * k / half;
+        _twiddle[2 * k] = q15(cos(a));
+        _twiddle[2 * k + 1] = q15(sin(a));
+    }
+    for (size_t k = 0; k < half; k++) {
+        double a = -2.0 * M_PI * k / n;
+        _split[2 * k] = q15(cos(a));
+        _split[2 * k + 1] = q15(sin(a));
+    }
+
+    size_t bits = 0;
+    while (((size_t)1 << bits) < half) bits++;
+    for (size_t i = 0; i < half; i++) {
+        size_t r = 0;
+        for (size_t b = 0; b < bits; b++) {
+            if (i & ((size_t)1 << b)) r |= (size_t)1 << (bits - 1 - b);
+        }
+        _bitrev[i] = (uint16_t)r;
+    }
+    return true;
+}
+
+// Forward stages halve (a + wb) / 2 to stay in range; inverse stages do not
+void RealFftFixed::complexFft(int32_t* z, bool inverse) {
+    const size_t m = _n / 2;
+
+    for (size_t i = 0; i < m; i++) {
+        size_t j = _bitrev[i];
+        if (j > i) {
+            int32_t tr = z[2 * i], ti = z[2 * i + 1];
+            z[2 * i] = z[2 * j];
+            z[2 * i + 1] = z[2 * j + 1];
+            z[2 * j] = tr;
+            z[2 * j + 1] = ti;
+        }
+    }
+
+    const int shift = inverse ? 0 : 1;
+    const int32_t round = inverse ? 0 : 1;
+    for (size_t len = 2; len <= m; len <<= 1) {
+        size_t halfLen = len / 2;
+        size_t step = m / len;
+        for (size_t start = 0; start < m; start += len) {
+            for (size_t k = 0; k < halfLen; k++) {
+                int32_t wr = _twiddle[2 * k * step];
+                int32_t wi = _twiddle[2 * k * step + 1];
+                if (inverse) wi = -wi;
+                int32_t* a = z + 2 * (start + k);
+                int32_t* b = z + 2 * (start + k + halfLen);
+                int32_t br = mulQ15(b[0], wr) - mulQ15(b[1], wi);
+                int32_t bi = mulQ15(b[0], wi) + mulQ15(b[1], wr);
+                int32_t ar = a[0], ai = a[1];
+                b[0] = ((ar - br) + round) >> shift;
+                b[1] = ((ai - bi) + round) >> shift;
+                a[0] = ((ar + br) + round) >> shift;
+                a[1] = ((ai + bi) + round) >> shift;
+            }
+        }
+    }
+}
+
+void RealFftFixed::forward(const int32_t* in, int32_t* out) {
+    const size_t m = _n / 2;
+    memcpy(out, in, sizeof(int32_t) * _n);
+    complexFft(out, false);
+
+    // Same split as RealFft::forward, with the /2 folded into the shifts
+    int32_t z0r = out[0], z0i = out[1];
+    out[0] = z0r + z0i;
+    out[1] = 0;
+    out[2 * m] = z0r - z0i;
+    out[2 * m + 1] = 0;
+
+    for (size_t k = 1; k <= m / 2; k++) {
+        size_t j = m - k;
+        int32_t ar = out[2 * k], ai = out[2 * k + 1];
+        int32_t br = out[2 * j], bi = out[2 * j + 1];
+
+        int32_t er = (ar + br) >> 1, ei = (ai - bi) >> 1;
+        int32_t orr = (ai + bi) >> 1, oi = -((ar - br) >> 1);
+
+        int32_t wr = _split[2 * k], wi = _split[2 * k + 1];
+        int32_t tr = mulQ15(orr, wr) - mulQ15(oi, wi);
+        int32_t ti = mulQ15(orr, wi) + mulQ15(oi, wr);
+        out[2 * k] = er + tr;
+        out[2 * k + 1] = ei + ti;
+
+        int32_t wjr = _split[2 * j], wji = _split[2 * j + 1];
+        int32_t tjr = mulQ15(orr, wjr) + mulQ15(oi, wji);
+        int32_t tji = mulQ15(orr, wji) - mulQ15(oi, wjr);
+        out[2 * j] = er + tjr;
+        out[2 * j + 1] = -ei + tji;
+    }
+}
+
+void RealFftFixed::inverse(const int32_t* in, int32_t* out) {
+    const size_t m = _n / 2;
+
+    // The forward transform scaled by 1/m; the /2 here and m from the
+    // unscaled stages bring it back to the input
+    int32_t x0 = in[0], xm = in[2 * m];
+    out[0] = (x0 + xm) >> 1;
+    out[1] = (x0 - xm) >> 1;
+
+    for (size_t k = 1; k < m; k++) {
+        size_t j = m - k;
+        int32_t ar = in[2 * k], ai = in[2 * k + 1];
+        int32_t br = in[2 * j], bi = -in[2 * j + 1];
+
+        int32_t er = (ar + br) >> 1, ei = (ai + bi) >> 1;
+        int32_t dr = (ar - br) >> 1, di = (ai - bi) >> 1;
+
+        int32_t wr = _split[2 * k], wi = -_split[2 * k + 1];
+        int32_t orr = mulQ15(dr, wr) - mulQ15(di, wi);
+        int32_t oi = mulQ15(dr, wi) + mulQ15(di, wr);
+
+        out[2 * k] = er - oi;
+        out[2 * k + 1] = ei + orr;
+    }
+
+    complexFft(out, true);
+}
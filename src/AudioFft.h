@@ -0,0 +1,74 @@
+#ifndef AUDIO_FFT_H
+#define AUDIO_FFT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Real-input FFT (single precision) for the block-frequency-domain filters.
+//
+// A length-n real transform is computed as an n/2-point complex radix-2 FFT
+// plus a split pass, so it costs about half a complex FFT. Spectra are
+// stored as n/2 + 1 interleaved (re, im) pairs: bins 0 .. n/2.
+// The ESP32 FPU does single-precision only, hence float throughout.
+//
+// RealFftFixed is the same transform on int32 data with Q15 twiddles, for
+// the capture path where the per-frame budget matters more than range.
+
+class RealFft {
+public:
+    RealFft() {}
+    ~RealFft();
+
+    // n: power of two >= 4
+    bool begin(size_t n);
+    size_t size() const { return _n; }
+
+    // in: n samples -> out: n + 2 floats
+    void forward(const float* in, float* out);
+
+    // in: n + 2 floats -> out: n samples (exact inverse of forward)
+    void inverse(const float* in, float* out);
+
+private:
+    size_t _n = 0;
+    float* _twiddle = nullptr;   // n/4 complex: e^{-2 pi i k / (n/2)}
+    float* _split = nullptr;     // n/2 complex: e^{-2 pi i k / n}
+    uint16_t* _bitrev = nullptr; // n/2
+
+    RealFft(const RealFft&) = delete;
+    RealFft& operator=(const RealFft&) = delete;
+
+    void complexFft(float* z, bool inverse);
+};
+
+class RealFftFixed {
+public:
+    RealFftFixed() {}
+    ~RealFftFixed();
+
+    // n: power of two >= 4
+    bool begin(size_t n);
+    size_t size() const { return _n; }
+
+    // in: n samples -> out: n + 2 values. Every complex stage halves, so
+    // out = DFT(in) * 2 / n and nothing overflows for |in| < 2^30.
+    void forward(const int32_t* in, int32_t* out);
+
+    // in: n + 2 values -> out: n samples. Unscaled stages, so
+    // inverse(forward(x)) == x; keep |in| small enough that the sum of all
+    // bin magnitudes fits in 31 bits.
+    void inverse(const int32_t* in, int32_t* out);
+
+private:
+    size_t _n = 0;
+    int16_t* _twiddle = nullptr;   // n/4 complex, Q15
+    int16_t* _split = nullptr;     // n/2 complex, Q15
+    uint16_t* _bitrev = nullptr;   // n/2
+
+    RealFftFixed(const RealFftFixed&) = delete;
+    RealFftFixed& operator=(const RealFftFixed&) = delete;
+
+    void complexFft(int32_t* z, bool inverse);
+};
+
+#endif
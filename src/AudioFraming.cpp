@@ -0,0 +1,75 @@
+#include "AudioFraming.h"
+#include <stdlib.h>
+#include <string.h>
+
+namespace AudioFraming {
+
+static const char B64_TABLE[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+static const char APPEND_PREFIX[] = "{\"type\":\"input_audio_buffer.append\",\"audio\":\"";
+static const char APPEND_SUFFIX[] = "\"}";
+static const size_t APPEND_PREFIX_LEN = sizeof(APPEND_PREFIX) - 1;
+static const size_t APPEND_SUFFIX_LEN = sizeof(APPEND_SUFFIX) - 1;
+
+size_t base64Encode(const uint8_t* in, size_t len, char* out) {
+    char* p = out;
+    size_t i = 0;
+
+    for (; i + 3 <= len; i += 3) {
+        uint32_t v = ((uint32_t)in[i] << 16) | ((uint32_t)in[i + 1] << 8) | in[i + 2];
+        p[0] = B64_TABLE[(v >> 18) & 0x3F];
+        p[1] = B64_TABLE[(v >> 12) & 0x3F];
+        p[2] = B64_TABLE[(v >> 6) & 0x3F];
+        p[3] = B64_TABLE[v & 0x3F];
+        p += 4;
+    }
+
+    size_t rest = len - i;
+    if (rest) {
+        uint32_t v = (uint32_t)in[i] << 16;
+        if (rest == 2) v |= (uint32_t)in[i + 1] << 8;
+        p[0] = B64_TABLE[(v >> 18) & 0x3F];
+        p[1] = B64_TABLE[(v >> 12) & 0x3F];
+        p[2] = rest == 2 ? B64_TABLE[(v >> 6) & 0x3F] : '=';
+        p[3] = '=';
+        p += 4;
+    }
+
+    return p - out;
+}
+
+size_t appendFrameLength(size_t len) {
+    return APPEND_PREFIX_LEN + base64Length(len) + APPEND_SUFFIX_LEN;
+}
+
+size_t buildAppendFrame(char* out, size_t cap, const uint8_t* pcm, size_t len) {
+    size_t total = appendFrameLength(len);
+    if (cap < total + 1) return 0;
+
+    char* p = out;
+    memcpy(p, APPEND_PREFIX, APPEND_PREFIX_LEN);
+    p += APPEND_PREFIX_LEN;
+    p += base64Encode(pcm, len, p);
+    memcpy(p, APPEND_SUFFIX, APPEND_SUFFIX_LEN);
+    p += APPEND_SUFFIX_LEN;
+    *p = 0;
+
+    return total;
+}
+
+AppendFrameBuilder::AppendFrameBuilder(size_t headroom, size_t maxPcmBytes)
+    : _headroom(headroom), _maxPcm(maxPcmBytes) {
+    _buf = (uint8_t*)malloc(headroom + appendFrameLength(maxPcmBytes) + 1);
+}
+
+AppendFrameBuilder::~AppendFrameBuilder() {
+    free(_buf);
+}
+
+size_t AppendFrameBuilder::build(const uint8_t* pcm, size_t len) {
+    if (!_buf || len > _maxPcm) return 0;
+    return buildAppendFrame((char*)_buf + _headroom, appendFrameLength(_maxPcm) + 1, pcm, len);
+}
+
+}  // namespace AudioFraming
@@ -0,0 +1,58 @@
+#ifndef AUDIO_FRAMING_H
+#define AUDIO_FRAMING_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Realtime API uplink framing: PCM -> base64 -> input_audio_buffer.append JSON.
+// Kept free of Arduino types so it also builds in the native test env.
+
+namespace AudioFraming {
+
+// Length of the base64 text for len input bytes (no terminator).
+inline size_t base64Length(size_t len) {
+    return ((len + 2) / 3) * 4;
+}
+
+// Standard base64 (RFC 4648, with padding, no line breaks).
+// out must hold base64Length(len) bytes. Returns chars written.
+size_t base64Encode(const uint8_t* in, size_t len, char* out);
+
+// Length of the complete append message for len PCM bytes (no terminator).
+size_t appendFrameLength(size_t len);
+
+// Writes {"type":"input_audio_buffer.append","audio":"<base64>"} plus a NUL.
+// Returns message length, or 0 if cap is smaller than appendFrameLength() + 1.
+size_t buildAppendFrame(char* out, size_t cap, const uint8_t* pcm, size_t len);
+
+// Reusable append message buffer for the uplink hot path. One allocation
+// up front; each build() encodes straight into it, after `headroom` bytes
+// the WebSocket layer can write its frame header into (arduinoWebSockets:
+// sendTXT(buffer(), length, true) with WEBSOCKETS_MAX_HEADER_SIZE).
+class AppendFrameBuilder {
+public:
+    AppendFrameBuilder(size_t headroom, size_t maxPcmBytes);
+    ~AppendFrameBuilder();
+
+    bool isAllocated() const { return _buf != nullptr; }
+    size_t maxPcmBytes() const { return _maxPcm; }
+
+    // Message for len PCM bytes; returns its length, 0 if len > maxPcmBytes()
+    size_t build(const uint8_t* pcm, size_t len);
+
+    // Start of the headroom, and of the message itself
+    uint8_t* buffer() { return _buf; }
+    const char* message() const { return (const char*)_buf + _headroom; }
+
+private:
+    uint8_t* _buf = nullptr;
+    size_t _headroom;
+    size_t _maxPcm;
+
+    AppendFrameBuilder(const AppendFrameBuilder&) = delete;
+    AppendFrameBuilder& operator=(const AppendFrameBuilder&) = delete;
+};
+
+}  // namespace AudioFraming
+
+#endif
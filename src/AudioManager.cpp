@@ -1,4 +1,8 @@
 #include "AudioManager.h"
+#include <esp_timer.h>
+#include <esp_system.h>
+#include <Preferences.h>
+#include <algorithm>
 
 bool AudioManager::begin() {
     Wire.begin(I2C_SDA_PIN, I2C_SCL_PIN, I2C_FREQ);
@@ -23,6 +27,45 @@ bool AudioManager::begin() {
         Serial.println("[Audio] ES7210 fail");
         return false;
     }
+#if CAPTURE_TDM
+    _adc.setTdmMode(true);
+
+    static const MicPosition positions[MIC_ARRAY_COUNT] = MIC_ARRAY_POSITIONS;
+    if (!_beamformer.begin(positions, MIC_ARRAY_COUNT, AUDIO_SAMPLE_RATE)) {
+        Serial.println("[Audio] Beamformer geometry fail");
+        return false;
+    }
+#endif
+
+#if AEC_ENABLED
+    _farEnd = new FarEndReference(AEC_REFERENCE_SAMPLES, AUDIO_SAMPLE_RATE);
+    _aecReady = _farEnd->isAllocated() && _aec.begin(AEC_PARTITIONS);
+    Serial.printf("[Audio] AEC %s (%d ms tail)\n", _aecReady ? "on" : "alloc fail",
+                  (int)(AEC_PARTITIONS * AEC_BLOCK * 1000 / AUDIO_SAMPLE_RATE));
+#endif
+
+#if NS_ENABLED
+    _nsReady = _ns.begin(AUDIO_SAMPLE_RATE);
+    _ns.setMaxAttenuationDb(NS_MAX_ATTENUATION_DB);
+    Serial.printf("[Audio] Noise suppression %s\n", _nsReady ? "on" : "init fail");
+#endif
+
+#if AGC_ENABLED
+    float pga = _adc.setGainDb(AGC_PGA_START_DB);
+    _agcReady = _agc.begin(AUDIO_SAMPLE_RATE, pga, 0.0f, AGC_PGA_MAX_DB);
+    _agc.setTargetDbfs(AGC_TARGET_DBFS);
+    _agc.setMaxDigitalGainDb(AGC_MAX_DIGITAL_GAIN_DB);
+    Serial.printf("[Audio] AGC %s (PGA %.1f dB, target %d dBFS)\n", _agcReady ? "on" : "init fail",
+                  pga, AGC_TARGET_DBFS);
+#endif
+
+    if (!_captureSrc.begin(AUDIO_SAMPLE_RATE, CAPTURE_SAMPLE_RATE)) {
+        Serial.println("[Audio] Capture resampler fail");
+        return false;
+    }
+    if (!_captureSrc.isPassthrough()) {
+        Serial.printf("[Audio] Capture frames at %d Hz\n", CAPTURE_SAMPLE_RATE);
+    }
 
     Serial.println("[Audio] Init OK");
     return true;
@@ -42,8 +85,8 @@ void AudioManager::setupFullDuplex() {
         .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-        .dma_buf_count = 8,
-        .dma_buf_len = 1024,  // Larger for smoother playback
+        .dma_buf_count = PLAYBACK_DMA_BUF_COUNT,
+        .dma_buf_len = PLAYBACK_DMA_BUF_LEN,
         .use_apll = true,
         .tx_desc_auto_clear = true
     };
@@ -58,16 +101,18 @@ void AudioManager::setupFullDuplex() {
     i2s_driver_install(I2S_NUM_0, &tx_config, 0, NULL);
     i2s_set_pin(I2S_NUM_0, &tx_pins);
 
-    // RX (Mic) on I2S_NUM_1
+    // RX (Mic) on I2S_NUM_1. The original ESP32 I2S has no TDM mode, so in
+    // TDM the ES7210's 4 x 16-bit slots are clocked in as one 32-bit stereo
+    // frame (64 BCLK per LRCK) and unpacked in software.
     i2s_config_t rx_config = {
         .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX),
         .sample_rate = AUDIO_SAMPLE_RATE,
-        .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+        .bits_per_sample = CAPTURE_TDM ? I2S_BITS_PER_SAMPLE_32BIT : I2S_BITS_PER_SAMPLE_16BIT,
         .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
         .communication_format = I2S_COMM_FORMAT_STAND_I2S,
         .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-        .dma_buf_count = 4,
-        .dma_buf_len = 256,
+        .dma_buf_count = CAPTURE_DMA_BUF_COUNT,
+        .dma_buf_len = CAPTURE_FRAME_SAMPLES,  // One DMA buffer = one capture frame
         .use_apll = true,
         .tx_desc_auto_clear = false
     };
@@ -79,7 +124,8 @@ void AudioManager::setupFullDuplex() {
         .data_in_num = I2S_IN_DATA_PIN
     };
 
-    i2s_driver_install(I2S_NUM_1, &rx_config, 0, NULL);
+    // Event queue lets the capture task wake on each completed DMA buffer
+    i2s_driver_install(I2S_NUM_1, &rx_config, CAPTURE_DMA_BUF_COUNT, &_rxEvents);
     i2s_set_pin(I2S_NUM_1, &rx_pins);
 
     // Enable Codec
@@ -104,37 +150,173 @@ void AudioManager::startMic() {
     }
 }
 
-size_t AudioManager::readBytes(char* buffer, size_t length) {
-    if (!_micRunning) return 0;
+bool AudioManager::startCapture() {
+    if (_captureTask) return true;
+
+    _captureRing = new CaptureFrameRing(CAPTURE_RING_FRAMES);
+    if (!_captureRing->isAllocated()) {
+        Serial.println("[Audio] Capture ring alloc fail");
+        return false;
+    }
+
+    BaseType_t ok = xTaskCreatePinnedToCore(captureTaskEntry, "capture", CAPTURE_TASK_STACK, this,
+                                            CAPTURE_TASK_PRIORITY, &_captureTask,
+                                            CAPTURE_TASK_CORE);
+    if (ok != pdPASS) {
+        Serial.println("[Audio] Capture task fail");
+        _captureTask = NULL;
+        return false;
+    }
+
+    Serial.printf("[Audio] Capture task on core %d (%d frames)\n",
+                  CAPTURE_TASK_CORE, _captureRing->capacity());
+    return true;
+}
+
+void AudioManager::setMicWeights(int16_t left, int16_t right) {
+    _micWeights[0] = left;
+    _micWeights[1] = right;
+}
+
+CaptureStats AudioManager::captureStats() {
+    CaptureStats stats;
+    stats.framesCaptured = _framesCaptured;
+    stats.framesDropped = _framesDropped;
+    stats.dmaOverflows = _dmaOverflows;
+    stats.beamDegrees = CAPTURE_TDM ? _beamformer.directionDegrees() : -1;
+    stats.beamMaxCycles = _beamformer.maxFrameCycles();
+    stats.aecErleDb = _aecReady ? _aec.erleDb() : 0;
+    stats.aecMaxCycles = _aec.maxBlockCycles();
+    stats.aecDoubleTalkBlocks = _aec.doubleTalkBlocks();
+    stats.nsGainDb = _nsReady ? _ns.lastGainDb() : 0;
+    stats.nsLastCycles = _ns.lastFrameCycles();
+    stats.nsMaxCycles = _ns.maxFrameCycles();
+    if (_agcReady) stats.agc = _agc.stats();
+    else stats.agc = {};
+    return stats;
+}
+
+void AudioManager::pushEchoReference(const int16_t* pcm, size_t samples, int64_t playUs) {
+    if (_aecReady) _farEnd->push(pcm, samples, playUs);
+}
+
+void AudioManager::serviceAgc() {
+    if (!_pgaRequested || _pgaDone) return;
+    _pgaAppliedDb = _adc.setGainDb(_pgaRequestDb);
+    _pgaDone = true;
+    Serial.printf("[AGC] PGA %.1f dB\n", (float)_pgaAppliedDb);
+}
+
+void AudioManager::captureTaskEntry(void* arg) {
+    ((AudioManager*)arg)->captureLoop();
+}
+
+// Raw mic channels into _micPcm (interleaved, MIC_CHANNELS wide).
+// Returns frames read.
+size_t AudioManager::readChannels(size_t frames, TickType_t timeout) {
+    if (frames > CAPTURE_FRAME_SAMPLES) frames = CAPTURE_FRAME_SAMPLES;
+    size_t read = 0;
+
+#if CAPTURE_TDM
+    const size_t frameBytes = MIC_TDM_SLOTS * 2;
+    i2s_read(I2S_NUM_1, _rxWords, frames * frameBytes, &read, timeout);
+    frames = read / frameBytes;
+    AudioDsp::unpackTdm(_rxWords, MIC_TDM_SLOTS, _micPcm, frames, MIC_ARRAY_COUNT);
+#else
+    i2s_read(I2S_NUM_1, _micPcm, frames * 4, &read, timeout);
+    frames = read / 4;
+#endif
+    return frames;
+}
+
+// One DMA buffer's worth of mic audio -> mono: beamformed in TDM mode,
+// weighted L/R mix otherwise. Returns frames produced.
+size_t AudioManager::readFrame(int16_t* mono, size_t frames, TickType_t timeout) {
+    frames = readChannels(frames, timeout);
+    if (frames == 0) return 0;
+
+#if CAPTURE_TDM
+    _beamformer.process(_micPcm, mono, frames);
+#else
+    AudioDsp::downmix(_micPcm, mono, frames, 2, _micWeights);
+#endif
+    return frames;
+}
+
+void AudioManager::captureLoop() {
+    i2s_event_t evt;
 
-    // Read stereo and mix to mono
-    const size_t CHUNK = 256;
-    int16_t monoBuf[CHUNK];
-    int16_t stereoBuf[CHUNK * 2];
+    while (true) {
+        if (xQueueReceive(_rxEvents, &evt, portMAX_DELAY) != pdTRUE) continue;
 
-    size_t total = 0;
-    while (total < length) {
-        size_t samples = (length - total) / 2;
-        if (samples > CHUNK) samples = CHUNK;
+        if (evt.type == I2S_EVENT_RX_Q_OVF) {
+            // Driver discarded the oldest DMA buffer: samples are gone
+            _dmaOverflows++;
+            continue;
+        }
+        if (evt.type != I2S_EVENT_RX_DONE) continue;
 
-        size_t stereoBytes = samples * 4;
-        size_t read = 0;
+        int64_t now = esp_timer_get_time();
+        CaptureFrame* f = _uplinkPaused ? NULL : _captureRing->acquireWrite();
 
-        i2s_read(I2S_NUM_1, stereoBuf, stereoBytes, &read, 10);
-        if (read == 0) break;
+        // Without a slot, still drain the DMA buffer (so the driver queue does
+        // not overflow) and keep the echo canceller tracking the room
+        int16_t* pcm = f ? f->pcm : _scratch;
+        size_t frames = readFrame(pcm, CAPTURE_FRAME_SAMPLES, 0);
+        if (frames == 0) continue;
+        int64_t startUs = now - (int64_t)frames * 1000000 / AUDIO_SAMPLE_RATE;
 
-        size_t frames = read / 4;
-        for (size_t i = 0; i < frames; i++) {
-            monoBuf[i] = (stereoBuf[i * 2] + stereoBuf[i * 2 + 1]) / 2;
+        // Also on scratch frames, so the noise estimate stays current
+        frames = processFrame(pcm, frames, startUs);
+
+        if (!f) {
+            if (!_uplinkPaused) _framesDropped++;
+            _sampleIndex += frames;
+            continue;
         }
 
-        memcpy(buffer + total, monoBuf, frames * 2);
-        total += frames * 2;
+        AudioDsp::Level level = AudioDsp::measureLevel(f->pcm, frames);
+
+        f->samples = frames;
+        f->peak = level.peak;
+        f->rms = level.rms();
+        f->firstSample = _sampleIndex;
+        f->timestampUs = startUs;
+        _sampleIndex += frames;
 
-        if (read < stereoBytes) break;
+        _captureRing->commitWrite();
+        _framesCaptured++;
     }
+}
 
-    return total;
+// DC, AEC, NS, AGC and rate conversion: everything between the mono mix
+// and the VAD. Returns the frame length at CAPTURE_SAMPLE_RATE.
+size_t AudioManager::processFrame(int16_t* pcm, size_t frames, int64_t startUs) {
+    AudioDsp::removeDc(_dcBlocker, pcm, frames);
+    if (_aecReady) {
+        _farEnd->read(startUs - AEC_REF_MARGIN_US, _aecRef, frames);
+        _aec.process(_aecRef, pcm, frames);
+    }
+    if (_nsReady) _ns.process(pcm, frames);
+    if (_agcReady) {
+        // Frames already in the DMA ring see the new PGA a few ms late
+        if (_pgaDone) {
+            _agc.pgaApplied(_pgaAppliedDb);
+            _pgaDone = false;
+            _pgaRequested = false;
+        }
+        // The mic mostly hears the speaker while it plays: hold the gain
+        _agc.process(pcm, frames, !(_aecReady && _aec.farEndActive()));
+        if (_agc.pgaChangePending() && !_pgaRequested) {
+            _pgaRequestDb = _agc.requestedPgaDb();
+            _pgaRequested = true;
+        }
+    }
+    if (!_captureSrc.isPassthrough()) {
+        frames = _captureSrc.process(pcm, frames, _srcOut);
+        memcpy(pcm, _srcOut, frames * sizeof(int16_t));
+    }
+    return frames;
 }
 
 void AudioManager::enablePA(bool enable) {
@@ -149,8 +331,151 @@ void AudioManager::setMute(bool mute) {
     _codec.setMute(mute);
 }
 
-void AudioManager::calibrateNoise(int samples) {
+static const uint16_t NOISE_PROFILE_VERSION = 1;
+static const int CAL_SETTLE_FRAMES = 5;     // DC blockers and ADC startup
+static const int INPUT_FLOOR_FRAMES = 24;   // ~250 ms through the capture stages
+static const int INPUT_FLOOR_SETTLE = 4;    // NS overlap and AGC attack
+
+bool AudioManager::loadNoiseProfile() {
+    Preferences prefs;
+    if (!prefs.begin("korvo-cal", true)) return false;
+    NoiseProfile stored;
+    size_t len = prefs.getBytes("noise", &stored, sizeof(stored));
+    prefs.end();
+
+    if (len != sizeof(stored) || !stored.valid ||
+        stored.version != NOISE_PROFILE_VERSION ||
+        stored.channels != MIC_CHANNELS ||
+        stored.sampleRate != AUDIO_SAMPLE_RATE) {
+        return false;
+    }
+    _noise = stored;
+    return true;
+}
+
+void AudioManager::saveNoiseProfile() {
+    Preferences prefs;
+    if (!prefs.begin("korvo-cal", false)) return;
+    prefs.putBytes("noise", &_noise, sizeof(_noise));
+    prefs.end();
+}
+
+bool AudioManager::calibrateNoise(int frames, bool force) {
+    // Power-on may mean a new room; any other reset keeps the stored profile
+    bool warmBoot = esp_reset_reason() != ESP_RST_POWERON;
+    if (!force && warmBoot && loadNoiseProfile()) {
+        Serial.printf("[Audio] Noise profile from NVS (mono floor %.0f RMS)\n", _noise.monoRms);
+        if (_nsReady) _ns.setNoiseFloorRms(_noise.monoRms);
+        if (!_captureTask && _micRunning) measureInputFloor();
+        return true;
+    }
+    if (_captureTask || !_micRunning) return _noise.valid;
+
     Serial.println("[Audio] Calibrating...");
-    delay(samples * 20);
-    Serial.println("[Audio] Done");
+    uint32_t start = millis();
+
+    AudioDsp::DcBlocker dc[MIC_CHANNELS];
+    AudioDsp::DcBlocker monoDc;
+    int16_t chan[CAPTURE_FRAME_SAMPLES];
+    int16_t mono[CAPTURE_FRAME_SAMPLES];
+
+    // Per frame RMS, kept so the floor can ignore someone talking or a door
+    // slam during calibration (lower quartile, not the mean)
+    const int total = frames + CAL_SETTLE_FRAMES;
+    float* rms = (float*)malloc(sizeof(float) * frames * (MIC_CHANNELS + 2));
+    if (!rms) return false;
+    float* sorted = rms + frames * (MIC_CHANNELS + 1);
+    float bandSum[MIC_CHANNELS][NOISE_BANDS] = {};
+    int measured = 0;
+
+    for (int f = 0; f < total; f++) {
+        size_t n = readChannels(CAPTURE_FRAME_SAMPLES, pdMS_TO_TICKS(50));
+        if (n == 0) break;
+
+        // Mono path as the capture task builds it (beamformer or downmix)
+#if CAPTURE_TDM
+        _beamformer.process(_micPcm, mono, n);
+#else
+        AudioDsp::downmix(_micPcm, mono, n, 2, _micWeights);
+#endif
+        AudioDsp::removeDc(monoDc, mono, n);
+        if (f < CAL_SETTLE_FRAMES) {
+            for (size_t c = 0; c < MIC_CHANNELS; c++) {
+                for (size_t i = 0; i < n; i++) chan[i] = _micPcm[i * MIC_CHANNELS + c];
+                AudioDsp::removeDc(dc[c], chan, n);
+            }
+            continue;
+        }
+
+        float* row = rms + measured * (MIC_CHANNELS + 1);
+        for (size_t c = 0; c < MIC_CHANNELS; c++) {
+            for (size_t i = 0; i < n; i++) chan[i] = _micPcm[i * MIC_CHANNELS + c];
+            AudioDsp::removeDc(dc[c], chan, n);
+            row[c] = AudioDsp::measureLevel(chan, n).rms();
+            for (size_t b = 0; b < NOISE_BANDS; b++) {
+                bandSum[c][b] += AudioDsp::goertzelPower(chan, n, 1, NOISE_BAND_HZ[b], AUDIO_SAMPLE_RATE);
+            }
+        }
+        row[MIC_CHANNELS] = AudioDsp::measureLevel(mono, n).rms();
+        measured++;
+    }
+
+    if (measured == 0) {
+        free(rms);
+        Serial.println("[Audio] Calibration failed: no mic data");
+        return _noise.valid;
+    }
+
+    // Lower quartile of one column
+    auto quartile = [&](size_t col) {
+        for (int i = 0; i < measured; i++) sorted[i] = rms[i * (MIC_CHANNELS + 1) + col];
+        std::nth_element(sorted, sorted + measured / 4, sorted + measured);
+        return sorted[measured / 4];
+    };
+
+    _noise.version = NOISE_PROFILE_VERSION;
+    _noise.channels = MIC_CHANNELS;
+    _noise.sampleRate = AUDIO_SAMPLE_RATE;
+    for (size_t c = 0; c < MIC_CHANNELS; c++) {
+        _noise.floorRms[c] = quartile(c);
+        for (size_t b = 0; b < NOISE_BANDS; b++) {
+            _noise.bandDb[c][b] = 10.0f * log10f(bandSum[c][b] / measured + 1.0f);
+        }
+    }
+    _noise.monoRms = quartile(MIC_CHANNELS);
+    _noise.valid = true;
+    free(rms);
+    saveNoiseProfile();
+    if (_nsReady) _ns.setNoiseFloorRms(_noise.monoRms);
+
+    Serial.printf("[Audio] Calibrated in %lu ms: mono floor %.0f RMS, mic floors",
+                  (unsigned long)(millis() - start), _noise.monoRms);
+    for (size_t c = 0; c < MIC_CHANNELS; c++) Serial.printf(" %.0f", _noise.floorRms[c]);
+    Serial.println();
+    measureInputFloor();
+    return true;
+}
+
+// The floor the VAD will see: a few more ambient frames through the same
+// stages as the capture task (NS already seeded), lower quartile of the RMS.
+// Not stored: NS and AGC settings may differ on the next build.
+void AudioManager::measureInputFloor() {
+    float rms[INPUT_FLOOR_FRAMES];
+    int16_t mono[CAPTURE_FRAME_SAMPLES];
+    int measured = 0;
+
+    for (int f = 0; f < INPUT_FLOOR_FRAMES + INPUT_FLOOR_SETTLE; f++) {
+        size_t n = readFrame(mono, CAPTURE_FRAME_SAMPLES, pdMS_TO_TICKS(50));
+        if (n == 0) break;
+        n = processFrame(mono, n, esp_timer_get_time());
+        if (f >= INPUT_FLOOR_SETTLE) rms[measured++] = AudioDsp::measureLevel(mono, n).rms();
+    }
+    if (measured == 0) {
+        _inputFloorRms = 0;
+        return;
+    }
+
+    std::nth_element(rms, rms + measured / 4, rms + measured);
+    _inputFloorRms = rms[measured / 4];
+    Serial.printf("[Audio] Floor at the VAD input: %.0f RMS (mono %.0f)\n", _inputFloorRms, _noise.monoRms);
 }
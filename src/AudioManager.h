@@ -7,12 +7,80 @@
 #include "BoardConfig.h"
 #include "ES8311.h"
 #include "ES7210.h"
+#include "CaptureFrameRing.h"
+#include "AudioDsp.h"
+#include "Beamformer.h"
+#include "EchoCanceller.h"
+#include "FarEndReference.h"
+#include "NoiseSuppressor.h"
+#include "AutoGainControl.h"
+#include "Resampler.h"
+
+// Mic channels delivered per frame: the array in TDM mode, else L/R
+#if CAPTURE_TDM
+static const size_t MIC_CHANNELS = MIC_ARRAY_COUNT;
+#else
+static const size_t MIC_CHANNELS = 2;
+#endif
+
+// Ambient noise measured by calibrateNoise(), persisted in NVS
+static const size_t NOISE_BANDS = 8;
+static const float NOISE_BAND_HZ[NOISE_BANDS] = {125, 250, 500, 1000, 2000, 3000, 4000, 6000};
+
+struct NoiseProfile {
+    uint16_t version;
+    uint16_t channels;
+    uint32_t sampleRate;
+    float floorRms[MIC_CHANNELS];               // Per mic, DC removed
+    float bandDb[MIC_CHANNELS][NOISE_BANDS];    // Per mic, dB re 1 LSB^2
+    float monoRms;                              // After mix/beamformer, before AEC/NS/AGC: seeds NS
+    bool valid;
+};
+
+struct CaptureStats {
+    uint32_t framesCaptured;    // Frames pushed to the ring
+    uint32_t framesDropped;     // Ring full: uplink consumer fell behind
+    uint32_t dmaOverflows;      // I2S RX DMA buffers lost (I2S_EVENT_RX_Q_OVF)
+    int beamDegrees;            // Current look direction (-1 without TDM)
+    uint32_t beamMaxCycles;     // Worst beamformer frame so far
+    float aecErleDb;            // Echo return loss enhancement (0 without AEC)
+    uint32_t aecMaxCycles;      // Worst echo canceller block so far
+    uint32_t aecDoubleTalkBlocks;
+    float nsGainDb;             // Mean suppressor gain, last frame (0 without NS)
+    uint32_t nsLastCycles;      // Noise suppressor, last frame
+    uint32_t nsMaxCycles;       // Worst noise suppressor frame so far
+    AgcStats agc;               // Zeroed without AGC
+};
 
 class AudioManager {
 public:
     bool begin();
     void setupFullDuplex();
-    size_t readBytes(char* buffer, size_t length);
+    // Capture task: drains I2S RX on its own core into a frame ring
+    bool startCapture();
+    CaptureFrameRing* captureRing() { return _captureRing; }
+    CaptureStats captureStats();
+
+    // Mic channel mix for 2-channel capture (Q15 per channel, default 0.5 / 0.5)
+    void setMicWeights(int16_t left, int16_t right);
+
+    // Echo cancellation: playback hands over every chunk it gives to I2S,
+    // with the time its first sample is expected to play
+    bool aecEnabled() const { return _aecReady; }
+    void pushEchoReference(const int16_t* pcm, size_t samples, int64_t playUs);
+
+    // Paused: capture (and AEC adaptation) keeps running, frames are not queued
+    void setUplinkPaused(bool paused) { _uplinkPaused = paused; }
+
+    // AGC: applies PGA changes the capture task asked for. Call from the
+    // main loop (I2C), not while playback owns the bus timing.
+    void serviceAgc();
+
+    // AUDIO_SAMPLE_RATE -> CAPTURE_SAMPLE_RATE, last stage of the capture task
+    const Resampler& captureResampler() const { return _captureSrc; }
+
+    // TDM capture: beam tracks the talker unless locked (-1 resumes tracking)
+    Beamformer& beamformer() { return _beamformer; }
     void enablePA(bool enable);
     void stopMic();
     void startMic();
@@ -21,13 +89,62 @@ public:
     void setVolume(uint8_t volume);
     void setMute(bool mute);
 
-    // Noise calibration
-    void calibrateNoise(int samples = 50);
+    // Noise calibration: measures `frames` capture frames of ambient audio
+    // (must run before startCapture). Reuses the NVS copy on warm boots
+    // unless forced. Returns false if nothing could be measured or loaded.
+    bool calibrateNoise(int frames = 40, bool force = false);
+    const NoiseProfile& noiseProfile() const { return _noise; }
+    // Ambient RMS after all capture stages, as the VAD gets it (0 = unknown).
+    // Measured by calibrateNoise() on every boot.
+    float inputFloorRms() const { return _inputFloorRms; }
 
 private:
     ES8311 _codec;
     ES7210 _adc;
     bool _micRunning = false;
+
+    QueueHandle_t _rxEvents = NULL;
+    TaskHandle_t _captureTask = NULL;
+    CaptureFrameRing* _captureRing = NULL;
+    uint32_t _sampleIndex = 0;
+    int16_t _micWeights[2] = {AudioDsp::Q15_HALF, AudioDsp::Q15_HALF};
+    AudioDsp::DcBlocker _dcBlocker;
+    Beamformer _beamformer;
+    EchoCanceller _aec;
+    FarEndReference* _farEnd = NULL;
+    bool _aecReady = false;
+    NoiseSuppressor _ns;
+    bool _nsReady = false;
+    AutoGainControl _agc;
+    bool _agcReady = false;
+    // PGA handshake: capture task requests, serviceAgc() applies
+    volatile bool _pgaRequested = false;
+    volatile bool _pgaDone = false;
+    volatile float _pgaRequestDb = 0;
+    volatile float _pgaAppliedDb = 0;
+    volatile bool _uplinkPaused = false;
+    Resampler _captureSrc;
+    int16_t _scratch[CAPTURE_FRAME_SAMPLES];
+    int16_t _srcOut[CAPTURE_FRAME_SAMPLES + 2];
+    int16_t _aecRef[CAPTURE_FRAME_SAMPLES];
+#if CAPTURE_TDM
+    uint32_t _rxWords[CAPTURE_FRAME_SAMPLES * MIC_TDM_SLOTS / 2];
+#endif
+    int16_t _micPcm[CAPTURE_FRAME_SAMPLES * MIC_CHANNELS];
+    NoiseProfile _noise = {};
+    float _inputFloorRms = 0;
+    volatile uint32_t _framesCaptured = 0;
+    volatile uint32_t _framesDropped = 0;
+    volatile uint32_t _dmaOverflows = 0;
+
+    static void captureTaskEntry(void* arg);
+    void captureLoop();
+    size_t processFrame(int16_t* pcm, size_t frames, int64_t startUs);
+    size_t readChannels(size_t frames, TickType_t timeout);
+    size_t readFrame(int16_t* mono, size_t frames, TickType_t timeout);
+    bool loadNoiseProfile();
+    void saveNoiseProfile();
+    void measureInputFloor();
 };
 
 #endif
@@ -3,128 +3,462 @@
 
 #include <Arduino.h>
 #include <esp_heap_caps.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <atomic>
+#ifdef KORVO_NATIVE
+#include <functional>
+#endif
+
+// Single-producer / single-consumer lock-free ring buffer.
+//
+// Exactly one task may write (write / acquireWrite / commitWrite) and exactly
+// one task may read (read / acquireRead / commitRead). Head and tail are
+// free-running counters published with acquire/release ordering, so no lock
+// is taken on any path. Capacity is rounded down to a power of two so the
+// index wrap is a mask.
+//
+// The acquire/commit API hands out contiguous spans inside the buffer so the
+// producer can fill it straight from the socket and the consumer can feed
+// i2s_write() straight out of it, without an intermediate copy.
+//
+// Instead of polling available(), either side can block on an event group:
+// the producer raises DATA / HIGH_WATER as the level rises, the consumer
+// raises LOW_WATER / DRAINED as it falls. Bits are only touched on level
+// transitions or when the consumer is blocked waiting for them, so the
+// steady-state path never enters the kernel. The consumer publishes what it
+// waits for before it re-checks the level, and the producer reads that
+// after publishing head (a seq_cst fence on each side), so a wakeup can't
+// fall between the two.
+//
+// Tiered mode (enableHotTier): the large backlog stays in PSRAM, but the
+// consumer reads from a small window in internal DRAM that is refilled in
+// bulk once it is half empty. I2S then never reads PSRAM per chunk, and PSRAM
+// traffic on the consumer side becomes a few large sequential copies.
 
 class AudioRingBuffer {
 public:
+    struct Span {
+        uint8_t* data;
+        size_t len;
+    };
+
+    // Event group bits
+    static const EventBits_t EVT_DATA       = BIT0;  // Went from empty to non-empty
+    static const EventBits_t EVT_HIGH_WATER = BIT1;  // Level reached high watermark
+    static const EventBits_t EVT_LOW_WATER  = BIT2;  // Level fell to low watermark
+    static const EventBits_t EVT_END        = BIT3;  // Producer marked end of stream
+    static const EventBits_t EVT_DRAINED    = BIT4;  // End of stream and fully consumed
+
     AudioRingBuffer(size_t size) {
-        _size = size;
+        _size = floorPow2(size);
         _buffer = NULL;
         _inPsram = false;
 
         // Try PSRAM first (external SPI RAM)
         if (ESP.getPsramSize() > 0) {
-            _buffer = (uint8_t*)heap_caps_malloc(size, MALLOC_CAP_SPIRAM);
+            _buffer = (uint8_t*)heap_caps_malloc(_size, MALLOC_CAP_SPIRAM);
             if (_buffer) {
                 _inPsram = true;
-                Serial.printf("[Buffer] Allocated %d KB in PSRAM\n", size/1024);
+                Serial.printf("[Buffer] Allocated %d KB in PSRAM\n", _size/1024);
             }
         }
 
         // Fallback to internal RAM with smaller size
         if (_buffer == NULL) {
             size_t fallbackSize = 128 * 1024;  // 128KB max for internal RAM
-            if (size > fallbackSize) {
+            if (_size > fallbackSize) {
                 _size = fallbackSize;
                 Serial.printf("[Buffer] PSRAM unavailable, using %d KB internal\n", fallbackSize/1024);
             }
             _buffer = (uint8_t*)malloc(_size);
         }
 
-        _head = 0;
-        _tail = 0;
-        _count = 0;
-        _mutex = xSemaphoreCreateMutex();
+        _mask = _size - 1;
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+        _endOfStream.store(false, std::memory_order_relaxed);
+        _waiting.store(0, std::memory_order_relaxed);
+        _highWater = 1;
+        _lowWater = _size / 2;
+        _events = xEventGroupCreate();
+
+        _hot = NULL;
+        _hotSize = 0;
+        _hotMask = 0;
+        _hotHead = 0;
+        _hotTail = 0;
+        _hotCount.store(0, std::memory_order_relaxed);
+
+        _psramIn.store(0, std::memory_order_relaxed);
+        _psramOut.store(0, std::memory_order_relaxed);
+        _psramAccesses.store(0, std::memory_order_relaxed);
+        _rateBytes = 0;
+        _rateMillis = millis();
     }
 
     ~AudioRingBuffer() {
         if (_buffer) free(_buffer);
-        vSemaphoreDelete(_mutex);
+        if (_hot) heap_caps_free(_hot);
+        vEventGroupDelete(_events);
     }
 
     bool isAllocated() {
         return _buffer != NULL;
     }
 
-    size_t write(const uint8_t* data, size_t len) {
-        if (!_buffer) return 0;
-        xSemaphoreTake(_mutex, portMAX_DELAY);
-        
-        size_t freeSpace = _size - _count;
+    size_t capacity() const {
+        return _buffer ? _size : 0;
+    }
+
+    // high: level that raises EVT_HIGH_WATER (e.g. pre-roll before playback)
+    // low:  level that raises EVT_LOW_WATER (producer may resume filling)
+    void setWatermarks(size_t high, size_t low) {
+        if (high == 0) high = 1;
+        if (high > _size) high = _size;
+        if (low >= _size) low = _size - 1;
+        _highWater = high;
+        _lowWater = low;
+    }
+
+    // Put a small internal-DRAM window in front of the consumer. Only useful
+    // when the backlog landed in PSRAM; call before the first read.
+    bool enableHotTier(size_t hotSize) {
+        if (!_buffer || !_inPsram || _hot) return _hot != NULL;
+        hotSize = floorPow2(hotSize);
+        _hot = (uint8_t*)heap_caps_malloc(hotSize, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!_hot) {
+            Serial.println("[Buffer] Hot tier allocation failed, reading PSRAM directly");
+            return false;
+        }
+        _hotSize = hotSize;
+        _hotMask = hotSize - 1;
+        Serial.printf("[Buffer] Hot tier: %d KB internal\n", hotSize/1024);
+        return true;
+    }
+
+    bool isTiered() const {
+        return _hot != NULL;
+    }
+
+    // ---------------------------------------------------------------------
+    // Producer side
+    // ---------------------------------------------------------------------
+
+    // Largest contiguous writable region, capped at maxLen (0 = no cap).
+    Span acquireWrite(size_t maxLen = 0) {
+        if (!_buffer) return {NULL, 0};
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t tail = _tail.load(std::memory_order_acquire);
+
+        size_t freeSpace = _size - (head - tail);
+        size_t offset = head & _mask;
+        size_t len = _size - offset;
         if (len > freeSpace) len = freeSpace;
+        if (maxLen && len > maxLen) len = maxLen;
+        return {_buffer + offset, len};
+    }
+
+    // Publish len bytes previously filled through acquireWrite().
+    void commitWrite(size_t len) {
+        if (len == 0) return;
+        size_t head = _head.load(std::memory_order_relaxed);
+        size_t before = head - _tail.load(std::memory_order_acquire) +
+                        _hotCount.load(std::memory_order_relaxed);
+#ifdef KORVO_NATIVE
+        if (beforePublish) beforePublish();
+#endif
+        _head.store(head + len, std::memory_order_release);
 
-        if (len == 0) {
-            xSemaphoreGive(_mutex);
-            return 0;
+        if (_inPsram) {
+            _psramIn.fetch_add(len, std::memory_order_relaxed);
+            _psramAccesses.fetch_add(1, std::memory_order_relaxed);
         }
 
-        size_t firstChunk = _size - _head;
-        if (len <= firstChunk) {
-            memcpy(_buffer + _head, data, len);
-            _head += len;
-        } else {
-            memcpy(_buffer + _head, data, firstChunk);
-            memcpy(_buffer, data + firstChunk, len - firstChunk);
-            _head = len - firstChunk;
+        // before may be stale (the consumer can drain meanwhile): a blocked
+        // consumer is woken from what it waits for, read after the publish
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        EventBits_t waiting = _waiting.load(std::memory_order_relaxed);
+        size_t after = before + len;
+        EventBits_t bits = 0;
+        if (before == 0 || (waiting & EVT_DATA)) bits |= EVT_DATA;
+        if (before < _highWater && after >= _highWater) bits |= EVT_HIGH_WATER;
+        if ((waiting & EVT_HIGH_WATER) && used() >= _highWater) bits |= EVT_HIGH_WATER;
+        if (bits) xEventGroupSetBits(_events, bits);
+    }
+
+#ifdef KORVO_NATIVE
+    // Host tests: runs between the level read and the head store above
+    std::function<void()> beforePublish;
+#endif
+
+    size_t write(const uint8_t* data, size_t len) {
+        size_t total = 0;
+        while (total < len) {
+            Span s = acquireWrite(len - total);
+            if (s.len == 0) break;
+            memcpy(s.data, data + total, s.len);
+            commitWrite(s.len);
+            total += s.len;
         }
+        return total;
+    }
 
-        if (_head >= _size) _head = 0;
-        _count += len;
+    size_t space() const {
+        return _buffer ? _size - backlogUsed() : 0;
+    }
 
-        xSemaphoreGive(_mutex);
-        return len;
+    // Block until there is room to write or the timeout expires.
+    bool waitForSpace(TickType_t timeout) {
+        xEventGroupClearBits(_events, EVT_LOW_WATER);
+        if (space() > 0) return true;
+        xEventGroupWaitBits(_events, EVT_LOW_WATER, pdTRUE, pdFALSE, timeout);
+        return space() > 0;
     }
 
-    size_t read(uint8_t* data, size_t len) {
-        if (!_buffer) return 0;
-        xSemaphoreTake(_mutex, portMAX_DELAY);
+    // No more data will be written; wakes any waiting consumer.
+    void markEndOfStream() {
+        _endOfStream.store(true, std::memory_order_seq_cst);
+        EventBits_t bits = EVT_END;
+        if (used() == 0) bits |= EVT_DRAINED;
+        xEventGroupSetBits(_events, bits);
+    }
 
-        if (len > _count) len = _count;
+    // ---------------------------------------------------------------------
+    // Consumer side
+    // ---------------------------------------------------------------------
 
-        if (len == 0) {
-            xSemaphoreGive(_mutex);
-            return 0;
-        }
+    // Largest contiguous readable region, capped at maxLen (0 = no cap).
+    Span acquireRead(size_t maxLen = 0) {
+        if (!_buffer) return {NULL, 0};
+        if (_hot) return acquireHot(maxLen);
 
-        size_t firstChunk = _size - _tail;
-        if (len <= firstChunk) {
-            memcpy(data, _buffer + _tail, len);
-            _tail += len;
+        Span s = backlogSpan();
+        if (maxLen && s.len > maxLen) s.len = maxLen;
+        return s;
+    }
+
+    // Release len bytes previously obtained through acquireRead().
+    void commitRead(size_t len) {
+        if (len == 0) return;
+        if (_hot) {
+            _hotTail += len;
+            _hotCount.store(_hotHead - _hotTail, std::memory_order_relaxed);
         } else {
-            memcpy(data, _buffer + _tail, firstChunk);
-            memcpy(data, _buffer, len - firstChunk);
-            _tail = len - firstChunk;
+            consumeBacklog(len);
+            if (_inPsram) {
+                _psramOut.fetch_add(len, std::memory_order_relaxed);
+                _psramAccesses.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+
+        if (used() == 0 && _endOfStream.load(std::memory_order_seq_cst)) {
+            xEventGroupSetBits(_events, EVT_DRAINED);
+        }
+    }
+
+    size_t read(uint8_t* data, size_t len) {
+        size_t total = 0;
+        while (total < len) {
+            Span s = acquireRead(len - total);
+            if (s.len == 0) break;
+            memcpy(data + total, s.data, s.len);
+            commitRead(s.len);
+            total += s.len;
         }
+        return total;
+    }
+
+    // Bytes readable by the consumer (PSRAM backlog plus hot window).
+    size_t available() const {
+        return _buffer ? used() : 0;
+    }
+
+    bool isEndOfStream() const {
+        return _endOfStream.load(std::memory_order_acquire);
+    }
 
-        if (_tail >= _size) _tail = 0;
-        _count -= len;
+    // Block until at least one byte is readable. Returns false on timeout or
+    // when the stream ended with nothing left to read.
+    bool waitForData(TickType_t timeout) {
+        beginWait(EVT_DATA);
+        bool ready = used() > 0;
+        if (!ready && !isEndOfStream()) {
+            xEventGroupWaitBits(_events, EVT_DATA | EVT_END, pdFALSE, pdFALSE, timeout);
+            ready = used() > 0;
+        }
+        _waiting.store(0, std::memory_order_relaxed);
+        return ready;
+    }
 
-        xSemaphoreGive(_mutex);
-        return len;
+    // Block until the high watermark is reached or the stream ended
+    // (whatever arrives first). Returns false on timeout.
+    bool waitForHighWater(TickType_t timeout) {
+        beginWait(EVT_HIGH_WATER);
+        bool ready = used() >= _highWater || isEndOfStream();
+        if (!ready) {
+            EventBits_t bits = xEventGroupWaitBits(_events, EVT_HIGH_WATER | EVT_END,
+                                                   pdFALSE, pdFALSE, timeout);
+            ready = (bits & (EVT_HIGH_WATER | EVT_END)) != 0 || used() >= _highWater;
+        }
+        _waiting.store(0, std::memory_order_relaxed);
+        return ready;
     }
 
-    size_t available() {
-        xSemaphoreTake(_mutex, portMAX_DELAY);
-        size_t c = _count;
-        xSemaphoreGive(_mutex);
-        return c;
+    // Block until the producer ended the stream and the consumer read it all.
+    bool waitForDrain(TickType_t timeout) {
+        EventBits_t bits = xEventGroupWaitBits(_events, EVT_DRAINED, pdFALSE, pdFALSE, timeout);
+        return (bits & EVT_DRAINED) != 0;
     }
 
+    // Only safe while neither side is active (e.g. before a new stream starts).
     void clear() {
-        xSemaphoreTake(_mutex, portMAX_DELAY);
-        _head = 0;
-        _tail = 0;
-        _count = 0;
-        xSemaphoreGive(_mutex);
+        // Restart at offset 0 so spans handed out are sample-aligned again
+        _head.store(0, std::memory_order_release);
+        _tail.store(0, std::memory_order_release);
+        _hotHead = 0;
+        _hotTail = 0;
+        _hotCount.store(0, std::memory_order_relaxed);
+        _endOfStream.store(false, std::memory_order_release);
+        xEventGroupClearBits(_events, EVT_DATA | EVT_HIGH_WATER | EVT_LOW_WATER |
+                                      EVT_END | EVT_DRAINED);
+    }
+
+    // ---------------------------------------------------------------------
+    // PSRAM traffic counters
+    // ---------------------------------------------------------------------
+
+    uint32_t psramBytesWritten() const { return _psramIn.load(std::memory_order_relaxed); }
+    uint32_t psramBytesRead() const { return _psramOut.load(std::memory_order_relaxed); }
+    uint32_t psramAccesses() const { return _psramAccesses.load(std::memory_order_relaxed); }
+
+    // PSRAM bytes moved (both directions) per second since the previous call.
+    uint32_t psramBytesPerSecond() {
+        uint32_t total = psramBytesWritten() + psramBytesRead();
+        unsigned long now = millis();
+        unsigned long elapsed = now - _rateMillis;
+        uint32_t rate = elapsed ? (uint32_t)((uint64_t)(total - _rateBytes) * 1000 / elapsed) : 0;
+        _rateBytes = total;
+        _rateMillis = now;
+        return rate;
     }
 
 private:
     uint8_t* _buffer;
     size_t _size;
-    volatile size_t _head;
-    volatile size_t _tail;
-    volatile size_t _count;
-    SemaphoreHandle_t _mutex;
+    size_t _mask;
+    std::atomic<size_t> _head;  // total bytes ever written
+    std::atomic<size_t> _tail;  // total bytes ever read from the backlog
+    std::atomic<bool> _endOfStream;
+    std::atomic<EventBits_t> _waiting;  // Bits the consumer is about to block on
+    size_t _highWater;
+    size_t _lowWater;
+    EventGroupHandle_t _events;
     bool _inPsram;
+
+    // Hot tier (consumer-owned; _hotCount is published for level queries)
+    uint8_t* _hot;
+    size_t _hotSize;
+    size_t _hotMask;
+    size_t _hotHead;
+    size_t _hotTail;
+    std::atomic<size_t> _hotCount;
+
+    std::atomic<uint32_t> _psramIn;
+    std::atomic<uint32_t> _psramOut;
+    std::atomic<uint32_t> _psramAccesses;
+    uint32_t _rateBytes;
+    unsigned long _rateMillis;
+
+    size_t backlogUsed() const {
+        // Tail first: it can only trail head, so the difference never underflows
+        size_t tail = _tail.load(std::memory_order_acquire);
+        size_t head = _head.load(std::memory_order_acquire);
+        size_t count = head - tail;
+        return count > _size ? _size : count;
+    }
+
+    size_t used() const {
+        return backlogUsed() + _hotCount.load(std::memory_order_relaxed);
+    }
+
+    // Announce the wait, then clear the bit: the level checked next is read
+    // after both, and any publish the check misses sees the announcement
+    void beginWait(EventBits_t bit) {
+        _waiting.store(bit, std::memory_order_relaxed);
+        xEventGroupClearBits(_events, bit);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    Span backlogSpan() {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t head = _head.load(std::memory_order_acquire);
+
+        size_t count = head - tail;
+        size_t offset = tail & _mask;
+        size_t len = _size - offset;
+        if (len > count) len = count;
+        return {_buffer + offset, len};
+    }
+
+    void consumeBacklog(size_t len) {
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        size_t before = _head.load(std::memory_order_acquire) - tail;
+        _tail.store(tail + len, std::memory_order_seq_cst);
+
+        // Re-read head: the producer may have written meanwhile
+        size_t after = _head.load(std::memory_order_seq_cst) - (tail + len);
+        if (before > _lowWater && after <= _lowWater) {
+            xEventGroupSetBits(_events, EVT_LOW_WATER);
+        }
+    }
+
+    // Move as much backlog as fits into the hot window, in at most four
+    // large memcpy calls (two wrap points on each side).
+    void refillHot() {
+        size_t moved = 0;
+        while (true) {
+            size_t hotFree = _hotSize - (_hotHead - _hotTail);
+            if (hotFree == 0) break;
+            Span src = backlogSpan();
+            if (src.len == 0) break;
+
+            size_t offset = _hotHead & _hotMask;
+            size_t len = _hotSize - offset;
+            if (len > hotFree) len = hotFree;
+            if (len > src.len) len = src.len;
+
+            memcpy(_hot + offset, src.data, len);
+            _hotHead += len;
+            _hotCount.store(_hotHead - _hotTail, std::memory_order_relaxed);
+            consumeBacklog(len);
+            moved += len;
+        }
+        if (moved) {
+            _psramOut.fetch_add(moved, std::memory_order_relaxed);
+            _psramAccesses.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    Span acquireHot(size_t maxLen) {
+        size_t count = _hotHead - _hotTail;
+        if (count <= _hotSize / 2) {
+            refillHot();
+            count = _hotHead - _hotTail;
+        }
+
+        size_t offset = _hotTail & _hotMask;
+        size_t len = _hotSize - offset;
+        if (len > count) len = count;
+        if (maxLen && len > maxLen) len = maxLen;
+        return {_hot + offset, len};
+    }
+
+    static size_t floorPow2(size_t v) {
+        size_t p = 1;
+        while (p <= v / 2) p <<= 1;
+        return p;
+    }
 };
 
 #endif
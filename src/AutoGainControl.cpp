@@ -0,0 +1,138 @@
+#include "AutoGainControl.h"
+#include "AudioDsp.h"
+#include <math.h>
+
+static const float NOISE_DOWN = 0.3f;       // Per frame, towards a quieter floor
+static const float NOISE_UP = 0.01f;        // Per frame, towards a louder floor
+static const float NOISE_UP_IN_SPEECH = 0.001f;  // So a louder room is not speech forever
+static const float SPEECH_OVER_NOISE = 10.0f;
+static const float LIMIT_DBFS = -1.0f;      // Digital stage output ceiling
+static const int16_t CLIP_LEVEL = 32000;    // Input peak counted as ADC clipping
+static const float PGA_UP_AT = 9.0f;        // Digital gain above this: more PGA
+static const float PGA_DOWN_AT = -3.0f;     // Digital gain below this: less PGA
+static const float MIN_GAIN_DB = -24.0f;
+
+bool AutoGainControl::begin(uint32_t sampleRate, float pgaDb, float pgaMinDb, float pgaMaxDb) {
+    if (sampleRate == 0 || pgaMinDb > pgaMaxDb) return false;
+    _rate = sampleRate;
+    _pgaDb = pgaDb;
+    _pgaMinDb = pgaMinDb;
+    _pgaMaxDb = pgaMaxDb;
+    _pgaPending = false;
+    _samplesSincePga = 0;
+    _levelKnown = false;
+    _noiseKnown = false;
+    _gainDb = 0;
+    _gainQ12 = 4096;
+    _stats = {};
+    _stats.pgaDb = pgaDb;
+    return true;
+}
+
+void AutoGainControl::setMaxDigitalGainDb(float db) {
+    // Q12 gains top out just under 8x
+    _maxGainDb = db > 18.0f ? 18.0f : db;
+}
+
+void AutoGainControl::requestPga(float db) {
+    if (db < _pgaMinDb) db = _pgaMinDb;
+    if (db > _pgaMaxDb) db = _pgaMaxDb;
+    if (fabsf(db - _pgaDb) < 0.01f) return;
+    _pgaRequestDb = db;
+    _pgaPending = true;
+}
+
+void AutoGainControl::pgaApplied(float db) {
+    // Everything measured at the input moves with the analog gain
+    float delta = db - _pgaDb;
+    _pgaDb = db;
+    _levelDb += delta;
+    _noiseDb += delta;
+    _gainDb -= delta;
+    _pgaPending = false;
+    _samplesSincePga = 0;
+    _stats.pgaDb = db;
+    _stats.pgaChanges++;
+}
+
+void AutoGainControl::process(int16_t* pcm, size_t n, bool adapt) {
+    if (n == 0) return;
+
+    AudioDsp::Level in = AudioDsp::measureLevel(pcm, n);
+    float frameDb = 20.0f * log10f(in.rms() + 1.0f) - 90.3f;   // dBFS
+    float peakDb = 20.0f * log10f((float)in.peak + 1.0f) - 90.3f;
+    _samplesSincePga += n;
+
+    if (in.peak >= CLIP_LEVEL) _stats.clippedFrames++;
+
+    float ms = 1000.0f * n / _rate;
+    if (adapt) {
+        if (!_noiseKnown) {
+            _noiseDb = frameDb;
+            _noiseKnown = true;
+        }
+        bool speech = frameDb > _noiseDb + SPEECH_OVER_NOISE;
+        if (!speech) {
+            _noiseDb += (frameDb - _noiseDb) * (frameDb < _noiseDb ? NOISE_DOWN : NOISE_UP);
+        } else {
+            _noiseDb += (frameDb - _noiseDb) * NOISE_UP_IN_SPEECH;
+            if (!_levelKnown) {
+                _levelDb = frameDb;
+                _levelKnown = true;
+            } else {
+                float tau = frameDb > _levelDb ? _attackMs : _releaseMs;
+                _levelDb += (frameDb - _levelDb) * (1.0f - expf(-ms / tau));
+            }
+        }
+
+        float want = _levelKnown ? _targetDb - _levelDb : 0;
+        if (want > _maxGainDb) want = _maxGainDb;
+        if (want < MIN_GAIN_DB) want = MIN_GAIN_DB;
+
+        // Rise at the release rate (dB per frame of a one-pole on the level)
+        if (want > _gainDb) {
+            _gainDb += (want - _gainDb) * (1.0f - expf(-ms / _releaseMs));
+        } else {
+            _gainDb += (want - _gainDb) * (1.0f - expf(-ms / _attackMs));
+        }
+
+        // Analog steps: clipping can't wait, the rest is rate limited
+        if (!_pgaPending) {
+            bool due = _samplesSincePga >= (uint64_t)_pgaIntervalMs * _rate / 1000;
+            if (in.peak >= CLIP_LEVEL && _pgaDb > _pgaMinDb) {
+                requestPga(_pgaDb - 2 * _pgaStepDb);
+            } else if (due && _levelKnown && speech) {
+                if (want > PGA_UP_AT && _pgaDb < _pgaMaxDb) requestPga(_pgaDb + _pgaStepDb);
+                else if (want < PGA_DOWN_AT && _pgaDb > _pgaMinDb) requestPga(_pgaDb - _pgaStepDb);
+            }
+        }
+    }
+
+    // Never push this frame's peak past the ceiling
+    float gainDb = _gainDb;
+    if (peakDb + gainDb > LIMIT_DBFS) gainDb = LIMIT_DBFS - peakDb;
+    if (gainDb > _maxGainDb) gainDb = _maxGainDb;
+    if (gainDb < _gainDb) _gainDb = gainDb;
+
+    int32_t target = (int32_t)lrintf(4096.0f * powf(10.0f, gainDb / 20.0f));
+    if (target > 32767) target = 32767;
+
+    // Ramp up from the previous gain (Q12 with 8 extra fractional bits);
+    // cuts apply from the first sample
+    if (target < _gainQ12) _gainQ12 = target;
+    int32_t g = _gainQ12 << 8;
+    int32_t step = ((target - _gainQ12) << 8) / (int32_t)n;
+    uint32_t saturated = 0;
+    for (size_t i = 0; i < n; i++) {
+        g += step;
+        int32_t y = (pcm[i] * (g >> 8)) >> 12;
+        if (y > 32767 || y < -32768) saturated++;
+        pcm[i] = AudioDsp::saturate16(y);
+    }
+    _gainQ12 = target;
+
+    _stats.digitalGainDb = gainDb;
+    _stats.speechLevelDb = _levelDb;
+    _stats.noiseFloorDb = _noiseDb;
+    _stats.saturatedSamples += saturated;
+}
@@ -0,0 +1,87 @@
+#ifndef AUTO_GAIN_CONTROL_H
+#define AUTO_GAIN_CONTROL_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Closed-loop AGC for the capture path: a digital gain applied per frame,
+// plus coarse analog (PGA) steps that someone else applies over I2C.
+//
+// The speech level is an attack/release envelope of the frame RMS, updated
+// only on frames well above a tracked noise floor, so silence neither pumps
+// the gain up nor drags the level down. The digital gain brings that level
+// to the target (bounded by maxDigitalGainDb), drops at once if the frame
+// would clip and recovers at the release rate; it ramps across each frame.
+//
+// The PGA moves one step at a time (at most every pgaIntervalMs) when the
+// digital gain sits near its limits, and two steps down at once when the
+// ADC clips. The owner polls pgaChangePending(), writes the codec and
+// reports back with pgaApplied(); the digital gain compensates the step in
+// the same frame, so the output level does not jump.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+struct AgcStats {
+    float pgaDb;                // Analog gain in use
+    float digitalGainDb;        // Last frame
+    float speechLevelDb;        // Input speech envelope, dBFS
+    float noiseFloorDb;         // Input noise floor, dBFS
+    uint32_t clippedFrames;     // Frames the ADC clipped in (input at full scale)
+    uint32_t saturatedSamples;  // Output samples the digital stage had to saturate
+    uint32_t pgaChanges;
+};
+
+class AutoGainControl {
+public:
+    // pgaDb: the analog gain currently set; the PGA stays within [min, max]
+    bool begin(uint32_t sampleRate, float pgaDb, float pgaMinDb, float pgaMaxDb);
+
+    // Apply the gain in place. adapt = false holds level and gain (e.g.
+    // while the speaker is playing and the mic mostly hears echo).
+    void process(int16_t* pcm, size_t n, bool adapt = true);
+
+    // Tuning
+    void setTargetDbfs(float db) { _targetDb = db; }
+    void setMaxDigitalGainDb(float db);
+    void setAttackMs(float ms) { _attackMs = ms; }
+    void setReleaseMs(float ms) { _releaseMs = ms; }
+    void setPgaStepDb(float db) { _pgaStepDb = db; }
+    void setPgaIntervalMs(uint32_t ms) { _pgaIntervalMs = ms; }
+
+    // PGA handshake
+    bool pgaChangePending() const { return _pgaPending; }
+    float requestedPgaDb() const { return _pgaRequestDb; }
+    void pgaApplied(float db);
+
+    float digitalGainDb() const { return _gainDb; }
+    const AgcStats& stats() const { return _stats; }
+
+private:
+    uint32_t _rate = 16000;
+    float _targetDb = -18.0f;
+    float _maxGainDb = 18.0f;
+    float _attackMs = 20.0f;
+    float _releaseMs = 800.0f;
+    float _pgaStepDb = 3.0f;
+    uint32_t _pgaIntervalMs = 1000;
+
+    float _pgaDb = 0;
+    float _pgaMinDb = 0;
+    float _pgaMaxDb = 0;
+    bool _pgaPending = false;
+    float _pgaRequestDb = 0;
+    uint32_t _samplesSincePga = 0;
+
+    float _levelDb = -40.0f;
+    float _noiseDb = -60.0f;
+    bool _noiseKnown = false;
+    bool _levelKnown = false;
+    float _gainDb = 0;
+    int32_t _gainQ12 = 4096;    // Applied at the end of the last frame
+
+    AgcStats _stats = {};
+
+    void requestPga(float db);
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "Beamformer.h"
+#include "AudioDsp.h"
+#include <math.h>
+#include <string.h>
+
+static const float SPEED_OF_SOUND_MM_S = 343000.0f;
+
+Beamformer::Beamformer() {
+    memset(_delayQ8, 0, sizeof(_delayQ8));
+    memset(_buf, 0, sizeof(_buf));
+    memset(_power, 0, sizeof(_power));
+}
+
+bool Beamformer::begin(const MicPosition* positions, size_t numMics, uint32_t sampleRate) {
+    if (numMics == 0 || numMics > BEAM_MAX_MICS) return false;
+    _mics = numMics;
+
+    for (size_t d = 0; d < BEAM_DIRECTIONS; d++) {
+        float az = 2.0f * (float)M_PI * d / BEAM_DIRECTIONS;
+        float ux = cosf(az);
+        float uy = sinf(az);
+
+        // Mic m hears the wavefront (p.u)/c early; delay it by that much,
+        // offset so the smallest delay is zero.
+        float proj[BEAM_MAX_MICS];
+        float minProj = 0;
+        for (size_t m = 0; m < numMics; m++) {
+            proj[m] = positions[m].xMm * ux + positions[m].yMm * uy;
+            if (m == 0 || proj[m] < minProj) minProj = proj[m];
+        }
+        for (size_t m = 0; m < numMics; m++) {
+            float samples = (proj[m] - minProj) / SPEED_OF_SOUND_MM_S * sampleRate;
+            if (samples >= BEAM_MAX_DELAY - 1) return false;  // Array too wide for history
+            _delayQ8[d][m] = (uint16_t)lroundf(samples * 256.0f);
+        }
+    }
+
+    memset(_buf, 0, sizeof(_buf));
+    memset(_power, 0, sizeof(_power));
+    _direction = 0;
+    _frameCount = 0;
+    return true;
+}
+
+void Beamformer::steer(int direction) {
+    if (direction < 0) {
+        _locked = -1;
+        return;
+    }
+    _locked = direction % BEAM_DIRECTIONS;
+    _direction = _locked;
+}
+
+// Fractional-delay tap: x[n - d] with linear interpolation between samples
+static inline int32_t tap(const int16_t* x, size_t n, uint16_t delayQ8) {
+    const int16_t* p = x + n - (delayQ8 >> 8);
+    int32_t frac = delayQ8 & 0xFF;
+    int32_t a = p[0];
+    return a + (((p[-1] - a) * frac) >> 8);
+}
+
+void Beamformer::steerInto(size_t dir, int16_t* out, size_t frames) {
+    const uint16_t* delays = _delayQ8[dir];
+    const int32_t invMics = 32768 / _mics;
+
+    for (size_t n = 0; n < frames; n++) {
+        size_t idx = BEAM_MAX_DELAY + n;
+        int32_t acc = 0;
+        for (size_t m = 0; m < _mics; m++) acc += tap(_buf[m], idx, delays[m]);
+        out[n] = AudioDsp::saturate16((acc * invMics) >> 15);
+    }
+}
+
+uint64_t Beamformer::steeredEnergy(size_t dir, size_t frames) {
+    const uint16_t* delays = _delayQ8[dir];
+    uint64_t energy = 0;
+
+    // Every second sample is plenty for a power estimate and halves the scan
+    for (size_t n = 0; n < frames; n += 2) {
+        size_t idx = BEAM_MAX_DELAY + n;
+        int32_t acc = 0;
+        for (size_t m = 0; m < _mics; m++) acc += tap(_buf[m], idx, delays[m]);
+        acc >>= 2;
+        energy += (uint32_t)(acc * acc);
+    }
+    return energy;
+}
+
+void Beamformer::scanDirections(size_t frames) {
+    // Skip quiet frames: the DOA of background noise is meaningless
+    AudioDsp::Level level = AudioDsp::measureLevel(_buf[0] + BEAM_MAX_DELAY, frames);
+    if (level.rms() < _doaMinRms) return;
+
+    size_t best = 0;
+    for (size_t d = 0; d < BEAM_DIRECTIONS; d++) {
+        uint32_t p = (uint32_t)(steeredEnergy(d, frames) / (frames / 2));
+        _power[d] = (_power[d] >> 1) + (p >> 1);
+        if (_power[d] > _power[best]) best = d;
+    }
+
+    // Hysteresis: only move when the new peak is clearly stronger (+0.5 dB)
+    if (best != _direction &&
+        (uint64_t)_power[best] * 8 > (uint64_t)_power[_direction] * 9) {
+        _direction = best;
+    }
+}
+
+void Beamformer::process(const int16_t* interleaved, int16_t* out, size_t frames) {
+    if (_mics == 0 || frames == 0) return;
+    if (frames > BEAM_MAX_FRAME) frames = BEAM_MAX_FRAME;
+    uint32_t start = AudioDsp::cycleCount();
+
+    for (size_t n = 0; n < frames; n++) {
+        const int16_t* s = interleaved + n * _mics;
+        for (size_t m = 0; m < _mics; m++) _buf[m][BEAM_MAX_DELAY + n] = s[m];
+    }
+
+    if (_locked < 0 && _doaInterval && ++_frameCount >= _doaInterval) {
+        _frameCount = 0;
+        scanDirections(frames);
+    }
+
+    steerInto(_direction, out, frames);
+
+    // Keep the tail of this frame as history for the next one
+    for (size_t m = 0; m < _mics; m++) {
+        memmove(_buf[m], _buf[m] + frames, BEAM_MAX_DELAY * sizeof(int16_t));
+    }
+
+    _lastCycles = AudioDsp::cycleCount() - start;
+    if (_lastCycles > _maxCycles) _maxCycles = _lastCycles;
+}
@@ -36,6 +36,29 @@
 #define AUDIO_SAMPLE_RATE           24000
 #define AUDIO_BITS_PER_SAMPLE       I2S_BITS_PER_SAMPLE_16BIT
 
+// Transcription input_audio_format. pcm16 is 24 kHz, 2 bytes/sample; the
+// G.711 formats are 8 kHz, 1 byte/sample (1/6 of the uplink bytes)
+#define UPLINK_FORMAT_PCM16         0
+#define UPLINK_FORMAT_G711_ULAW     1
+#define UPLINK_FORMAT_G711_ALAW     2
+#define UPLINK_AUDIO_FORMAT         UPLINK_FORMAT_PCM16
+
+// Stage rates. I2S and both codecs run at AUDIO_SAMPLE_RATE; a stage whose
+// rate differs gets a polyphase Resampler (equal rates cost nothing).
+#define CAPTURE_SAMPLE_RATE         24000   // Frames after AEC/NS/AGC: VAD, gate, uplink input
+#if UPLINK_AUDIO_FORMAT == UPLINK_FORMAT_PCM16
+#define UPLINK_SAMPLE_RATE          24000   // To transcription; fixed by the format
+#define UPLINK_BYTES_PER_SAMPLE     2
+#else
+#define UPLINK_SAMPLE_RATE          8000
+#define UPLINK_BYTES_PER_SAMPLE     1
+#endif
+#define TTS_SAMPLE_RATE             24000   // ElevenLabs pcm_<rate>: 16000, 22050, 24000, 44100
+
+#if CAPTURE_SAMPLE_RATE > AUDIO_SAMPLE_RATE
+#error "A capture frame holds CAPTURE_FRAME_SAMPLES at the I2S rate: CAPTURE_SAMPLE_RATE must not exceed it"
+#endif
+
 // Power Amplifier Control
 #define PA_ENABLE_PIN               12
 
@@ -75,4 +98,90 @@ enum KorvoButton {
 #define I2S_DMA_BUF_COUNT           8
 #define I2S_DMA_BUF_LEN             512
 
+// Capture task (mic -> frame ring), pinned away from loop() on core 1
+#define CAPTURE_TASK_CORE           0
+#define CAPTURE_TASK_PRIORITY       18      // Below WiFi (23), above loop (1)
+#define CAPTURE_DMA_BUF_COUNT       8       // RX DMA buffers of CAPTURE_FRAME_SAMPLES
+#define CAPTURE_RING_FRAMES         32      // ~340 ms of mono audio
+
+// Mic array (ES7210 in TDM mode: 4 x 16-bit slots per frame, read as 32-bit stereo)
+#define CAPTURE_TDM                 1       // 0 = legacy 2-channel capture + downmix
+#define MIC_TDM_SLOTS               4
+#define MIC_ARRAY_COUNT             3       // First 3 slots are the array mics
+#define MIC_ARRAY_POSITIONS         { {0.0f, 32.0f}, {-27.7f, -16.0f}, {27.7f, -16.0f} }  // mm, nominal
+#define CAPTURE_TASK_STACK          6144
+
+// Acoustic echo cancellation: mic stays open while the assistant speaks
+#define AEC_ENABLED                 1
+#define AEC_PARTITIONS              6       // x 256 taps = 64 ms echo tail
+#define AEC_REFERENCE_SAMPLES       8192    // Far-end history (~340 ms)
+#define AEC_REF_MARGIN_US           2000    // Capture timestamps run late; keeps the echo causal
+
+// Stationary noise suppression after AEC (adds one frame, ~10.7 ms, of latency)
+#define NS_ENABLED                  1
+#define NS_MAX_ATTENUATION_DB       15
+
+// AGC: digital gain per frame plus ES7210 PGA steps (applied from loop())
+#define AGC_ENABLED                 1
+#define AGC_TARGET_DBFS             -18     // Speech level sent upstream
+#define AGC_MAX_DIGITAL_GAIN_DB     18
+#define AGC_PGA_START_DB            30.0f   // ES7210 boots at 37.5 dB; leave headroom
+#define AGC_PGA_MAX_DB              37.5f
+
+// Local VAD gating the uplink (frames of CAPTURE_FRAME_SAMPLES, ~10.7 ms)
+#define VAD_ENABLED                 1
+#define VAD_PREROLL_FRAMES          28      // ~300 ms ahead of each utterance (server prefix_padding_ms)
+#define VAD_HANGOVER_FRAMES         94      // ~1 s, longer than the server VAD's 700 ms silence window
+
+// Uplink audio held while the transcription session (re)connects, replayed
+// once it is ready (frames of CAPTURE_FRAME_SAMPLES, ~10.7 ms)
+#define SESSION_PREROLL_FRAMES      47      // ~500 ms
+
+// Keep the transcription WebSocket open through TTS (the server buffer is
+// cleared after each answer) instead of reconnecting every turn
+#define TRANSCRIPTION_KEEP_SESSION  1
+
+// Start the LLM on a settled partial transcript instead of waiting for the
+// final one; cancelled (and re-asked) if the final transcript differs
+#define LLM_SPECULATIVE_ENABLED     1
+#define LLM_SPECULATIVE_QUIET_MS    150     // No new delta for this long
+
+// Speak the answer segment by segment (sentences, long clauses) while the
+// LLM is still writing it, instead of waiting for the whole reply
+#define LLM_STREAMING_TTS           1
+#define TTS_SEGMENT_QUEUE           16      // Segments waiting for TTS
+
+// Conversation history sent with each LLM request: oldest exchanges are
+// dropped to stay under the token budget (estimated, ~4 chars per token)
+#define LLM_HISTORY_TOKENS          1000
+#define LLM_HISTORY_ARENA_BYTES     (16 * 1024)     // PSRAM
+#define LLM_HISTORY_MAX_MESSAGES    40
+
+// Chain LLM turns on the server (store + previous_response_id): each request
+// carries only the new message. Falls back to the local history when the
+// stored response is gone. Off: nothing is stored on the server.
+#define LLM_SERVER_STATE            0
+
+// LLM and TTS requests reuse one keep-alive TLS connection per host, opened
+// when speech starts so the handshakes overlap the user talking
+#define HTTP_KEEPALIVE_ENABLED      1
+#define HTTP_KEEPALIVE_IDLE_MS      30000   // Reconnect instead of reusing a socket idle this long
+#define HTTP_PREWARM_ON_SPEECH      1
+
+// Uplink packets: capture frames are coalesced into one append message of
+// MIN..MAX ms, grown when sends stall and shrunk back while the link is idle
+#define UPLINK_PACKET_MIN_MS        20
+#define UPLINK_PACKET_MAX_MS        200
+#define UPLINK_PACKET_START_MS      40
+
+// Playback DMA. With AEC, short buffers bound how far the far-end timing
+// estimate can be off (one buffer, ~10.7 ms).
+#if AEC_ENABLED
+#define PLAYBACK_DMA_BUF_COUNT      16
+#define PLAYBACK_DMA_BUF_LEN        256
+#else
+#define PLAYBACK_DMA_BUF_COUNT      8
+#define PLAYBACK_DMA_BUF_LEN        1024
+#endif
+
 #endif // BOARD_CONFIG_H
@@ -0,0 +1,91 @@
+#ifndef CAPTURE_FRAME_RING_H
+#define CAPTURE_FRAME_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <atomic>
+
+// Mono samples per captured frame: one I2S RX DMA buffer (~10.7 ms @ 24 kHz)
+static const size_t CAPTURE_FRAME_SAMPLES = 256;
+
+struct CaptureFrame {
+    int64_t timestampUs;    // esp_timer time of the first sample
+    uint32_t firstSample;   // Running mono sample index since capture start
+    uint16_t samples;       // Valid samples in pcm[]
+    uint16_t peak;          // max |x| of pcm[]
+    uint16_t rms;           // RMS of pcm[]
+    int16_t pcm[CAPTURE_FRAME_SAMPLES];
+};
+
+// Single-producer / single-consumer ring of fixed-size capture frames.
+// The capture task fills slots in place (acquireWrite/commitWrite); the
+// uplink consumer reads them in place (peek/pop). Slot count is rounded
+// down to a power of two.
+
+class CaptureFrameRing {
+public:
+    CaptureFrameRing(size_t frames) {
+        _count = 1;
+        while (_count <= frames / 2) _count <<= 1;
+        _mask = _count - 1;
+        _frames = (CaptureFrame*)malloc(_count * sizeof(CaptureFrame));
+        _head.store(0, std::memory_order_relaxed);
+        _tail.store(0, std::memory_order_relaxed);
+    }
+
+    ~CaptureFrameRing() {
+        if (_frames) free(_frames);
+    }
+
+    bool isAllocated() const {
+        return _frames != NULL;
+    }
+
+    size_t capacity() const {
+        return _frames ? _count : 0;
+    }
+
+    // Producer: next free slot, or NULL if the consumer has fallen behind.
+    CaptureFrame* acquireWrite() {
+        if (!_frames) return NULL;
+        size_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= _count) return NULL;
+        return &_frames[head & _mask];
+    }
+
+    void commitWrite() {
+        _head.store(_head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Consumer: oldest frame, or NULL if empty.
+    const CaptureFrame* peek() const {
+        if (!_frames) return NULL;
+        size_t tail = _tail.load(std::memory_order_relaxed);
+        if (_head.load(std::memory_order_acquire) == tail) return NULL;
+        return &_frames[tail & _mask];
+    }
+
+    void pop() {
+        _tail.store(_tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    size_t available() const {
+        size_t tail = _tail.load(std::memory_order_acquire);
+        return _head.load(std::memory_order_acquire) - tail;
+    }
+
+    // Consumer: drop everything captured so far.
+    void discardAll() {
+        _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+    }
+
+private:
+    CaptureFrame* _frames;
+    size_t _count;
+    size_t _mask;
+    std::atomic<size_t> _head;
+    std::atomic<size_t> _tail;
+};
+
+#endif
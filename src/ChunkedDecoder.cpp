@@ -0,0 +1,96 @@
+#include "ChunkedDecoder.h"
+
+// 8 hex digits: chunks up to 4 GB, more than any response here
+static const uint8_t MAX_SIZE_DIGITS = 8;
+
+static inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+void ChunkedDecoder::reset() {
+    _state = SIZE;
+    _remaining = 0;
+    _digits = 0;
+    _trailerLine = 0;
+}
+
+// End of a chunk size line: the body goes on, or the trailer starts
+void ChunkedDecoder::endSizeLine() {
+    if (_digits == 0) {
+        _state = FAILED;
+        return;
+    }
+    _digits = 0;
+    _state = _remaining ? DATA : TRAILER;
+}
+
+size_t ChunkedDecoder::feed(const char* data, size_t len) {
+    if (_state == DONE || _state == FAILED) return 0;
+
+    size_t i = 0;
+    while (i < len) {
+        if (_state == DATA) {
+            // Hand on as much of the chunk as this piece holds
+            size_t n = len - i;
+            if (n > _remaining) n = _remaining;
+            if (_sink) _sink(data + i, n);
+            i += n;
+            _remaining -= n;
+            if (_remaining == 0) _state = DATA_CR;
+            continue;
+        }
+
+        char c = data[i++];
+        switch (_state) {
+            case SIZE: {
+                int v = hexValue(c);
+                if (v >= 0) {
+                    if (++_digits > MAX_SIZE_DIGITS) _state = FAILED;
+                    else _remaining = (_remaining << 4) | v;
+                } else if (c == ';' || c == ' ' || c == '\t') {
+                    _state = EXTENSION;
+                } else if (c == '\r') {
+                    _state = SIZE_LF;
+                } else if (c == '\n') {
+                    endSizeLine();
+                } else {
+                    _state = FAILED;
+                }
+                break;
+            }
+            case EXTENSION:
+                if (c == '\r') _state = SIZE_LF;
+                else if (c == '\n') endSizeLine();
+                break;
+            case SIZE_LF:
+                if (c == '\n') endSizeLine();
+                else _state = FAILED;
+                break;
+            case DATA_CR:
+                if (c == '\r') _state = DATA_LF;
+                else if (c == '\n') _state = SIZE;
+                else _state = FAILED;
+                break;
+            case DATA_LF:
+                if (c == '\n') _state = SIZE;
+                else _state = FAILED;
+                break;
+            case TRAILER:
+                // Header lines until an empty one ends the body
+                if (c == '\n') {
+                    if (_trailerLine == 0) _state = DONE;
+                    _trailerLine = 0;
+                } else if (c != '\r') {
+                    _trailerLine++;
+                }
+                break;
+            default:
+                break;
+        }
+        if (_state == DONE || _state == FAILED) break;
+    }
+    return i;
+}
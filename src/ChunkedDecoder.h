@@ -0,0 +1,43 @@
+#ifndef CHUNKED_DECODER_H
+#define CHUNKED_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+// Incremental HTTP/1.1 chunked transfer decoder.
+//
+// Takes the body in whatever pieces the socket returns and passes the
+// chunk payloads on as spans of the caller's buffer, so nothing is copied.
+// Chunk extensions and trailers are skipped; bare LF line ends are
+// accepted. Anything else malformed makes it fail rather than guess.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+class ChunkedDecoder {
+public:
+    typedef std::function<void(const char* data, size_t len)> Sink;
+
+    void setSink(Sink sink) { _sink = sink; }
+    void reset();
+
+    // Returns the bytes consumed: all of them, unless the body ends (or
+    // turns out malformed) part way through
+    size_t feed(const char* data, size_t len);
+
+    bool done() const { return _state == DONE; }
+    bool failed() const { return _state == FAILED; }
+
+private:
+    enum State { SIZE, EXTENSION, SIZE_LF, DATA, DATA_CR, DATA_LF, TRAILER, DONE, FAILED };
+
+    Sink _sink;
+    State _state = SIZE;
+    uint32_t _remaining = 0;    // Chunk size while reading it, then bytes left
+    uint8_t _digits = 0;
+    size_t _trailerLine = 0;    // Length of the trailer line being skipped
+
+    void endSizeLine();
+};
+
+#endif
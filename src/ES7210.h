@@ -118,8 +118,17 @@ public:
         return true;
     }
 
+    // TDM: all four ADC channels in one LRCK frame (16-bit slots, MSB first).
+    // Off = standard I2S, ADC1/ADC2 on L/R only.
+    void setTdmMode(bool enable) {
+        writeReg(ES7210_SDP_INTERFACE2_REG12, enable ? 0x02 : 0x00);
+        Serial.printf("ES7210: TDM %s (REG12=0x%02X)\n", enable ? "on" : "off",
+            readReg(ES7210_SDP_INTERFACE2_REG12));
+    }
+
+    // Raw MIC gain register: bit 4 enables the PGA, bits 0-3 are the step
+    // (see pgaStepDb). 0x1E = 37.5 dB.
     void setGain(uint8_t gain) {
-        // Gain range: 0-0x1F (0dB to +37.5dB)
         if (gain > 0x1F) gain = 0x1F;
         writeReg(ES7210_MIC1_GAIN_REG43, gain);
         writeReg(ES7210_MIC2_GAIN_REG44, gain);
@@ -127,6 +136,21 @@ public:
         writeReg(ES7210_MIC4_GAIN_REG46, gain);
     }
 
+    // PGA steps: 0-11 = 0..33 dB in 3 dB steps, 12-14 = 34.5..37.5 dB
+    static const uint8_t PGA_STEPS = 15;
+    static float pgaStepDb(uint8_t step) {
+        if (step >= PGA_STEPS) step = PGA_STEPS - 1;
+        return step <= 11 ? step * 3.0f : 33.0f + (step - 11) * 1.5f;
+    }
+
+    // Nearest PGA step at or below db on all four mics; returns what was applied
+    float setGainDb(float db) {
+        uint8_t step = 0;
+        while (step + 1 < PGA_STEPS && pgaStepDb(step + 1) <= db + 0.01f) step++;
+        setGain(0x10 | step);
+        return pgaStepDb(step);
+    }
+
 private:
     TwoWire *_wire;
     uint8_t _addr;
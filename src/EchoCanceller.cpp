@@ -0,0 +1,178 @@
+#include "EchoCanceller.h"
+#include "AudioDsp.h"
+#include <math.h>
+#include <string.h>
+#include <esp_heap_caps.h>
+
+static const float ENERGY_SMOOTH = 0.9f;
+static const float POWER_SMOOTH = 0.9f;
+static const float CONVERGED_DB = 6.0f;      // Below this the DTD stays quiet
+static const float DOUBLE_TALK_DROP = 10.0f;  // Block ERLE 10 dB under the average
+static const int DOUBLE_TALK_HOLD = 10;      // Blocks (~107 ms)
+static const int ECHO_PATH_CHANGE = 300;     // ~3.2 s of continuous "double talk"
+
+EchoCanceller::~EchoCanceller() {
+    if (_mem) heap_caps_free(_mem);
+}
+
+bool EchoCanceller::begin(size_t partitions) {
+    if (partitions == 0) return false;
+    if (!_fft.begin(2 * AEC_BLOCK)) return false;
+
+    if (_mem) heap_caps_free(_mem);
+    size_t spectrum = _bins * 2;
+    size_t floats = 2 * partitions * spectrum + _bins + 2 * AEC_BLOCK + spectrum + AEC_BLOCK;
+
+    // The filter loop touches all of this every block: keep it in internal RAM
+    _mem = (float*)heap_caps_malloc(floats * sizeof(float), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!_mem) _mem = (float*)heap_caps_malloc(floats * sizeof(float), MALLOC_CAP_8BIT);
+    if (!_mem) {
+        _parts = 0;
+        return false;
+    }
+
+    _parts = partitions;
+    _weights = _mem;
+    _refSpectra = _weights + partitions * spectrum;
+    _refPower = _refSpectra + partitions * spectrum;
+    _time = _refPower + _bins;
+    _spec = _time + 2 * AEC_BLOCK;
+    _refHistory = _spec + spectrum;
+    reset();
+    return true;
+}
+
+void EchoCanceller::reset() {
+    if (!_mem) return;
+    size_t spectrum = _bins * 2;
+    size_t floats = 2 * _parts * spectrum + _bins + 2 * AEC_BLOCK + spectrum + AEC_BLOCK;
+    memset(_mem, 0, floats * sizeof(float));
+
+    _newest = 0;
+    _constrainNext = 0;
+    _micEnergy = 0;
+    _errEnergy = 0;
+    _farActive = false;
+    _dtHold = 0;
+    _dtRun = 0;
+}
+
+float EchoCanceller::erleDb() const {
+    if (_errEnergy <= 0 || _micEnergy <= 0) return 0;
+    return 10.0f * log10f(_micEnergy / _errEnergy);
+}
+
+// Gradient constraint: force partition p back to a causal AEC_BLOCK-tap filter
+void EchoCanceller::constrain(size_t p) {
+    float* w = weights(p);
+    _fft.inverse(w, _time);
+    memset(_time + AEC_BLOCK, 0, AEC_BLOCK * sizeof(float));
+    _fft.forward(_time, w);
+}
+
+void EchoCanceller::process(const int16_t* ref, int16_t* mic, size_t n) {
+    if (!_parts || n != AEC_BLOCK) return;
+    uint32_t start = AudioDsp::cycleCount();
+    const size_t N = AEC_BLOCK;
+
+    // Reference spectrum over [previous block, this block]
+    float farPower = 0;
+    for (size_t i = 0; i < N; i++) {
+        float x = ref[i];
+        _time[i] = _refHistory[i];
+        _time[N + i] = x;
+        _refHistory[i] = x;
+        farPower += x * x;
+    }
+    _newest = (_newest + 1) % _parts;
+    float* x0 = refSpectrum(0);
+    _fft.forward(_time, x0);
+
+    // Echo estimate: sum over partitions of W_p * X_{t-p}
+    memset(_spec, 0, _bins * 2 * sizeof(float));
+    for (size_t p = 0; p < _parts; p++) {
+        const float* w = weights(p);
+        const float* x = refSpectrum(p);
+        for (size_t f = 0; f < _bins; f++) {
+            float wr = w[2 * f], wi = w[2 * f + 1];
+            float xr = x[2 * f], xi = x[2 * f + 1];
+            _spec[2 * f] += wr * xr - wi * xi;
+            _spec[2 * f + 1] += wr * xi + wi * xr;
+        }
+    }
+    _fft.inverse(_spec, _time);
+
+    // Error = mic - echo estimate (overlap-save: last N outputs are valid)
+    float micEnergy = 0, errEnergy = 0;
+    for (size_t i = 0; i < N; i++) {
+        float d = mic[i];
+        float e = d - _time[N + i];
+        micEnergy += d * d;
+        errEnergy += e * e;
+        _time[N + i] = e;
+        mic[i] = AudioDsp::saturate16((int32_t)lrintf(e));
+    }
+
+    _farActive = farPower > _farFloor * N;
+    _blocks++;
+
+    // Double-talk: a converged filter whose block ERLE suddenly collapses is
+    // hearing the near end. Freeze adaptation (and the ERLE average) for a
+    // while; if it never recovers, assume the echo path moved instead.
+    if (_farActive) {
+        bool converged = erleDb() > CONVERGED_DB;
+        if (converged && errEnergy * _micEnergy > DOUBLE_TALK_DROP * micEnergy * _errEnergy) {
+            _dtHold = DOUBLE_TALK_HOLD;
+            if (++_dtRun > ECHO_PATH_CHANGE) {
+                _dtHold = 0;
+                _dtRun = 0;
+                _micEnergy = 0;
+                _errEnergy = 0;
+            }
+        } else {
+            _dtRun = 0;
+        }
+    }
+    if (_dtHold > 0) {
+        _dtHold--;
+        _dtBlocks++;
+    } else if (_farActive) {
+        _micEnergy = ENERGY_SMOOTH * _micEnergy + (1.0f - ENERGY_SMOOTH) * micEnergy;
+        _errEnergy = ENERGY_SMOOTH * _errEnergy + (1.0f - ENERGY_SMOOTH) * errEnergy;
+    }
+
+    for (size_t f = 0; f < _bins; f++) {
+        float pw = x0[2 * f] * x0[2 * f] + x0[2 * f + 1] * x0[2 * f + 1];
+        _refPower[f] = POWER_SMOOTH * _refPower[f] + (1.0f - POWER_SMOOTH) * pw;
+    }
+
+    if (_farActive && _dtHold == 0) {
+        memset(_time, 0, N * sizeof(float));
+        _fft.forward(_time, _spec);
+
+        // Normalised step per bin; the floor keeps quiet bins from blowing up
+        const float floorPower = 2.0f * N * _farFloor;
+        for (size_t f = 0; f < _bins; f++) {
+            float g = _mu / (_parts * _refPower[f] + floorPower);
+            _spec[2 * f] *= g;
+            _spec[2 * f + 1] *= g;
+        }
+
+        for (size_t p = 0; p < _parts; p++) {
+            float* w = weights(p);
+            const float* x = refSpectrum(p);
+            for (size_t f = 0; f < _bins; f++) {
+                float er = _spec[2 * f], ei = _spec[2 * f + 1];
+                float xr = x[2 * f], xi = x[2 * f + 1];
+                w[2 * f] += xr * er + xi * ei;       // conj(X) * E
+                w[2 * f + 1] += xr * ei - xi * er;
+            }
+        }
+
+        constrain(_constrainNext);
+        _constrainNext = (_constrainNext + 1) % _parts;
+    }
+
+    _lastCycles = AudioDsp::cycleCount() - start;
+    if (_lastCycles > _maxCycles) _maxCycles = _lastCycles;
+}
@@ -0,0 +1,96 @@
+#ifndef ECHO_CANCELLER_H
+#define ECHO_CANCELLER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "AudioFft.h"
+
+// Acoustic echo canceller: partitioned-block frequency-domain NLMS (PBFDAF).
+//
+// The echo path is modelled by `partitions` filters of AEC_BLOCK taps each,
+// applied to the far-end reference with 50% overlap-save FFTs
+// (2 * AEC_BLOCK points). Per block it costs three real FFTs plus one more
+// for the gradient constraint, which is applied to one partition per block
+// in rotation. With 6 partitions the tail is 64 ms at 24 kHz.
+//
+// Adaptation runs only while the far end is active and is frozen while a
+// double-talk detector sees near-end speech (the echo-return-loss suddenly
+// collapsing on a converged filter); a long freeze is treated as an echo
+// path change and adaptation resumes.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+static const size_t AEC_BLOCK = 256;
+
+class EchoCanceller {
+public:
+    EchoCanceller() {}
+    ~EchoCanceller();
+
+    bool begin(size_t partitions);
+    bool isReady() const { return _parts != 0; }
+
+    // Forget the echo path (e.g. after moving the board)
+    void reset();
+
+    // ref: far-end samples that played while mic was captured.
+    // mic is replaced by the echo-cancelled signal. n must be AEC_BLOCK;
+    // other sizes pass through unprocessed.
+    void process(const int16_t* ref, int16_t* mic, size_t n);
+
+    // NLMS step size (default 0.5)
+    void setStepSize(float mu) { _mu = mu; }
+
+    // Far-end RMS below this counts as silence: no adaptation
+    void setFarEndFloor(uint16_t rms) { _farFloor = (float)rms * rms; }
+
+    // Echo return loss enhancement, smoothed over far-end-active blocks
+    float erleDb() const;
+    bool doubleTalk() const { return _dtHold > 0; }
+    bool farEndActive() const { return _farActive; }
+
+    uint32_t lastBlockCycles() const { return _lastCycles; }
+    uint32_t maxBlockCycles() const { return _maxCycles; }
+    uint32_t blocksProcessed() const { return _blocks; }
+    uint32_t doubleTalkBlocks() const { return _dtBlocks; }
+
+private:
+    size_t _parts = 0;
+    size_t _bins = AEC_BLOCK + 1;
+    RealFft _fft;
+
+    float* _mem = nullptr;      // Single allocation for everything below
+    float* _weights;            // parts x (bins x 2)
+    float* _refSpectra;         // parts x (bins x 2), ring, newest at _newest
+    float* _refPower;           // bins, smoothed |X|^2
+    float* _time;               // 2 * AEC_BLOCK scratch
+    float* _spec;               // bins x 2 scratch
+    float* _refHistory;         // AEC_BLOCK: previous reference block
+
+    size_t _newest = 0;
+    size_t _constrainNext = 0;
+    float _mu = 0.5f;
+    float _farFloor = 100.0f * 100.0f;
+
+    float _micEnergy = 0;       // Smoothed, far-end-active blocks only
+    float _errEnergy = 0;
+    bool _farActive = false;
+    int _dtHold = 0;
+    int _dtRun = 0;
+
+    uint32_t _blocks = 0;
+    uint32_t _dtBlocks = 0;
+    uint32_t _lastCycles = 0;
+    uint32_t _maxCycles = 0;
+
+    EchoCanceller(const EchoCanceller&) = delete;
+    EchoCanceller& operator=(const EchoCanceller&) = delete;
+
+    float* weights(size_t p) { return _weights + p * _bins * 2; }
+    float* refSpectrum(size_t age) {
+        return _refSpectra + ((_newest + _parts - age) % _parts) * _bins * 2;
+    }
+    void constrain(size_t p);
+};
+
+#endif
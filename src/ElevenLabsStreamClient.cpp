@@ -1,9 +1,8 @@
 #include "ElevenLabsStreamClient.h"
-#include <WiFiClientSecure.h>
 #include <ArduinoJson.h>
 
 ElevenLabsStreamClient::ElevenLabsStreamClient(String apiKey, String voiceId)
-    : _apiKey(apiKey), _voiceId(voiceId) {
+    : _apiKey(apiKey), _voiceId(voiceId), _conn("api.elevenlabs.io") {
 }
 
 void ElevenLabsStreamClient::setVoiceId(String voiceId) {
@@ -26,22 +25,43 @@ String ElevenLabsStreamClient::getLastError() {
     return _lastError;
 }
 
-bool ElevenLabsStreamClient::speak(String text, AudioRingBuffer* outputBuffer) {
+// Wait for the first response byte; false if the socket closed or timed out
+static bool waitForResponse(WiFiClientSecure& client) {
+    unsigned long timeout = millis() + 10000;
+    while (client.connected() && !client.available()) {
+        if (millis() > timeout) return false;
+        delay(10);
+    }
+    return client.available() > 0;
+}
+
+void ElevenLabsStreamClient::sendRequest(const String& url, const String& body) {
+    WiFiClientSecure& client = _conn.client();
+    client.println("POST " + url + " HTTP/1.1");
+    client.println("Host: api.elevenlabs.io");
+    client.println("xi-api-key: " + _apiKey);
+    client.println("Content-Type: application/json");
+    client.println("Accept: audio/pcm");
+    client.println("Content-Length: " + String(body.length()));
+    client.println(HTTP_KEEPALIVE_ENABLED ? "Connection: keep-alive" : "Connection: close");
+    client.println();
+    client.print(body);
+}
+
+bool ElevenLabsStreamClient::speak(String text, AudioRingBuffer* outputBuffer, String previousText) {
     if (text.length() == 0 || !outputBuffer) {
         _lastError = "Invalid input";
         return false;
     }
 
-    WiFiClientSecure client;
-    client.setInsecure();
-    client.setTimeout(30000);
-
-    String url = "/v1/text-to-speech/" + _voiceId + "/stream?output_format=pcm_24000&optimize_streaming_latency=4";
+    String url = "/v1/text-to-speech/" + _voiceId + "/stream?output_format=pcm_" + String(TTS_SAMPLE_RATE) +
+                 "&optimize_streaming_latency=4";
 
     // Build request
     DynamicJsonDocument doc(1024);
     doc["text"] = text;
     doc["model_id"] = "eleven_turbo_v2_5";
+    if (previousText.length() > 0) doc["previous_text"] = previousText;
 
     JsonObject vs = doc.createNestedObject("voice_settings");
     vs["stability"] = 0.5;
@@ -50,32 +70,28 @@ bool ElevenLabsStreamClient::speak(String text, AudioRingBuffer* outputBuffer) {
     String body;
     serializeJson(doc, body);
 
-    if (!client.connect("api.elevenlabs.io", 443)) {
+    if (!_conn.acquire()) {
         _lastError = "Connect fail";
         if (_errorCallback) _errorCallback(_lastError);
         return false;
     }
-
-    // Send request
-    client.println("POST " + url + " HTTP/1.1");
-    client.println("Host: api.elevenlabs.io");
-    client.println("xi-api-key: " + _apiKey);
-    client.println("Content-Type: application/json");
-    client.println("Accept: audio/pcm");
-    client.println("Content-Length: " + String(body.length()));
-    client.println("Connection: close");
-    client.println();
-    client.print(body);
-
-    // Wait for response
-    unsigned long timeout = millis() + 10000;
-    while (client.connected() && !client.available()) {
-        if (millis() > timeout) {
-            _lastError = "Timeout";
-            client.stop();
-            return false;
+    WiFiClientSecure& client = _conn.client();
+
+    // Send request and wait for response. A kept-alive socket the server
+    // has since closed fails here: one retry on a fresh connection.
+    sendRequest(url, body);
+    bool responded = waitForResponse(client);
+    if (!responded && _conn.reused() && !client.connected()) {
+        Serial.println("[TTS] Kept-alive connection was closed, reconnecting");
+        if (_conn.reopen()) {
+            sendRequest(url, body);
+            responded = waitForResponse(client);
         }
-        delay(10);
+    }
+    if (!responded) {
+        _lastError = "Timeout";
+        _conn.release(false);
+        return false;
     }
 
     // Check status
@@ -83,73 +99,87 @@ bool ElevenLabsStreamClient::speak(String text, AudioRingBuffer* outputBuffer) {
     if (status.indexOf("200") < 0) {
         while (client.available()) client.read();
         _lastError = "HTTP error";
-        client.stop();
+        _conn.release(false);
         return false;
     }
 
     // Parse headers
     bool chunked = false;
+    bool keepAlive = true;
+    long contentLength = -1;
     while (client.connected()) {
         String h = client.readStringUntil('\n');
         h.trim();
         if (h.length() == 0) break;
+        h.toLowerCase();
         if (h.indexOf("chunked") >= 0) chunked = true;
+        if (h.startsWith("content-length:")) contentLength = h.substring(15).toInt();
+        if (h.startsWith("connection:") && h.indexOf("close") >= 0) keepAlive = false;
     }
 
     if (_audioStartCallback) _audioStartCallback();
 
-    // Read audio data
-    const int BUF_SIZE = 2048;
-    uint8_t* buf = (uint8_t*)malloc(BUF_SIZE);
-    if (!buf) {
-        _lastError = "OOM";
-        client.stop();
-        return false;
-    }
+    // Read audio data straight into the ring buffer (zero-copy).
+    // When the buffer is full we stop reading and let TCP flow control
+    // hold the server back until the player drains to the low watermark.
+    const size_t MAX_READ = 2048;
 
     size_t total = 0;
-    size_t dropped = 0;
     unsigned long lastData = millis();
+    bool complete = !chunked && contentLength == 0;     // Body read to its end: the socket can be reused
 
-    while (client.connected() || client.available()) {
+    while (!complete && (client.connected() || client.available())) {
         if (client.available()) {
-            int read;
-
             if (chunked) {
                 String chunkLine = client.readStringUntil('\n');
                 chunkLine.trim();
                 if (chunkLine.length() == 0) continue;
 
                 int chunkSize = strtol(chunkLine.c_str(), NULL, 16);
-                if (chunkSize == 0) break;
+                if (chunkSize == 0) {
+                    client.readStringUntil('\n');  // Blank line ending the body
+                    complete = true;
+                    break;
+                }
 
-                int remaining = chunkSize;
+                size_t remaining = chunkSize;
                 while (remaining > 0 && (client.connected() || client.available())) {
-                    int toRead = (remaining > BUF_SIZE) ? BUF_SIZE : remaining;
-                    read = client.read(buf, toRead);
+                    AudioRingBuffer::Span span = outputBuffer->acquireWrite(remaining < MAX_READ ? remaining : MAX_READ);
+                    if (span.len == 0) {
+                        outputBuffer->waitForSpace(pdMS_TO_TICKS(100));
+                        continue;
+                    }
+                    int read = client.read(span.data, span.len);
                     if (read > 0) {
-                        size_t written = outputBuffer->write(buf, read);
-                        if (written < (size_t)read) {
-                            dropped += (read - written);
-                        }
-                        total += written;
+                        outputBuffer->commitWrite(read);
+                        total += read;
                         remaining -= read;
                         lastData = millis();
                     } else {
+                        if (millis() - lastData > 15000) break;
                         delay(1);
                     }
                 }
+                if (remaining > 0) break;
                 client.readStringUntil('\n');
             } else {
-                read = client.read(buf, BUF_SIZE);
+                size_t want = MAX_READ;
+                if (contentLength >= 0 && (size_t)contentLength - total < want) want = contentLength - total;
+                AudioRingBuffer::Span span = outputBuffer->acquireWrite(want);
+                if (span.len == 0) {
+                    outputBuffer->waitForSpace(pdMS_TO_TICKS(100));
+                    continue;
+                }
+                int read = client.read(span.data, span.len);
                 if (read > 0) {
-                    size_t written = outputBuffer->write(buf, read);
-                    if (written < (size_t)read) {
-                        dropped += (read - written);
-                    }
-                    total += written;
+                    outputBuffer->commitWrite(read);
+                    total += read;
                     lastData = millis();
                 }
+                if (contentLength >= 0 && total >= (size_t)contentLength) {
+                    complete = true;
+                    break;
+                }
             }
         } else {
             if (millis() - lastData > 15000) break;
@@ -158,12 +188,7 @@ bool ElevenLabsStreamClient::speak(String text, AudioRingBuffer* outputBuffer) {
         yield();
     }
 
-    if (dropped > 0) {
-        Serial.printf("[TTS] WARNING: %d bytes dropped (buffer full)\n", dropped);
-    }
-
-    free(buf);
-    client.stop();
+    _conn.release(complete && keepAlive);
 
     if (_audioCompleteCallback) _audioCompleteCallback();
 
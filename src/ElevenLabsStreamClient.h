@@ -3,10 +3,12 @@
 
 #include <Arduino.h>
 #include "AudioRingBuffer.h"
+#include "HttpConnection.h"
+#include "BoardConfig.h"
 
 // ElevenLabs Text-to-Speech Streaming API
 // Model: eleven_flash_v2_5
-// Output: PCM16 @ 24kHz
+// Output: PCM16 @ TTS_SAMPLE_RATE
 
 class ElevenLabsStreamClient {
 public:
@@ -16,8 +18,10 @@ public:
     void setVoiceId(String voiceId);
 
     // Stream TTS audio to buffer
+    // previousText: what was spoken just before (keeps prosody continuous
+    // when an answer is sent segment by segment)
     // Returns true if successful
-    bool speak(String text, AudioRingBuffer* outputBuffer);
+    bool speak(String text, AudioRingBuffer* outputBuffer, String previousText = "");
 
     // Events
     void onAudioStart(std::function<void()> callback);
@@ -27,14 +31,21 @@ public:
     // Get last error
     String getLastError();
 
+    // Open the connection ahead of the next request
+    bool prewarm() { return _conn.prewarm(); }
+    const ConnectionStats& connectionStats() const { return _conn.stats(); }
+
 private:
     String _apiKey;
     String _voiceId;
     String _lastError;
+    HttpConnection _conn;
 
     std::function<void()> _audioStartCallback;
     std::function<void()> _audioCompleteCallback;
     std::function<void(String)> _errorCallback;
+
+    void sendRequest(const String& url, const String& body);
 };
 
 #endif
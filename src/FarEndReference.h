@@ -0,0 +1,123 @@
+#ifndef FAR_END_REFERENCE_H
+#define FAR_END_REFERENCE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+#include <esp_heap_caps.h>
+
+// Far-end (speaker) reference for the echo canceller.
+//
+// The playback task pushes every chunk it hands to i2s_write together with
+// the esp_timer time its first sample is expected to leave the DAC. The
+// capture task later asks for "what was playing during [t, t + n)" and gets
+// the matching samples, with zeros wherever nothing was playing (between
+// turns, or across a playback underrun).
+//
+// Single producer / single consumer. Samples live in a power-of-two ring;
+// each push also records a segment (first sample index, count, play time)
+// in a small segment ring, published with a release store.
+
+class FarEndReference {
+public:
+    static const size_t SEGMENTS = 64;
+
+    FarEndReference(size_t capacitySamples, uint32_t sampleRate) : _rate(sampleRate) {
+        _count = 1;
+        while (_count <= capacitySamples / 2) _count <<= 1;
+        _mask = _count - 1;
+        _pcm = (int16_t*)heap_caps_malloc(_count * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (!_pcm) _pcm = (int16_t*)heap_caps_malloc(_count * sizeof(int16_t), MALLOC_CAP_8BIT);
+        memset(_segments, 0, sizeof(_segments));
+    }
+
+    ~FarEndReference() {
+        if (_pcm) heap_caps_free(_pcm);
+    }
+
+    bool isAllocated() const {
+        return _pcm != NULL;
+    }
+
+    // Producer: n samples whose first one plays at playUs.
+    void push(const int16_t* pcm, size_t n, int64_t playUs) {
+        if (!_pcm || n == 0) return;
+        if (n > _count) {
+            pcm += n - _count;
+            playUs += (int64_t)(n - _count) * 1000000 / _rate;
+            n = _count;
+        }
+
+        uint32_t head = _head.load(std::memory_order_relaxed);
+        size_t first = head & _mask;
+        size_t part = (n < _count - first) ? n : _count - first;
+        memcpy(_pcm + first, pcm, part * sizeof(int16_t));
+        if (part < n) memcpy(_pcm, pcm + part, (n - part) * sizeof(int16_t));
+        _head.store(head + n, std::memory_order_release);
+
+        uint32_t seg = _segHead.load(std::memory_order_relaxed);
+        Segment& s = _segments[seg % SEGMENTS];
+        s.firstIndex = head;
+        s.count = n;
+        s.playUs = playUs;
+        _segHead.store(seg + 1, std::memory_order_release);
+    }
+
+    // Consumer: reference that played during [startUs, startUs + n / rate).
+    // Returns how many of the n samples were covered by playback.
+    size_t read(int64_t startUs, int16_t* out, size_t n) {
+        memset(out, 0, n * sizeof(int16_t));
+        if (!_pcm) return 0;
+
+        uint32_t segHead = _segHead.load(std::memory_order_acquire);
+        uint32_t oldest = (segHead > SEGMENTS - 1) ? segHead - (SEGMENTS - 1) : 0;
+        size_t covered = 0;
+
+        // Oldest first, so a newer segment wins where two overlap
+        for (uint32_t seg = oldest; seg != segHead; seg++) {
+            Segment s = _segments[seg % SEGMENTS];
+            int64_t offset = (s.playUs - startUs) * (int64_t)_rate;
+            offset = (offset >= 0) ? (offset + 500000) / 1000000 : -((-offset + 500000) / 1000000);
+            if (offset >= (int64_t)n || offset + (int64_t)s.count <= 0) continue;
+
+            size_t from = offset < 0 ? (size_t)(-offset) : 0;   // Into the segment
+            size_t to = offset > 0 ? (size_t)offset : 0;         // Into out
+            size_t len = s.count - from;
+            if (len > n - to) len = n - to;
+
+            // Skip samples the producer has already overwritten
+            uint32_t head = _head.load(std::memory_order_acquire);
+            if (head - (s.firstIndex + from) > _count) continue;
+
+            for (size_t i = 0; i < len; i++) {
+                out[to + i] = _pcm[(s.firstIndex + from + i) & _mask];
+            }
+            covered += len;
+        }
+
+        // Pushes that lapped the segment ring mid-scan make this block unreliable
+        if (_segHead.load(std::memory_order_acquire) - oldest > SEGMENTS) {
+            memset(out, 0, n * sizeof(int16_t));
+            return 0;
+        }
+        return covered > n ? n : covered;
+    }
+
+private:
+    struct Segment {
+        uint32_t firstIndex;
+        uint32_t count;
+        int64_t playUs;
+    };
+
+    int16_t* _pcm = NULL;
+    size_t _count;
+    size_t _mask;
+    uint32_t _rate;
+    std::atomic<uint32_t> _head{0};
+    std::atomic<uint32_t> _segHead{0};
+    Segment _segments[SEGMENTS];
+};
+
+#endif
@@ -0,0 +1,87 @@
+#include "G711.h"
+
+namespace G711 {
+
+// floor(log2(i)): the segment of a magnitude from its bits 14..7 (mu-law)
+// or 15..8 (A-law)
+static const uint8_t SEGMENT[256] = {
+    0, 0, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 3, 3, 3, 3,
+    4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+    7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7,
+};
+
+static const int32_t ULAW_BIAS = 0x84;
+static const int32_t ULAW_CLIP = 32635;
+
+static inline uint8_t ulaw(int32_t x) {
+    uint8_t sign = 0;
+    if (x < 0) {
+        x = -x;
+        sign = 0x80;
+    }
+    if (x > ULAW_CLIP) x = ULAW_CLIP;
+    x += ULAW_BIAS;
+
+    uint8_t seg = SEGMENT[(x >> 7) & 0xFF];
+    uint8_t mantissa = (x >> (seg + 3)) & 0x0F;
+    return ~(sign | (seg << 4) | mantissa);
+}
+
+static inline uint8_t alaw(int32_t x) {
+    // Sign bit set for positive samples; even bits inverted on the wire
+    uint8_t mask = 0xD5;
+    if (x < 0) {
+        x = -x - 1;
+        mask = 0x55;
+    }
+
+    uint8_t code;
+    if (x < 256) {
+        code = x >> 4;
+    } else {
+        uint8_t seg = SEGMENT[x >> 8] + 1;
+        code = (seg << 4) | ((x >> (seg + 3)) & 0x0F);
+    }
+    return code ^ mask;
+}
+
+void encodeUlaw(const int16_t* in, uint8_t* out, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = ulaw(in[i]);
+}
+
+void encodeAlaw(const int16_t* in, uint8_t* out, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = alaw(in[i]);
+}
+
+int16_t decodeUlaw(uint8_t code) {
+    code = ~code;
+    int32_t t = (((code & 0x0F) << 3) + ULAW_BIAS) << ((code & 0x70) >> 4);
+    return (int16_t)((code & 0x80) ? ULAW_BIAS - t : t - ULAW_BIAS);
+}
+
+int16_t decodeAlaw(uint8_t code) {
+    code ^= 0x55;
+    int32_t t = (code & 0x0F) << 4;
+    int seg = (code & 0x70) >> 4;
+    if (seg == 0) {
+        t += 8;
+    } else {
+        t = (t + 0x108) << (seg - 1);
+    }
+    return (int16_t)((code & 0x80) ? t : -t);
+}
+
+}  // namespace G711
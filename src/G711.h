@@ -0,0 +1,26 @@
+#ifndef G711_H
+#define G711_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ITU-T G.711 companding for the transcription uplink (g711_ulaw / g711_alaw).
+//
+// Encoders take 16-bit PCM and find the segment with a 256-entry table
+// indexed by the top magnitude bits, so a sample costs a lookup and a few
+// shifts. Decoders are only needed to check the encoders (host tests).
+// In and out may not overlap.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+namespace G711 {
+
+void encodeUlaw(const int16_t* in, uint8_t* out, size_t n);
+void encodeAlaw(const int16_t* in, uint8_t* out, size_t n);
+
+int16_t decodeUlaw(uint8_t code);
+int16_t decodeAlaw(uint8_t code);
+
+}  // namespace G711
+
+#endif
@@ -0,0 +1,136 @@
+#include "HistoryStore.h"
+#include <string.h>
+#include <esp_heap_caps.h>
+
+static const uint32_t CHARS_PER_TOKEN = 4;
+static const uint32_t MESSAGE_TOKENS = 4;      // "User: " / "Assistant: " and the newline
+
+static inline bool isContinuation(char c) {
+    return ((uint8_t)c & 0xC0) == 0x80;
+}
+
+HistoryStore::~HistoryStore() {
+    if (_arena) heap_caps_free(_arena);
+    if (_entries) heap_caps_free(_entries);
+}
+
+bool HistoryStore::begin(size_t arenaBytes, size_t maxMessages, uint32_t tokenBudget) {
+    if (arenaBytes == 0 || maxMessages < 2 || tokenBudget <= 2 * MESSAGE_TOKENS) return false;
+    if (_arena) heap_caps_free(_arena);
+    if (_entries) heap_caps_free(_entries);
+
+    // Read once per request: PSRAM is fine, internal RAM as fallback
+    _arena = (char*)heap_caps_malloc(arenaBytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!_arena) _arena = (char*)heap_caps_malloc(arenaBytes, MALLOC_CAP_8BIT);
+    _entries = (Entry*)heap_caps_malloc(maxMessages * sizeof(Entry), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!_entries) _entries = (Entry*)heap_caps_malloc(maxMessages * sizeof(Entry), MALLOC_CAP_8BIT);
+    if (!_arena || !_entries) return false;
+
+    _capacity = arenaBytes;
+    _maxMessages = maxMessages;
+    _budget = tokenBudget;
+    clear();
+    return true;
+}
+
+uint32_t HistoryStore::estimateTokens(const char* text, size_t len) {
+    // Characters, not bytes: accented text isn't counted double
+    uint32_t chars = 0;
+    for (size_t i = 0; i < len; i++) {
+        if (!isContinuation(text[i])) chars++;
+    }
+    return (chars + CHARS_PER_TOKEN - 1) / CHARS_PER_TOKEN + MESSAGE_TOKENS;
+}
+
+// Longest prefix within maxBytes and maxTokens, cut on a character boundary
+size_t HistoryStore::fitLength(const char* text, size_t len, size_t maxBytes, uint32_t maxTokens) const {
+    size_t maxLen = maxBytes;
+    if (maxTokens <= MESSAGE_TOKENS) maxLen = 0;
+    else if (maxLen > (size_t)(maxTokens - MESSAGE_TOKENS) * CHARS_PER_TOKEN) {
+        maxLen = (size_t)(maxTokens - MESSAGE_TOKENS) * CHARS_PER_TOKEN;
+    }
+    if (len > maxLen) {
+        len = maxLen;
+        while (len > 0 && isContinuation(text[len])) len--;
+    }
+    return len;
+}
+
+void HistoryStore::add(HistoryRole role, const char* text, size_t len) {
+    if (!_arena) return;
+    len = fitLength(text, len, _capacity, _budget);
+    place(role, text, len, false);
+}
+
+void HistoryStore::addExchange(const char* question, size_t questionLen, const char* answer, size_t answerLen) {
+    if (!_arena) return;
+    questionLen = fitLength(question, questionLen, _capacity / 2, _budget / 2);
+    uint32_t questionTokens = estimateTokens(question, questionLen);
+    answerLen = fitLength(answer, answerLen, _capacity - questionLen, _budget - questionTokens);
+
+    // Wrap before the question if the answer wouldn't fit behind it
+    place(ROLE_USER, question, questionLen, _head + questionLen + answerLen > _capacity);
+    place(ROLE_ASSISTANT, answer, answerLen, false);
+}
+
+void HistoryStore::place(HistoryRole role, const char* text, size_t len, bool wrap) {
+    uint32_t tokens = estimateTokens(text, len);
+
+    size_t start = _head;
+    bool wrapped = wrap || start + len > _capacity;
+    if (wrapped) start = 0;
+
+    while (_count > 0) {
+        const Entry& e = oldest();
+        // Past the wrap point, or in the new message's way
+        bool inTail = wrapped && e.offset >= _head;
+        bool overlaps = e.offset < start + len && e.offset + e.len > start;
+        bool overBudget = _tokens + tokens > _budget;
+        if (!inTail && !overlaps && !overBudget && _count < _maxMessages) break;
+        evictOldest();
+    }
+
+    // An answer without its question is no use as context
+    while (_count > 0 && oldest().role == ROLE_ASSISTANT) evictOldest();
+    if (_count == 0) start = 0;
+
+    Entry& e = _entries[(_first + _count) % _maxMessages];
+    e.offset = start;
+    e.len = len;
+    e.tokens = tokens;
+    e.role = role;
+    memcpy(_arena + start, text, len);
+    _count++;
+    _tokens += tokens;
+    _head = start + len;
+}
+
+void HistoryStore::evictOldest() {
+    _tokens -= oldest().tokens;
+    _first = (_first + 1) % _maxMessages;
+    _count--;
+    _evicted++;
+}
+
+void HistoryStore::removeLast() {
+    if (_count == 0) return;
+    const Entry& e = newest();
+    _tokens -= e.tokens;
+    _head = e.offset;
+    _count--;
+}
+
+bool HistoryStore::removeLastExchange() {
+    if (_count < 2 || newest().role != ROLE_ASSISTANT) return false;
+    if (_entries[(_first + _count - 2) % _maxMessages].role != ROLE_USER) return false;
+    removeLast();
+    removeLast();
+    return true;
+}
+
+void HistoryStore::clear() {
+    _head = 0;
+    _first = 0;
+    _count = 0;
+    _tokens = 0;
+}
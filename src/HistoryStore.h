@@ -0,0 +1,83 @@
+#ifndef HISTORY_STORE_H
+#define HISTORY_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Conversation history kept under a token budget.
+//
+// Message text lives in one PSRAM arena used as a ring: a new message goes
+// after the newest one (or back at the start when it doesn't fit), and the
+// oldest messages in its way are evicted. Oldest messages also go while the
+// estimated tokens would exceed the budget or the message slots run out,
+// so the prompt stays bounded whatever the turn count. A history never
+// starts with an answer whose question was evicted.
+//
+// Nothing is allocated after begin(); messages are read back in place.
+// No Arduino dependencies, so it also builds in the native test env.
+
+enum HistoryRole : uint8_t { ROLE_USER, ROLE_ASSISTANT };
+
+class HistoryStore {
+public:
+    ~HistoryStore();
+
+    bool begin(size_t arenaBytes, size_t maxMessages, uint32_t tokenBudget);
+
+    // A message longer than the arena or the whole budget is cut to fit
+    void add(HistoryRole role, const char* text, size_t len);
+
+    // Question and answer, cut so the pair fits together: the question to
+    // half the arena and budget, the answer to what it leaves. Both are
+    // always stored, so an answer never evicts its own question.
+    void addExchange(const char* question, size_t questionLen, const char* answer, size_t answerLen);
+
+    // Takes the newest message back out (messages it evicted stay gone)
+    void removeLast();
+    // Same for the newest question and answer; false if the history doesn't end with one
+    bool removeLastExchange();
+    void clear();
+
+    size_t size() const { return _count; }
+    uint32_t tokens() const { return _tokens; }
+    uint32_t evicted() const { return _evicted; }
+
+    // fn(HistoryRole role, const char* text, size_t len), oldest first
+    template <class Fn>
+    void forEach(Fn fn) const {
+        for (size_t i = 0; i < _count; i++) {
+            const Entry& e = _entries[(_first + i) % _maxMessages];
+            fn((HistoryRole)e.role, _arena + e.offset, (size_t)e.len);
+        }
+    }
+
+    // About 4 characters per token, plus a few for the role prefix
+    static uint32_t estimateTokens(const char* text, size_t len);
+
+private:
+    struct Entry {
+        uint32_t offset;
+        uint32_t len;
+        uint16_t tokens;
+        uint8_t role;
+    };
+
+    char* _arena = nullptr;
+    Entry* _entries = nullptr;
+    size_t _capacity = 0;
+    size_t _maxMessages = 0;
+    uint32_t _budget = 0;
+    size_t _head = 0;           // Where the next message goes
+    size_t _first = 0;          // Oldest entry
+    size_t _count = 0;
+    uint32_t _tokens = 0;
+    uint32_t _evicted = 0;
+
+    const Entry& oldest() const { return _entries[_first]; }
+    const Entry& newest() const { return _entries[(_first + _count - 1) % _maxMessages]; }
+    size_t fitLength(const char* text, size_t len, size_t maxBytes, uint32_t maxTokens) const;
+    void place(HistoryRole role, const char* text, size_t len, bool wrap);
+    void evictOldest();
+};
+
+#endif
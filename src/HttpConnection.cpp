@@ -0,0 +1,73 @@
+#include "HttpConnection.h"
+
+HttpConnection::HttpConnection(const char* host, uint16_t port) : _host(host), _port(port) {
+    _lock = xSemaphoreCreateMutex();
+}
+
+HttpConnection::~HttpConnection() {
+    _client.stop();
+    if (_lock) vSemaphoreDelete(_lock);
+}
+
+bool HttpConnection::acquire() {
+    xSemaphoreTake(_lock, portMAX_DELAY);
+
+    if (isFresh()) {
+        _reused = true;
+        _stats.reuses++;
+        return true;
+    }
+
+    _reused = false;
+    if (!open()) {
+        xSemaphoreGive(_lock);
+        return false;
+    }
+    return true;
+}
+
+void HttpConnection::release(bool reusable) {
+    if (!reusable || !HTTP_KEEPALIVE_ENABLED) _client.stop();
+    _lastUsed = millis();
+    xSemaphoreGive(_lock);
+}
+
+bool HttpConnection::reopen() {
+    _stats.staleRetries++;
+    _reused = false;
+    return open();
+}
+
+bool HttpConnection::prewarm() {
+    if (!HTTP_KEEPALIVE_ENABLED) return false;
+    if (xSemaphoreTake(_lock, 0) != pdTRUE) return false;   // A request is running
+
+    bool ok = isFresh() || open();
+    _lastUsed = millis();
+    xSemaphoreGive(_lock);
+    return ok;
+}
+
+// Open, and idle for less than the server is likely to keep it
+bool HttpConnection::isFresh() {
+    if (!HTTP_KEEPALIVE_ENABLED) return false;
+    return _client.connected() && millis() - _lastUsed < HTTP_KEEPALIVE_IDLE_MS;
+}
+
+bool HttpConnection::open() {
+    _client.stop();
+    _client.setInsecure();
+    _client.setTimeout(30000);
+
+    unsigned long start = millis();
+    if (!_client.connect(_host, _port)) {
+        _stats.failures++;
+        Serial.printf("[HTTP] Connect to %s failed\n", _host);
+        return false;
+    }
+    _lastUsed = millis();
+    _stats.handshakes++;
+    _stats.lastHandshakeMs = _lastUsed - start;
+    _stats.handshakeMs += _stats.lastHandshakeMs;
+    return true;
+}
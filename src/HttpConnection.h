@@ -0,0 +1,64 @@
+#ifndef HTTP_CONNECTION_H
+#define HTTP_CONNECTION_H
+
+#include <Arduino.h>
+#include <WiFiClientSecure.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "BoardConfig.h"
+
+// One HTTP/1.1 keep-alive TLS connection to a host.
+//
+// A client locks it for each request with acquire() and hands it back with
+// release(), saying whether the response was read to its end. The socket
+// then stays open for the next request, so only the first one (or the
+// first after the server drops it) pays for the TLS handshake. prewarm()
+// opens it ahead of time, from any task.
+
+struct ConnectionStats {
+    uint32_t handshakes;
+    uint32_t handshakeMs;       // Total time spent in handshakes
+    uint32_t lastHandshakeMs;
+    uint32_t reuses;            // Requests sent on an already open socket
+    uint32_t staleRetries;      // Reused socket turned out dead, request re-sent
+    uint32_t failures;          // Connect failed
+};
+
+class HttpConnection {
+public:
+    HttpConnection(const char* host, uint16_t port = 443);
+    ~HttpConnection();
+
+    // Locks the connection for one request, connecting if needed.
+    // On false the lock is already released.
+    bool acquire();
+
+    // Ends the request. reusable: the body was read to its end and the
+    // server didn't ask to close
+    void release(bool reusable);
+
+    // Replaces a reused socket that turned out dead (lock still held)
+    bool reopen();
+
+    // Connects ahead of a request. Skips if in use or already open.
+    bool prewarm();
+
+    WiFiClientSecure& client() { return _client; }
+    bool reused() const { return _reused; }
+    const char* host() const { return _host; }
+    const ConnectionStats& stats() const { return _stats; }
+
+private:
+    const char* _host;
+    uint16_t _port;
+    WiFiClientSecure _client;
+    SemaphoreHandle_t _lock;
+    unsigned long _lastUsed = 0;
+    bool _reused = false;
+    ConnectionStats _stats = {};
+
+    bool isFresh();
+    bool open();
+};
+
+#endif
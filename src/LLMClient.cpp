@@ -1,9 +1,28 @@
 #include "LLMClient.h"
-#include <WiFiClientSecure.h>
-#include <ArduinoJson.h>
+#include "AudioDsp.h"
+#include "RealtimeEvents.h"
 
-LLMClient::LLMClient(String apiKey) : _apiKey(apiKey) {
+LLMClient::LLMClient(String apiKey) : _apiKey(apiKey), _conn("api.openai.com"), _eventDoc(1024) {
     _systemPrompt = "You are a helpful voice assistant. Respond naturally and concisely.";
+    if (!_history.begin(LLM_HISTORY_ARENA_BYTES, LLM_HISTORY_MAX_MESSAGES, LLM_HISTORY_TOKENS)) {
+        Serial.println("[LLM] History alloc fail, no conversation memory");
+    }
+
+    // Grown once, then reused every turn
+    _response.reserve(1024);
+    _pendingUser.reserve(256);
+    _line.reserve(128);
+
+    // Only what the handled events need; the rest is skipped unparsed
+    _eventFilter["type"] = true;
+    _eventFilter["delta"] = true;
+    _eventFilter["response"]["output_text"] = true;
+
+    _decoder.setSink([this](const char* data, size_t len) {
+        if (_req == REQ_ERROR) appendError(data, len);
+        else _sse.feed(data, len);
+    });
+    _sse.setHandler([this](SseEvent& event) { handleEvent(event); });
 }
 
 void LLMClient::setSystemPrompt(String prompt) {
@@ -14,148 +33,453 @@ void LLMClient::setMaxTokens(int tokens) {
     _maxTokens = tokens;
 }
 
+void LLMClient::onTextDelta(std::function<void(const char*)> callback) {
+    _deltaCallback = callback;
+}
+
 void LLMClient::clearHistory() {
     _history.clear();
+    _chain.clear();
 }
 
-void LLMClient::trimHistory() {
-    while (_history.size() > MAX_HISTORY) {
-        _history.erase(_history.begin());
+String LLMClient::chat(String userMessage) {
+    if (!startChat(userMessage)) return "";
+    return finishChat();
+}
+
+bool LLMClient::startChat(String userMessage) {
+    if (userMessage.length() == 0) return false;
+    if (_req != REQ_IDLE) cancel();
+
+    if (!_conn.acquire()) {
+        Serial.println("[LLM] Connect fail");
+        return false;
     }
+
+    // The history itself only changes once the exchange completes
+    _pendingUser = userMessage;
+    memset(&_stream, 0, sizeof(_stream));
+    beginRequest();
+    return true;
 }
 
-String LLMClient::chat(String userMessage) {
-    if (userMessage.length() == 0) return "";
+// Sends the request for _pendingUser on the acquired connection
+void LLMClient::beginRequest() {
+    _chain.beginRequest();
+    sendRequest();
 
-    _history.push_back({"user", userMessage});
-    trimHistory();
+    _line = "";
+    _response = "";
+    _started = millis();
+    _lastData = _started;
+    _gotData = false;
+    _chunked = false;
+    _keepAlive = true;
+    _errorStatus = 0;
+    _contentLength = -1;
+    _bodyRead = 0;
+    _errorLen = 0;
+    _decoder.reset();
+    _sse.reset();
+    _req = REQ_STATUS;
+}
 
-    WiFiClientSecure client;
-    client.setInsecure();
-    client.setTimeout(30000);
+// Request bytes are staged and written in blocks, one TLS record each
+// instead of one per header line or message. With no client it only counts.
+class RequestWriter {
+public:
+    RequestWriter(WiFiClientSecure* client) : _client(client) {}
 
-    if (!client.connect("api.openai.com", 443)) {
-        Serial.println("[LLM] Connect fail");
-        return "";
-    }
-
-    // Build request for Responses API
-    DynamicJsonDocument doc(4096);
-    doc["model"] = "gpt-4.1-nano";
-    doc["max_output_tokens"] = _maxTokens;
-    doc["stream"] = true;
-    doc["store"] = false;
-
-    // Build input
-    String input = _systemPrompt + "\n\n";
-    for (const auto& msg : _history) {
-        input += (msg.role == "user" ? "User: " : "Assistant: ") + msg.content + "\n";
-    }
-    doc["input"] = input;
-
-    String body;
-    serializeJson(doc, body);
-
-    // Send request
-    client.println("POST /v1/responses HTTP/1.1");
-    client.println("Host: api.openai.com");
-    client.println("Authorization: Bearer " + _apiKey);
-    client.println("Content-Type: application/json");
-    client.println("Accept: text/event-stream");
-    client.println("Content-Length: " + String(body.length()));
-    client.println("Connection: close");
-    client.println();
-    client.print(body);
-
-    // Wait for response
-    unsigned long timeout = millis() + 10000;
-    while (client.connected() && !client.available()) {
-        if (millis() > timeout) {
-            client.stop();
-            return "";
+    void write(const char* s, size_t n) {
+        _bytes += n;
+        if (!_client) return;
+        while (n > 0) {
+            size_t take = BLOCK - _fill;
+            if (take > n) take = n;
+            memcpy(_buf + _fill, s, take);
+            _fill += take;
+            s += take;
+            n -= take;
+            if (_fill == BLOCK) flush();
         }
-        delay(10);
     }
 
-    // Check status
-    String status = client.readStringUntil('\n');
-    if (status.indexOf("200") < 0) {
-        while (client.available()) client.read();
-        client.stop();
-        return "";
+    void write(const char* s) { write(s, strlen(s)); }
+
+    // Contents of a JSON string
+    void writeEscaped(const char* s, size_t n) {
+        size_t run = 0;
+        for (size_t i = 0; i < n; i++) {
+            char c = s[i];
+            if (c != '"' && c != '\\' && (uint8_t)c >= 0x20) continue;
+            write(s + run, i - run);
+            run = i + 1;
+            char esc[8];
+            if (c == '"') write("\\\"", 2);
+            else if (c == '\\') write("\\\\", 2);
+            else if (c == '\n') write("\\n", 2);
+            else if (c == '\r') write("\\r", 2);
+            else if (c == '\t') write("\\t", 2);
+            else {
+                snprintf(esc, sizeof(esc), "\\u%04x", (uint8_t)c);
+                write(esc, 6);
+            }
+        }
+        write(s + run, n - run);
+    }
+
+    void flush() {
+        if (_client && _fill) _client->write((const uint8_t*)_buf, _fill);
+        _fill = 0;
     }
 
-    // Skip headers
-    while (client.connected()) {
-        String h = client.readStringUntil('\n');
-        h.trim();
-        if (h.length() == 0) break;
+    size_t bytes() const { return _bytes; }
+
+private:
+    static const size_t BLOCK = 1024;
+    WiFiClientSecure* _client;
+    char _buf[BLOCK];
+    size_t _fill = 0;
+    size_t _bytes = 0;
+};
+
+void LLMClient::sendRequest() {
+    _chained = LLM_SERVER_STATE && _chain.active();
+
+    // Measure the body first, so it can be streamed straight from the history
+    RequestWriter counter(NULL);
+    writeBody(counter);
+    char length[12];
+    snprintf(length, sizeof(length), "%u", (unsigned)counter.bytes());
+
+    RequestWriter out(&_conn.client());
+    out.write("POST /v1/responses HTTP/1.1\r\n"
+              "Host: api.openai.com\r\n"
+              "Authorization: Bearer ");
+    out.write(_apiKey.c_str(), _apiKey.length());
+    out.write("\r\nContent-Type: application/json\r\n"
+              "Accept: text/event-stream\r\n"
+              "Content-Length: ");
+    out.write(length);
+    out.write(HTTP_KEEPALIVE_ENABLED ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+    writeBody(out);
+    out.flush();
+
+    _uploaded += out.bytes();
+    _stream.requestBytes += out.bytes();
+    _stream.chained = _chained;
+    _stream.historyTokens = _chained ? 0 : _history.tokens();
+    _stream.historyMessages = _chained ? 0 : _history.size();
+}
+
+// Responses API request. Local history: system prompt, the stored history
+// and this message as one input text. Server state: the prompt goes as
+// instructions (not carried over by the chain) and, once there is a stored
+// response to continue, only the new message is sent.
+void LLMClient::writeBody(RequestWriter& out) {
+    char number[12];
+    out.write("{\"model\":\"gpt-4.1-nano\",\"max_output_tokens\":");
+    snprintf(number, sizeof(number), "%d", _maxTokens);
+    out.write(number);
+#if LLM_SERVER_STATE
+    out.write(",\"stream\":true,\"store\":true,\"truncation\":\"auto\",\"instructions\":\"");
+    out.writeEscaped(_systemPrompt.c_str(), _systemPrompt.length());
+    if (_chained) {
+        out.write("\",\"previous_response_id\":\"");
+        out.write(_chain.id());
+        out.write("\",\"input\":\"");
+        out.writeEscaped(_pendingUser.c_str(), _pendingUser.length());
+        out.write("\"}");
+        return;
     }
+    out.write("\",\"input\":\"");
+#else
+    out.write(",\"stream\":true,\"store\":false,\"input\":\"");
+    out.writeEscaped(_systemPrompt.c_str(), _systemPrompt.length());
+    out.write("\\n\\n");
+#endif
+    _history.forEach([&](HistoryRole role, const char* text, size_t len) {
+        out.write(role == ROLE_USER ? "User: " : "Assistant: ");
+        out.writeEscaped(text, len);
+        out.write("\\n");
+    });
+    out.write("User: ");
+    out.writeEscaped(_pendingUser.c_str(), _pendingUser.length());
+    out.write("\\n\"}");
+}
 
-    // Read SSE stream
-    String response = "";
-    String line = "";
-    unsigned long lastData = millis();
+bool LLMClient::poll() {
+    if (_req == REQ_IDLE || _req == REQ_DONE) return false;
 
-    while (client.connected() || client.available()) {
-        if (client.available()) {
-            char c = client.read();
-            lastData = millis();
+    WiFiClientSecure& client = _conn.client();
+    uint8_t buf[512];
+    while (_req != REQ_DONE && _req != REQ_RESEND && client.available()) {
+        int n = client.read(buf, sizeof(buf));
+        if (n <= 0) break;
+        _lastData = millis();
+        _gotData = true;
 
+        // Status line and headers, then the rest of the read is body
+        const char* p = (const char*)buf;
+        size_t len = n;
+        while (len > 0 && (_req == REQ_STATUS || _req == REQ_HEADERS)) {
+            char c = *p++;
+            len--;
             if (c == '\n') {
-                line.trim();
-                if (line.length() > 0) {
-                    // Skip hex chunk sizes
-                    bool isHex = true;
-                    for (unsigned int i = 0; i < line.length() && isHex; i++) {
-                        if (!isxdigit(line.charAt(i))) isHex = false;
-                    }
-
-                    if (!isHex && line.startsWith("data: ")) {
-                        String json = line.substring(6);
-                        if (json == "[DONE]") break;
-
-                        DynamicJsonDocument ev(4096);
-                        if (!deserializeJson(ev, json)) {
-                            const char* type = ev["type"];
-                            if (type) {
-                                if (strcmp(type, "response.output_text.delta") == 0 ||
-                                    strcmp(type, "response.text.delta") == 0) {
-                                    response += ev["delta"].as<String>();
-                                }
-                                else if (strcmp(type, "response.content_part.delta") == 0) {
-                                    if (ev["delta"].containsKey("text")) {
-                                        response += ev["delta"]["text"].as<String>();
-                                    }
-                                }
-                                else if (strcmp(type, "response.completed") == 0 ||
-                                         strcmp(type, "response.done") == 0) {
-                                    if (ev.containsKey("response") && ev["response"].containsKey("output_text")) {
-                                        response = ev["response"]["output_text"].as<String>();
-                                    }
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-                line = "";
+                handleHeaderLine();
+                _line = "";
             } else if (c != '\r') {
-                line += c;
+                _line += c;
+            }
+        }
+        if (len > 0 && (_req == REQ_BODY || _req == REQ_TAIL || _req == REQ_ERROR)) handleBody(p, len);
+    }
+    if (_req == REQ_DONE) return false;
+
+    if (_req == REQ_RESEND) {
+        // Chain lost: same message again with the local history
+        _conn.release(false);
+        if (!_conn.acquire()) {
+            Serial.println("[LLM] Connect fail");
+            _pendingUser = "";
+            _req = REQ_DONE;
+            return false;
+        }
+        beginRequest();
+        return true;
+    }
+
+    if (!client.connected()) {
+        if (_req == REQ_STATUS && !_gotData && _conn.reused()) {
+            // The server closed the idle socket: one retry on a fresh one
+            Serial.println("[LLM] Kept-alive connection was closed, reconnecting");
+            if (_conn.reopen()) {
+                sendRequest();
+                _started = millis();
+                return true;
             }
+        }
+        if (_req == REQ_ERROR) {
+            endError();
+            return _req == REQ_RESEND;
+        }
+        finish(_req == REQ_BODY || _req == REQ_TAIL);
+        return false;
+    }
+
+    // Wait up to 10 s for the response, then 15 s between stream chunks
+    if (_req == REQ_STATUS && millis() - _started > 10000) {
+        finish(false);
+        return false;
+    }
+    if (_req == REQ_BODY && millis() - _lastData > 15000) {
+        finish(true);
+        return false;
+    }
+    // The end of the body follows the last event (or the error) right away
+    if (_req == REQ_ERROR && millis() - _lastData > 1000) {
+        endError();
+        return _req == REQ_RESEND;
+    }
+    if (_req == REQ_TAIL && millis() - _lastData > 1000) {
+        finish(true);
+        return false;
+    }
+    return true;
+}
+
+void LLMClient::handleHeaderLine() {
+    if (_req == REQ_STATUS) {
+        int space = _line.indexOf(' ');
+        int status = space > 0 ? _line.substring(space + 1).toInt() : 0;
+        if (status == 200) {
+            _req = REQ_HEADERS;
+        } else if (_chained && (status == 400 || status == 404)) {
+            // Maybe the stored response is gone: the error body tells
+            _errorStatus = status;
+            _req = REQ_HEADERS;
         } else {
-            if (millis() - lastData > 15000) break;
-            delay(1);
+            finish(false);
         }
-        yield();
+        return;
+    }
+
+    _line.trim();
+    if (_line.length() == 0) {
+        _req = _errorStatus ? REQ_ERROR : REQ_BODY;
+        if (_req == REQ_ERROR && _contentLength == 0) endError();
+        return;
+    }
+    _line.toLowerCase();
+    if (_line.startsWith("content-length:")) _contentLength = _line.substring(15).toInt();
+    if (_line.startsWith("transfer-encoding:") && _line.indexOf("chunked") >= 0) _chunked = true;
+    if (_line.startsWith("connection:") && _line.indexOf("close") >= 0) _keepAlive = false;
+}
+
+void LLMClient::handleBody(const char* data, size_t len) {
+    uint32_t start = AudioDsp::cycleCount();
+    _stream.bodyBytes += len;
+    _bodyRead += len;
+    if (_chunked) _decoder.feed(data, len);
+    else if (_req == REQ_ERROR) appendError(data, len);
+    else _sse.feed(data, len);
+    _stream.cycles += AudioDsp::cycleCount() - start;
+
+    if (_req == REQ_ERROR) {
+        bool ended = _chunked ? _decoder.done() || _decoder.failed()
+                              : _contentLength >= 0 && _bodyRead >= (size_t)_contentLength;
+        if (ended || _errorLen == sizeof(_errorBody)) endError();
+        return;
+    }
+    if (_req == REQ_DONE) return;
+    if (_decoder.done()) {
+        finish(true, _keepAlive);
+    } else if (_decoder.failed()) {
+        Serial.println("[LLM] Malformed chunked body");
+        finish(true);
+    }
+}
+
+enum EventKind { EV_UNKNOWN, EV_OTHER, EV_CREATED, EV_TEXT_DELTA, EV_PART_DELTA, EV_COMPLETED };
+
+static EventKind eventKind(const char* name, size_t len) {
+    struct Kind { const char* name; EventKind kind; };
+    static const Kind KINDS[] = {
+        {"response.created", EV_CREATED},
+        {"response.output_text.delta", EV_TEXT_DELTA},
+        {"response.text.delta", EV_TEXT_DELTA},
+        {"response.content_part.delta", EV_PART_DELTA},
+        {"response.completed", EV_COMPLETED},
+        {"response.done", EV_COMPLETED},
+    };
+    for (const Kind& k : KINDS) {
+        if (strlen(k.name) == len && memcmp(k.name, name, len) == 0) return k.kind;
     }
+    return EV_OTHER;
+}
 
-    client.stop();
+// Kept up to ERROR_BODY_MAX: the error code sits near the start
+void LLMClient::appendError(const char* data, size_t len) {
+    size_t take = sizeof(_errorBody) - _errorLen;
+    if (take > len) take = len;
+    memcpy(_errorBody + _errorLen, data, take);
+    _errorLen += take;
+}
 
-    if (response.length() > 0) {
-        _history.push_back({"assistant", response});
-        trimHistory();
+// Whole error body in (or as much as is kept): resend only if the chain is gone
+void LLMClient::endError() {
+    if (_chain.onRejected(_errorStatus, _errorBody, _errorLen)) {
+        Serial.printf("[LLM] Chain lost (HTTP %d), resending with local history\n", _errorStatus);
+        _stream.chainLost = true;
+        _req = REQ_RESEND;
+        return;
     }
+    Serial.printf("[LLM] HTTP %d: %.*s\n", _errorStatus, (int)_errorLen, _errorBody);
+    finish(false);
+}
+
+void LLMClient::handleEvent(SseEvent& event) {
+    if (_req != REQ_BODY) return;
+    _stream.events++;
 
+    if (event.dataLen == 6 && memcmp(event.data, "[DONE]", 6) == 0) {
+        complete();
+        return;
+    }
+
+    // Type from the "event:" field, else from the start of the data
+    const char* name = event.name;
+    size_t nameLen = strlen(name);
+    EventKind kind = EV_UNKNOWN;
+    if (nameLen > 0 || RealtimeEvents::findType(event.data, event.dataLen, &name, &nameLen)) {
+        kind = eventKind(name, nameLen);
+    }
+    if (kind == EV_CREATED) {
+        // The id of the stored response, for the next request to chain on
+        if (LLM_SERVER_STATE) _chain.onCreated(event.data, event.dataLen);
+        _stream.skipped++;
+        return;
+    }
+    if (kind == EV_OTHER || (kind == EV_COMPLETED && _response.length() > 0)) {
+        // Deltas already hold the whole text
+        _stream.skipped++;
+        if (kind == EV_COMPLETED) complete();
+        return;
+    }
+
+    // Cut off: only its type was usable
+    bool ok = !event.truncated &&
+              !deserializeJson(_eventDoc, event.data, event.dataLen, DeserializationOption::Filter(_eventFilter));
+    if (!ok) {
+        _stream.parseErrors++;
+        if (kind == EV_COMPLETED) complete();
+        return;
+    }
+    _stream.parsed++;
+
+    if (kind == EV_UNKNOWN) {
+        const char* type = _eventDoc["type"];
+        if (!type) return;
+        kind = eventKind(type, strlen(type));
+    }
+
+    if (kind == EV_TEXT_DELTA) {
+        appendDelta(_eventDoc["delta"] | "");
+    } else if (kind == EV_PART_DELTA) {
+        appendDelta(_eventDoc["delta"]["text"] | "");
+    } else if (kind == EV_COMPLETED) {
+        if (_response.length() == 0) _response = _eventDoc["response"]["output_text"] | "";
+        complete();
+    }
+}
+
+// Last event received: read to the end of a chunked body to keep the socket
+void LLMClient::complete() {
+    if (_chunked && _keepAlive) _req = REQ_TAIL;
+    else finish(true);
+}
+
+void LLMClient::appendDelta(const char* text) {
+    if (!text[0]) return;
+    _response += text;
+    if (_deltaCallback) _deltaCallback(text);
+}
+
+void LLMClient::finish(bool ok, bool reusable) {
+    _conn.release(reusable);
+    _req = REQ_DONE;
+    if (!ok) _response = "";
+
+    if (_response.length() > 0) {
+        // Local history is kept either way: it is the fallback if the chain breaks
+        _history.addExchange(_pendingUser.c_str(), _pendingUser.length(), _response.c_str(), _response.length());
+#if LLM_SERVER_STATE
+        _chain.commit();
+#endif
+    }
+    _pendingUser = "";
+}
+
+String LLMClient::finishChat() {
+    while (poll()) {
+        delay(1);
+        yield();
+    }
+    String response = _response;
+    _response = "";
+    _req = REQ_IDLE;
     return response;
 }
+
+void LLMClient::cancel() {
+    if (_req == REQ_IDLE) return;
+    if (_req != REQ_DONE) _conn.release(false);
+    else if (_response.length() > 0) {
+        // Already completed: take the exchange back out of the history
+        _history.removeLastExchange();
+        _chain.rollback();
+    }
+    _pendingUser = "";
+    _response = "";
+    _req = REQ_IDLE;
+}
@@ -2,16 +2,33 @@
 #define LLM_CLIENT_H
 
 #include <Arduino.h>
-#include <vector>
+#include <ArduinoJson.h>
+#include "HttpConnection.h"
+#include "ChunkedDecoder.h"
+#include "SseParser.h"
+#include "HistoryStore.h"
+#include "ResponseChain.h"
 
 // OpenAI Chat Completions API
 // Model: gpt-5-nano
 
-struct ChatMessage {
-    String role;    // "system", "user", "assistant"
-    String content;
+// Request and response stream of the last request
+struct StreamStats {
+    uint32_t requestBytes;      // Retries included
+    uint32_t historyTokens;     // Estimated, history part of the prompt
+    uint32_t historyMessages;
+    bool chained;               // Sent as previous_response_id, no history
+    bool chainLost;             // Server rejected the chain, re-sent with history
+    uint32_t bodyBytes;
+    uint32_t events;
+    uint32_t skipped;           // Not a delta or the end: never parsed
+    uint32_t parsed;
+    uint32_t parseErrors;
+    uint32_t cycles;            // CPU spent decoding and parsing the body
 };
 
+class RequestWriter;
+
 class LLMClient {
 public:
     LLMClient(String apiKey);
@@ -23,20 +40,85 @@ public:
     // Returns empty string on error
     String chat(String userMessage);
 
-    // Clear conversation history (keeps system prompt)
+    // Non-blocking variant: startChat() connects and sends the request,
+    // poll() reads whatever has arrived (call it from loop()), finishChat()
+    // waits for the rest. cancel() drops the request. Only a completed
+    // exchange is added to the history.
+    bool startChat(String userMessage);
+    bool poll();                // True while the request is still running
+    bool isBusy() const { return _req != REQ_IDLE; }
+    String finishChat();
+    void cancel();
+
+    // Text received so far for the current request
+    const String& responseSoFar() const { return _response; }
+
+    // Each text delta as it streams in (from poll(), so also during chat())
+    void onTextDelta(std::function<void(const char*)> callback);
+
+    // Open the connection ahead of the next request
+    bool prewarm() { return _conn.prewarm(); }
+    const ConnectionStats& connectionStats() const { return _conn.stats(); }
+    const StreamStats& streamStats() const { return _stream; }
+    uint32_t uploadedBytes() const { return _uploaded; }     // All requests so far
+
+    // Clear conversation history (keeps system prompt, restarts the chain)
     void clearHistory();
 
     // Set max tokens for response
     void setMaxTokens(int tokens);
 
 private:
+    // REQ_TAIL: answer complete, reading the rest of the body so the
+    // connection can be reused. REQ_ERROR: reading the error body of a
+    // chained request. REQ_RESEND: chain lost, send again with the local
+    // history.
+    enum RequestState { REQ_IDLE, REQ_STATUS, REQ_HEADERS, REQ_BODY, REQ_TAIL, REQ_ERROR, REQ_RESEND, REQ_DONE };
+    static const size_t ERROR_BODY_MAX = 512;
+
     String _apiKey;
     String _systemPrompt;
-    std::vector<ChatMessage> _history;
+    HistoryStore _history;
     int _maxTokens = 150;
-    static const int MAX_HISTORY = 10;  // Keep last N messages
 
-    void trimHistory();
+    HttpConnection _conn;
+    RequestState _req = REQ_IDLE;
+    String _pendingUser;
+    bool _gotData = false;
+    bool _chunked = false;
+    bool _keepAlive = true;     // No "Connection: close" from the server
+    String _line;               // Status and header lines only
+    ChunkedDecoder _decoder;
+    SseParser _sse;
+    DynamicJsonDocument _eventDoc;
+    StaticJsonDocument<96> _eventFilter;
+    StreamStats _stream = {};
+    uint32_t _uploaded = 0;
+
+    // LLM_SERVER_STATE: the stored response the next request continues
+    ResponseChain _chain;
+    bool _chained = false;      // Current request continues _chain.id()
+    int _errorStatus = 0;       // Non-200 status of a chained request
+    long _contentLength = -1;   // -1: not given
+    size_t _bodyRead = 0;       // Raw body bytes of this response
+    char _errorBody[ERROR_BODY_MAX];
+    size_t _errorLen = 0;
+    String _response;
+    unsigned long _started = 0;
+    unsigned long _lastData = 0;
+    std::function<void(const char*)> _deltaCallback;
+
+    void beginRequest();
+    void sendRequest();
+    void writeBody(RequestWriter& out);
+    void handleHeaderLine();
+    void handleBody(const char* data, size_t len);
+    void handleEvent(SseEvent& event);
+    void appendError(const char* data, size_t len);
+    void endError();
+    void complete();
+    void appendDelta(const char* text);
+    void finish(bool ok, bool reusable = false);
 };
 
 #endif
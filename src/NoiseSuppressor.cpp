@@ -0,0 +1,183 @@
+#include "NoiseSuppressor.h"
+#include "AudioDsp.h"
+#include <math.h>
+#include <string.h>
+
+static const int INPUT_SHIFT = 6;           // Headroom/precision trade for the FFT
+static const int16_t MIN_BIAS = 330;        // Q8 log2: minimum of smoothed power vs its mean
+static const int16_t OVER_SUBTRACT = 512;   // Q8 log2: treat noise as 6 dB louder
+static const int16_t LOG_EMPTY = 0x7FFF;
+static const uint16_t RELEASE = 27853;      // Q15, 0.85 per frame (~1.4 dB)
+static const uint32_t UNITY = 32768;
+
+// log2(1 + f) - f at the middle of each sixteenth of the mantissa, Q8
+static const uint8_t LOG2_CORRECTION[16] = {
+    3, 9, 14, 17, 20, 21, 22, 22, 21, 20, 18, 16, 13, 10, 6, 2,
+};
+
+// log2(v) in Q8, within ~0.02; log2(0) is taken as 0
+static inline int16_t log2Q8(uint64_t v) {
+    if (v == 0) return 0;
+    int msb = 63 - __builtin_clzll(v);
+    uint32_t frac = msb >= 8 ? (uint32_t)(v >> (msb - 8)) & 0xFF
+                             : (uint32_t)(v << (8 - msb)) & 0xFF;
+    return (int16_t)((msb << 8) + frac + LOG2_CORRECTION[frac >> 4]);
+}
+
+bool NoiseSuppressor::begin(uint32_t sampleRate) {
+    (void)sampleRate;
+    if (!_fft.begin(NS_FFT)) return false;
+
+    // Periodic sqrt-Hann: squared, the shifted copies sum to exactly one
+    for (size_t i = 0; i < NS_FFT; i++) {
+        double w = sin(M_PI * i / NS_FFT);
+        _window[i] = (int16_t)lround(w * 32767.0);
+    }
+    buildGainTable();
+    reset();
+    _ready = true;
+    return true;
+}
+
+void NoiseSuppressor::buildGainTable() {
+    double floorGain = pow(10.0, -_maxAttenuationDb / 20.0);
+
+    // Index i is a posterior SNR of 2^((i - 64) / 16)
+    for (size_t i = 0; i < 256; i++) {
+        double snr = pow(2.0, ((double)i - 64.0) / 16.0);
+        double prior = snr > 1.0 ? snr - 1.0 : 0.0;
+        double g = prior / (1.0 + prior);
+        if (g < floorGain) g = floorGain;
+        _gainTable[i] = (uint16_t)lround(g * UNITY);
+    }
+}
+
+void NoiseSuppressor::setMaxAttenuationDb(float db) {
+    _maxAttenuationDb = db < 0 ? 0 : db;
+    buildGainTable();
+}
+
+void NoiseSuppressor::setNoiseFloorRms(float rms) {
+    // White noise of that RMS through the analysis window and the /4 of
+    // the scaled forward transform: E|X|^2 = rms^2 * NS_HOP / 16. The
+    // tracker works on mean log power, which sits log2(e) * 0.577 lower.
+    double power = (double)rms * rms * NS_HOP / 16.0;
+    int16_t seed = (int16_t)lround((log2(power + 1.0) - 0.833) * 256.0);
+    for (size_t k = 0; k < NS_BINS; k++) _noise[k] = seed;
+    seedNoise(_noise);
+}
+
+void NoiseSuppressor::reset() {
+    memset(_input, 0, sizeof(_input));
+    memset(_overlap, 0, sizeof(_overlap));
+    memset(_snr, 0, sizeof(_snr));
+    for (size_t k = 0; k < NS_BINS; k++) _gain[k] = UNITY;
+    _noiseKnown = false;
+    _gainSum = (uint32_t)UNITY * NS_BINS;
+}
+
+float NoiseSuppressor::lastGainDb() const {
+    float mean = (float)_gainSum / NS_BINS / UNITY;
+    return 20.0f * log10f(mean + 1e-6f);
+}
+
+// Start the minimum tracker from a known noise level
+void NoiseSuppressor::seedNoise(const int16_t* noiseLog) {
+    for (size_t k = 0; k < NS_BINS; k++) {
+        int16_t l = noiseLog[k] - MIN_BIAS;
+        _smoothed[k] = l;
+        _curMin[k] = l;
+        _noise[k] = noiseLog[k];
+        for (size_t s = 0; s < NS_SUBWINDOWS; s++) _subMin[s][k] = LOG_EMPTY;
+    }
+    _subFrame = 0;
+    _subIndex = 0;
+    _noiseKnown = true;
+}
+
+void NoiseSuppressor::trackNoise() {
+    bool rotate = ++_subFrame >= NS_SUBWINDOW_FRAMES;
+
+    for (size_t k = 0; k < NS_BINS; k++) {
+        int16_t s = _smoothed[k] + ((_logPower[k] - _smoothed[k]) >> 2);
+        _smoothed[k] = s;
+        if (s < _curMin[k]) _curMin[k] = s;
+
+        int16_t m = _curMin[k];
+        for (size_t w = 0; w < NS_SUBWINDOWS; w++) {
+            if (_subMin[w][k] < m) m = _subMin[w][k];
+        }
+        _noise[k] = m + MIN_BIAS;
+
+        if (rotate) {
+            _subMin[_subIndex][k] = _curMin[k];
+            _curMin[k] = s;
+        }
+    }
+
+    if (rotate) {
+        _subFrame = 0;
+        _subIndex = (_subIndex + 1) % NS_SUBWINDOWS;
+    }
+}
+
+void NoiseSuppressor::process(int16_t* pcm, size_t n) {
+    if (!_ready || n != NS_HOP) return;
+    uint32_t start = AudioDsp::cycleCount();
+
+    // Analysis frame: previous hop + this hop, windowed
+    const int analysisShift = 15 - INPUT_SHIFT;
+    const int32_t analysisRound = 1 << (analysisShift - 1);
+    for (size_t i = 0; i < NS_HOP; i++) {
+        _time[i] = ((int32_t)_input[i] * _window[i] + analysisRound) >> analysisShift;
+        _time[NS_HOP + i] = ((int32_t)pcm[i] * _window[NS_HOP + i] + analysisRound) >> analysisShift;
+    }
+    memcpy(_input, pcm, sizeof(_input));
+    _fft.forward(_time, _spec);
+
+    for (size_t k = 0; k < NS_BINS; k++) {
+        int64_t re = _spec[2 * k], im = _spec[2 * k + 1];
+        _logPower[k] = log2Q8((uint64_t)(re * re + im * im));
+    }
+
+    // Nothing seeded: the first frame is the best guess at the noise
+    if (!_noiseKnown) seedNoise(_logPower);
+    trackNoise();
+
+    uint32_t gainSum = 0;
+    for (size_t k = 0; k < NS_BINS; k++) {
+        int32_t post = (int32_t)_logPower[k] - _noise[k] - OVER_SUBTRACT;
+        _snr[k] += (int16_t)((post - _snr[k]) >> 2);
+
+        int32_t idx = (_snr[k] >> 4) + 64;
+        if (idx < 0) idx = 0;
+        if (idx > 255) idx = 255;
+        uint32_t g = _gainTable[idx];
+
+        // Rise at once, fall gradually
+        uint32_t held = ((uint32_t)_gain[k] * RELEASE) >> 15;
+        if (g < held) g = held;
+        _gain[k] = (uint16_t)g;
+        gainSum += g;
+
+        _spec[2 * k] = (int32_t)(((int64_t)_spec[2 * k] * g + 16384) >> 15);
+        _spec[2 * k + 1] = (int32_t)(((int64_t)_spec[2 * k + 1] * g + 16384) >> 15);
+    }
+    _gainSum = gainSum;
+
+    _fft.inverse(_spec, _time);
+
+    // Synthesis window and overlap-add
+    // Keep two extra bits through the overlap-add, round once at the end
+    const int synthShift = 13 + INPUT_SHIFT;
+    const int64_t synthRound = 1 << (synthShift - 1);
+    for (size_t i = 0; i < NS_HOP; i++) {
+        int32_t head = (int32_t)(((int64_t)_time[i] * _window[i] + synthRound) >> synthShift);
+        pcm[i] = AudioDsp::saturate16((_overlap[i] + head + 2) >> 2);
+        _overlap[i] = (int32_t)(((int64_t)_time[NS_HOP + i] * _window[NS_HOP + i] + synthRound) >> synthShift);
+    }
+
+    _frames++;
+    _lastCycles = AudioDsp::cycleCount() - start;
+    if (_lastCycles > _maxCycles) _maxCycles = _lastCycles;
+}
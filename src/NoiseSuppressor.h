@@ -0,0 +1,89 @@
+#ifndef NOISE_SUPPRESSOR_H
+#define NOISE_SUPPRESSOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "AudioFft.h"
+
+// Stationary noise suppressor for the uplink, fixed point throughout.
+//
+// STFT with NS_FFT-point frames at 50% overlap (hop NS_HOP, sqrt-Hann
+// analysis and synthesis windows, so unity gain when nothing is removed).
+// Per bin it keeps log2 power in Q8:
+//   - noise by minimum statistics: the minimum of the smoothed power over
+//     NS_SUBWINDOWS x NS_SUBWINDOW_FRAMES frames (~1.4 s at 24 kHz), plus a
+//     fixed bias for the minimum underestimating the mean
+//   - a time-smoothed posterior SNR, turned into a Wiener gain by table
+//     lookup, floored at the maximum attenuation
+// Gains fall at most ~1.4 dB per frame so speech tails are not chopped.
+//
+// Adds NS_HOP samples of latency. No Arduino dependencies, so it also
+// builds in the native test env.
+
+static const size_t NS_HOP = 256;
+static const size_t NS_FFT = 2 * NS_HOP;
+static const size_t NS_BINS = NS_HOP + 1;
+static const size_t NS_SUBWINDOWS = 8;
+static const size_t NS_SUBWINDOW_FRAMES = 16;
+
+class NoiseSuppressor {
+public:
+    bool begin(uint32_t sampleRate);
+    bool isReady() const { return _ready; }
+
+    // Denoise in place. n must be NS_HOP; other sizes pass through.
+    void process(int16_t* pcm, size_t n);
+
+    // Gain floor (default 15 dB); 0 makes the stage a pure delay
+    void setMaxAttenuationDb(float db);
+
+    // Seed the noise estimate (e.g. from calibration) instead of learning
+    // it from the first frame
+    void setNoiseFloorRms(float rms);
+
+    // Forget the noise estimate and signal history
+    void reset();
+
+    // Mean gain of the last frame in dB (<= 0)
+    float lastGainDb() const;
+
+    uint32_t lastFrameCycles() const { return _lastCycles; }
+    uint32_t maxFrameCycles() const { return _maxCycles; }
+    uint32_t framesProcessed() const { return _frames; }
+
+private:
+    RealFftFixed _fft;
+    bool _ready = false;
+
+    int16_t _window[NS_FFT];            // sqrt-Hann, Q15
+    uint16_t _gainTable[256];           // Wiener gain by posterior SNR, Q15
+    float _maxAttenuationDb = 15.0f;
+
+    int16_t _input[NS_HOP];             // Previous hop
+    int32_t _overlap[NS_HOP];           // Second half of the previous synthesis
+    int32_t _time[NS_FFT];
+    int32_t _spec[NS_FFT + 2];
+
+    // Log2 power, Q8
+    int16_t _logPower[NS_BINS];
+    int16_t _smoothed[NS_BINS];
+    int16_t _snr[NS_BINS];
+    int16_t _noise[NS_BINS];
+    int16_t _curMin[NS_BINS];
+    int16_t _subMin[NS_SUBWINDOWS][NS_BINS];
+    uint16_t _gain[NS_BINS];            // Q15
+    size_t _subFrame = 0;
+    size_t _subIndex = 0;
+    bool _noiseKnown = false;
+
+    uint32_t _gainSum = 0;
+    uint32_t _frames = 0;
+    uint32_t _lastCycles = 0;
+    uint32_t _maxCycles = 0;
+
+    void buildGainTable();
+    void seedNoise(const int16_t* noiseLog);
+    void trackNoise();
+};
+
+#endif
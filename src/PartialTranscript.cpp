@@ -0,0 +1,60 @@
+#include "PartialTranscript.h"
+#include <string.h>
+
+static const size_t MIN_WORD_CHARS = 2;
+
+void PartialTranscript::reset() {
+    _text[0] = 0;
+    _len = 0;
+    _lastMs = 0;
+    _truncated = false;
+}
+
+void PartialTranscript::append(const char* delta, uint32_t nowMs) {
+    size_t n = strlen(delta);
+    if (_len + n >= PARTIAL_TRANSCRIPT_MAX) {
+        n = PARTIAL_TRANSCRIPT_MAX - 1 - _len;
+        _truncated = true;
+    }
+    memcpy(_text + _len, delta, n);
+    _len += n;
+    _text[_len] = 0;
+    _lastMs = nowMs;
+}
+
+// ASCII letters and digits compare case-insensitively; UTF-8 bytes as-is
+static inline bool isWordByte(uint8_t c) {
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+}
+
+static inline uint8_t fold(uint8_t c) {
+    return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+bool PartialTranscript::isStable(uint32_t nowMs, uint32_t quietMs) const {
+    if (_truncated || nowMs - _lastMs < quietMs) return false;
+
+    size_t wordChars = 0;
+    for (size_t i = 0; i < _len; i++) {
+        if (isWordByte((uint8_t)_text[i])) wordChars++;
+    }
+    size_t end = _len;
+    while (end > 0 && (_text[end - 1] == ' ' || _text[end - 1] == '\n')) end--;
+    if (wordChars < MIN_WORD_CHARS || end == 0) return false;
+
+    char last = _text[end - 1];
+    return last == '.' || last == '?' || last == '!';
+}
+
+bool PartialTranscript::matches(const char* a, const char* b) {
+    const uint8_t* p = (const uint8_t*)a;
+    const uint8_t* q = (const uint8_t*)b;
+    for (;;) {
+        while (*p && !isWordByte(*p)) p++;
+        while (*q && !isWordByte(*q)) q++;
+        if (!*p || !*q) return !*p && !*q;
+        if (fold(*p) != fold(*q)) return false;
+        p++;
+        q++;
+    }
+}
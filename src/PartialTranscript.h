@@ -0,0 +1,44 @@
+#ifndef PARTIAL_TRANSCRIPT_H
+#define PARTIAL_TRANSCRIPT_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Accumulates streamed transcription deltas and decides when the partial
+// text is settled enough to start the LLM on it before the final
+// transcript arrives.
+//
+// Stable means: it ends a sentence (. ? !) and no delta has arrived for a
+// quiet period. matches() then tells whether the final transcript says the
+// same thing, ignoring case, punctuation and spacing, which the final
+// pass often normalises differently.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+static const size_t PARTIAL_TRANSCRIPT_MAX = 512;
+
+class PartialTranscript {
+public:
+    PartialTranscript() { reset(); }
+
+    void reset();
+
+    // Delta received at nowMs. Text past PARTIAL_TRANSCRIPT_MAX is dropped
+    // and the transcript is never reported stable.
+    void append(const char* delta, uint32_t nowMs);
+
+    const char* text() const { return _text; }
+    size_t length() const { return _len; }
+
+    bool isStable(uint32_t nowMs, uint32_t quietMs) const;
+
+    static bool matches(const char* a, const char* b);
+
+private:
+    char _text[PARTIAL_TRANSCRIPT_MAX];
+    size_t _len;
+    uint32_t _lastMs;
+    bool _truncated;
+};
+
+#endif
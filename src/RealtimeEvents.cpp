@@ -0,0 +1,68 @@
+#include "RealtimeEvents.h"
+#include <string.h>
+
+namespace RealtimeEvents {
+
+struct Name {
+    const char* text;
+    Type type;
+};
+
+static const Name NAMES[] = {
+    {"input_audio_buffer.speech_started", SPEECH_STARTED},
+    {"input_audio_buffer.speech_stopped", SPEECH_STOPPED},
+    {"conversation.item.input_audio_transcription.delta", TRANSCRIPT_DELTA},
+    {"conversation.item.input_audio_transcription.completed", TRANSCRIPT_COMPLETED},
+    {"input_audio_buffer.transcription.completed", TRANSCRIPT_COMPLETED},
+    {"transcription.completed", TRANSCRIPT_COMPLETED},
+    {"transcription_session.updated", SESSION_UPDATED},
+    {"session.updated", SESSION_UPDATED},
+    {"error", SERVER_ERROR},
+};
+
+static const char TYPE_KEY[] = "\"type\"";
+static const size_t TYPE_KEY_LEN = sizeof(TYPE_KEY) - 1;
+
+Type fromName(const char* name, size_t len) {
+    for (const Name& n : NAMES) {
+        if (strlen(n.text) == len && memcmp(n.text, name, len) == 0) return n.type;
+    }
+    return IGNORED;
+}
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool findType(const char* json, size_t len, const char** name, size_t* nameLen) {
+    size_t end = len < TYPE_SCAN_BYTES ? len : TYPE_SCAN_BYTES;
+
+    for (size_t i = 0; i + TYPE_KEY_LEN <= end; i++) {
+        if (json[i] != '"' || memcmp(json + i, TYPE_KEY, TYPE_KEY_LEN) != 0) continue;
+
+        // "type" <ws> : <ws> "value"
+        size_t p = i + TYPE_KEY_LEN;
+        while (p < len && isSpace(json[p])) p++;
+        if (p >= len || json[p] != ':') continue;  // A value that happens to read "type"
+        p++;
+        while (p < len && isSpace(json[p])) p++;
+        if (p >= len || json[p] != '"') return false;
+
+        size_t start = ++p;
+        while (p < len && json[p] != '"' && json[p] != '\\') p++;
+        if (p >= len || json[p] != '"') return false;  // Escaped or cut off
+        *name = json + start;
+        *nameLen = p - start;
+        return true;
+    }
+    return false;
+}
+
+Type classify(const char* json, size_t len) {
+    const char* name;
+    size_t nameLen;
+    if (!findType(json, len, &name, &nameLen)) return TYPE_NOT_FOUND;
+    return fromName(name, nameLen);
+}
+
+}  // namespace RealtimeEvents
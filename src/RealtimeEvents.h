@@ -0,0 +1,44 @@
+#ifndef REALTIME_EVENTS_H
+#define REALTIME_EVENTS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Cheap pre-parse triage of realtime API server events.
+//
+// classify() pulls the value of the first "type" key straight out of the
+// raw text, without a JSON parser, so the event types the clients don't
+// handle (item.created, buffer.committed, rate_limits.updated, ...) can be
+// dropped before any parsing. The API puts the top-level type among the
+// first keys of every event; nested "type" keys sit further in.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+namespace RealtimeEvents {
+
+enum Type {
+    TYPE_NOT_FOUND = 0,     // No "type" key in the scanned bytes: parse it anyway
+    IGNORED,                // Has a type, but nothing handles it
+    SESSION_UPDATED,
+    TRANSCRIPT_DELTA,
+    TRANSCRIPT_COMPLETED,
+    SPEECH_STARTED,
+    SPEECH_STOPPED,
+    SERVER_ERROR,
+};
+
+// Bytes searched for the "type" key
+static const size_t TYPE_SCAN_BYTES = 160;
+
+Type classify(const char* json, size_t len);
+
+// Type for an already extracted type string
+Type fromName(const char* name, size_t len);
+
+// The raw "type" value classify() looks at (not NUL-terminated). Also
+// used for the LLM's Responses API stream events, which share the layout.
+bool findType(const char* json, size_t len, const char** name, size_t* nameLen);
+
+}  // namespace RealtimeEvents
+
+#endif
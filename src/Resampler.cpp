@@ -0,0 +1,142 @@
+#include "Resampler.h"
+#include "AudioDsp.h"
+#include <math.h>
+#include <string.h>
+#include <esp_heap_caps.h>
+
+static const double KAISER_BETA = 7.0;      // ~70 dB stopband
+
+static uint32_t gcd(uint32_t a, uint32_t b) {
+    while (b) {
+        uint32_t t = a % b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+// Zeroth-order modified Bessel function, for the Kaiser window
+static double besselI0(double x) {
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 32; k++) {
+        term *= (x / (2.0 * k)) * (x / (2.0 * k));
+        sum += term;
+        if (term < 1e-12 * sum) break;
+    }
+    return sum;
+}
+
+Resampler::~Resampler() {
+    if (_coeffs) heap_caps_free(_coeffs);
+    if (_history) heap_caps_free(_history);
+}
+
+bool Resampler::begin(uint32_t inRate, uint32_t outRate, size_t taps) {
+    if (inRate == 0 || outRate == 0 || taps < 4) return false;
+
+    uint32_t g = gcd(inRate, outRate);
+    uint32_t up = outRate / g;
+    uint32_t down = inRate / g;
+    if (up > MAX_PHASES) return false;
+
+    if (_coeffs) heap_caps_free(_coeffs);
+    if (_history) heap_caps_free(_history);
+    _coeffs = nullptr;
+    _history = nullptr;
+    _inRate = inRate;
+    _outRate = outRate;
+    _up = up;
+    _down = down;
+    _taps = down > up ? (taps * down + up - 1) / up : taps;
+    taps = _taps;
+    _cycles = 0;
+    _outputs = 0;
+    if (isPassthrough()) return true;
+
+    // Hot on every output sample: internal RAM first
+    size_t coeffBytes = (size_t)up * taps * sizeof(int16_t);
+    size_t historyBytes = 2 * taps * sizeof(int16_t);
+    _coeffs = (int16_t*)heap_caps_malloc(coeffBytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!_coeffs) _coeffs = (int16_t*)heap_caps_malloc(coeffBytes, MALLOC_CAP_8BIT);
+    _history = (int16_t*)heap_caps_malloc(historyBytes, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    if (!_coeffs || !_history) {
+        _up = _down = 1;
+        return false;
+    }
+
+    // Prototype at L x the input rate, cutoff in cycles per prototype sample
+    size_t n = (size_t)up * taps;
+    double nyquist = 0.5 / (up > down ? up : down);
+    double transition = 4.3 / n;
+    double cutoff = nyquist - transition / 2;
+    double centre = (n - 1) / 2.0;
+    double i0Beta = besselI0(KAISER_BETA);
+
+    double* phase = new double[taps];
+    for (uint32_t p = 0; p < up; p++) {
+        double sum = 0;
+        for (size_t k = 0; k < taps; k++) {
+            double t = p + (double)k * up - centre;
+            double sinc = fabs(t) < 1e-9 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+            double r = t / (centre + 1.0);
+            double w = besselI0(KAISER_BETA * sqrt(fmax(0.0, 1.0 - r * r))) / i0Beta;
+            phase[k] = sinc * w;
+            sum += phase[k];
+        }
+
+        // Each phase on its own sums to exactly unity: no ripple at the
+        // phase rate, and DC passes unchanged
+        int32_t total = 0;
+        size_t peak = 0;
+        for (size_t k = 0; k < taps; k++) {
+            int16_t c = (int16_t)lrint(phase[k] / sum * 32768.0);
+            _coeffs[p * taps + k] = c;
+            total += c;
+            if (fabs(phase[k]) > fabs(phase[peak])) peak = k;
+        }
+        _coeffs[p * taps + peak] += (int16_t)(32768 - total);
+    }
+    delete[] phase;
+
+    reset();
+    return true;
+}
+
+void Resampler::reset() {
+    if (_history) memset(_history, 0, 2 * _taps * sizeof(int16_t));
+    _pos = 0;
+    _acc = 0;
+}
+
+size_t Resampler::process(const int16_t* in, size_t n, int16_t* out) {
+    if (isPassthrough()) {
+        memcpy(out, in, n * sizeof(int16_t));
+        return n;
+    }
+    if (!_coeffs) return 0;
+    uint32_t start = AudioDsp::cycleCount();
+
+    const size_t taps = _taps;
+    size_t produced = 0;
+    for (size_t i = 0; i < n; i++) {
+        _pos = _pos ? _pos - 1 : taps - 1;
+        _history[_pos] = in[i];
+        _history[_pos + taps] = in[i];
+        const int16_t* x = _history + _pos;
+
+        // Outputs that fall between this input and the next
+        while (_acc < _up) {
+            const int16_t* h = _coeffs + _acc * taps;
+            int32_t sum = 0;
+            for (size_t k = 0; k < taps; k++) sum += (int32_t)h[k] * x[k];
+            out[produced++] = AudioDsp::saturate16((sum + 16384) >> 15);
+            _acc += _down;
+        }
+        _acc -= _up;
+    }
+
+    _lastCycles = AudioDsp::cycleCount() - start;
+    _cycles += _lastCycles;
+    _outputs += produced;
+    return produced;
+}
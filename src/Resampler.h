@@ -0,0 +1,75 @@
+#ifndef RESAMPLER_H
+#define RESAMPLER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Streaming rational sample-rate converter, fixed point.
+//
+// outRate / inRate is reduced to L / M. `taps` is the filter length in
+// samples of the lower of the two rates; a Kaiser-windowed sinc prototype
+// (~70 dB stopband) of that length is split into L phases of Q15
+// coefficients, each normalised to unity DC gain. Every input sample goes
+// into a double-written delay line; each output is one dot product against
+// the phase for its fractional position: `taps` MACs per output sample
+// when upsampling, taps * M / L when downsampling.
+//
+// The -6 dB point sits half a transition band below the lower Nyquist, so
+// nothing above it aliases back into the passband. The transition is
+// ~4.3 * lowerRate / taps wide (48 taps, 24 kHz <-> 16 kHz: flat to
+// ~6.5 kHz). Group delay is ~taps / 2 samples of the lower rate.
+//
+// All memory comes from begin(); process() never allocates. Equal rates
+// are a plain copy. No Arduino dependencies, so it also builds in the
+// native test env.
+
+class Resampler {
+public:
+    Resampler() {}
+    ~Resampler();
+
+    // Ratios reducing to more than MAX_PHASES output phases are rejected
+    static const uint32_t MAX_PHASES = 320;
+
+    bool begin(uint32_t inRate, uint32_t outRate, size_t taps = 48);
+    bool isPassthrough() const { return _up == _down; }
+    uint32_t inputRate() const { return _inRate; }
+    uint32_t outputRate() const { return _outRate; }
+
+    // Upper bound on what process() produces for n input samples
+    size_t maxOutput(size_t n) const { return (size_t)(((uint64_t)n * _up + _down - 1) / _down) + 1; }
+
+    // Consumes all n samples; out must have room for maxOutput(n).
+    // Returns the number of samples written.
+    size_t process(const int16_t* in, size_t n, int16_t* out);
+
+    // Clear the history (e.g. between unrelated streams)
+    void reset();
+
+    uint32_t lastCycles() const { return _lastCycles; }
+    // Average over everything processed since begin()
+    float cyclesPerOutputSample() const {
+        return _outputs ? (float)((double)_cycles / _outputs) : 0.0f;
+    }
+
+private:
+    uint32_t _inRate = 0;
+    uint32_t _outRate = 0;
+    uint32_t _up = 1;           // L
+    uint32_t _down = 1;         // M
+    size_t _taps = 0;           // Per phase
+
+    int16_t* _coeffs = nullptr; // L phases x taps, Q15
+    int16_t* _history = nullptr;// 2 x taps, newest first from _pos
+    size_t _pos = 0;
+    uint32_t _acc = 0;          // Next output's position past the newest input, in 1/L
+
+    uint32_t _lastCycles = 0;
+    uint64_t _cycles = 0;
+    uint64_t _outputs = 0;
+
+    Resampler(const Resampler&) = delete;
+    Resampler& operator=(const Resampler&) = delete;
+};
+
+#endif
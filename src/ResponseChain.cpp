@@ -0,0 +1,66 @@
+#include "ResponseChain.h"
+#include <string.h>
+
+static const char ID_KEY[] = "\"id\"";
+static const char NOT_FOUND_CODE[] = "previous_response_not_found";
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+bool ResponseChain::findResponseId(const char* json, size_t len, char* out, size_t outSize) {
+    const size_t keyLen = sizeof(ID_KEY) - 1;
+    for (size_t i = 0; i + keyLen <= len; i++) {
+        if (json[i] != '"' || memcmp(json + i, ID_KEY, keyLen) != 0) continue;
+        size_t p = i + keyLen;
+        while (p < len && isSpace(json[p])) p++;
+        if (p >= len || json[p] != ':') continue;
+        p++;
+        while (p < len && isSpace(json[p])) p++;
+        if (p >= len || json[p] != '"') continue;
+
+        // The response's own id comes first: whatever it is, stop here
+        size_t start = ++p;
+        while (p < len && json[p] != '"' && json[p] != '\\') p++;
+        if (p >= len || json[p] == '\\' || p == start || p - start >= outSize) return false;
+        memcpy(out, json + start, p - start);
+        out[p - start] = '\0';
+        return true;
+    }
+    return false;
+}
+
+bool ResponseChain::isChainNotFound(const char* body, size_t len) {
+    const size_t codeLen = sizeof(NOT_FOUND_CODE) - 1;
+    for (size_t i = 0; i + codeLen <= len; i++) {
+        if (body[i] == 'p' && memcmp(body + i, NOT_FOUND_CODE, codeLen) == 0) return true;
+    }
+    return false;
+}
+
+bool ResponseChain::onCreated(const char* json, size_t len) {
+    return findResponseId(json, len, _response, sizeof(_response));
+}
+
+void ResponseChain::commit() {
+    strcpy(_rollback, _chain);
+    strcpy(_chain, _response);
+}
+
+void ResponseChain::rollback() {
+    strcpy(_chain, _rollback);
+    _rollback[0] = '\0';
+}
+
+void ResponseChain::clear() {
+    _chain[0] = '\0';
+    _rollback[0] = '\0';
+    _response[0] = '\0';
+}
+
+bool ResponseChain::onRejected(int status, const char* body, size_t len) {
+    if (!active() || (status != 400 && status != 404)) return false;
+    if (!isChainNotFound(body, len)) return false;
+    clear();
+    return true;
+}
@@ -0,0 +1,57 @@
+#ifndef RESPONSE_CHAIN_H
+#define RESPONSE_CHAIN_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Server-side conversation chain of the Responses API (LLM_SERVER_STATE).
+//
+// Each request continues the stored response of the previous exchange
+// through previous_response_id. Tracks that id, the one before it (so a
+// cancelled exchange can be taken back) and the id of the response being
+// streamed, read from its response.created event. Once the server says the
+// stored response is gone, the chain is dropped and the request goes again
+// with the local history.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+static const size_t RESPONSE_ID_MAX = 96;
+
+class ResponseChain {
+public:
+    // What the next request continues; "" starts over
+    const char* id() const { return _chain; }
+    bool active() const { return _chain[0] != '\0'; }
+
+    // A request (or its resend) is going out
+    void beginRequest() { _response[0] = '\0'; }
+
+    // Data of the response.created event: remembers the new response's id
+    bool onCreated(const char* json, size_t len);
+    const char* responseId() const { return _response; }
+
+    // Exchange completed: the next request continues it. Without an id
+    // (event lost) it starts over from the local history.
+    void commit();
+    // The completed exchange was taken back out of the history
+    void rollback();
+    void clear();
+
+    // Error response to a chained request. True if the stored response is
+    // gone (the chain is then dropped and the request should be resent);
+    // any other error leaves the chain alone.
+    bool onRejected(int status, const char* body, size_t len);
+
+    // First "id" string value, scanned for so a truncated event still
+    // yields it. False if there is none, or it is cut off, escaped or
+    // longer than outSize - 1.
+    static bool findResponseId(const char* json, size_t len, char* out, size_t outSize);
+    static bool isChainNotFound(const char* body, size_t len);
+
+private:
+    char _chain[RESPONSE_ID_MAX] = "";
+    char _rollback[RESPONSE_ID_MAX] = "";
+    char _response[RESPONSE_ID_MAX] = "";
+};
+
+#endif
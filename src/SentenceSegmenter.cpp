@@ -0,0 +1,76 @@
+#include "SentenceSegmenter.h"
+#include <string.h>
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+void SentenceSegmenter::reset() {
+    _len = 0;
+    _segments = 0;
+}
+
+void SentenceSegmenter::push(const char* text) {
+    push(text, strlen(text));
+}
+
+void SentenceSegmenter::push(const char* text, size_t len) {
+    for (size_t i = 0; i < len; i++) pushChar(text[i]);
+}
+
+void SentenceSegmenter::flush() {
+    emit(_len);
+}
+
+// Emits the first len buffered chars (trimmed) and keeps the rest
+void SentenceSegmenter::emit(size_t len) {
+    size_t start = 0;
+    size_t end = len;
+    while (start < end && isSpace(_buf[start])) start++;
+    while (end > start && isSpace(_buf[end - 1])) end--;
+
+    if (end > start) {
+        _segments++;
+        if (_sink) {
+            char saved = _buf[end];
+            _buf[end] = 0;  // Sinks may treat it as a C string
+            _sink(_buf + start, end - start);
+            _buf[end] = saved;
+        }
+    }
+
+    memmove(_buf, _buf + len, _len - len);
+    _len -= len;
+}
+
+void SentenceSegmenter::pushChar(char c) {
+    // Nothing to say before the first word
+    if (_len == 0 && isSpace(c)) return;
+
+    if (isSpace(c) && _len > 0) {
+        char last = _buf[_len - 1];
+        size_t clause = _segments == 0 ? _firstClause : _laterClause;
+
+        if (c == '\n' && _len >= _minSentence) {
+            emit(_len);
+            return;
+        }
+        if ((last == '.' || last == '!' || last == '?') && _len >= _minSentence) {
+            emit(_len);
+            return;
+        }
+        if ((last == ',' || last == ';' || last == ':') && _len >= clause) {
+            emit(_len);
+            return;
+        }
+    }
+
+    if (_len == SEGMENT_MAX_CHARS) {
+        // No boundary in sight: split at the last space, or hard if none
+        size_t cut = _len;
+        while (cut > 0 && !isSpace(_buf[cut - 1])) cut--;
+        emit(cut > 0 ? cut : _len);
+        if (_len == 0 && isSpace(c)) return;
+    }
+    _buf[_len++] = c;
+}
@@ -0,0 +1,59 @@
+#ifndef SENTENCE_SEGMENTER_H
+#define SENTENCE_SEGMENTER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+// Splits streamed LLM text into segments worth sending to TTS on their own.
+//
+// A segment ends at sentence punctuation (. ! ? or a newline) followed by
+// whitespace, once it has minSentenceChars; at a clause break (, ; :)
+// once it has clauseChars (shorter for the first segment, so the first
+// audio starts early); or, failing both, at the last space before
+// SEGMENT_MAX_CHARS. Punctuation not followed by whitespace ("3.5",
+// "e.g.x") never splits. Emitted segments have no leading or trailing
+// whitespace.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+static const size_t SEGMENT_MAX_CHARS = 240;
+
+class SentenceSegmenter {
+public:
+    typedef std::function<void(const char* text, size_t len)> Sink;
+
+    SentenceSegmenter() { reset(); }
+
+    void setSink(Sink sink) { _sink = sink; }
+    void setMinSentenceChars(size_t n) { _minSentence = n; }
+    void setClauseChars(size_t first, size_t later) {
+        _firstClause = first;
+        _laterClause = later;
+    }
+
+    void push(const char* text, size_t len);
+    void push(const char* text);
+
+    // End of the stream: emit whatever is left
+    void flush();
+
+    // Drop buffered text and start a new answer
+    void reset();
+
+    uint32_t segments() const { return _segments; }
+
+private:
+    Sink _sink;
+    char _buf[SEGMENT_MAX_CHARS + 1];
+    size_t _len;
+    uint32_t _segments;
+    size_t _minSentence = 12;
+    size_t _firstClause = 24;
+    size_t _laterClause = 80;
+
+    void emit(size_t len);
+    void pushChar(char c);
+};
+
+#endif
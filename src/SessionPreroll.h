@@ -0,0 +1,102 @@
+#ifndef SESSION_PREROLL_H
+#define SESSION_PREROLL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <functional>
+#include <esp_heap_caps.h>
+#include "CaptureFrameRing.h"
+
+// Holds uplink audio while the transcription session isn't ready.
+//
+// Frames meant for the session arrive here first. While the session is
+// connecting (or not yet configured) the most recent ones are kept in a
+// ring, oldest overwritten; once it is ready they are replayed in order
+// ahead of live audio. Frames are tracked by firstSample, so nothing that
+// already reached the session is sent twice, whichever path it came by.
+
+class SessionPreroll {
+public:
+    typedef std::function<void(const CaptureFrame&)> Sink;
+
+    SessionPreroll(size_t frames) : _capacity(frames) {
+        // Touched once per frame: PSRAM is fine, internal RAM as fallback
+        if (_capacity) {
+            size_t bytes = _capacity * sizeof(CaptureFrame);
+            _frames = (CaptureFrame*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            if (!_frames) _frames = (CaptureFrame*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+        }
+    }
+
+    ~SessionPreroll() {
+        if (_frames) heap_caps_free(_frames);
+    }
+
+    bool isAllocated() const { return _frames != NULL; }
+    void setSink(Sink sink) { _sink = sink; }
+
+    void process(const CaptureFrame& f, bool sessionReady) {
+        if (!sessionReady) {
+            store(f);
+            return;
+        }
+        flush();
+        send(f);
+    }
+
+    // Replay held frames (call as soon as the session reports ready)
+    void flush() {
+        size_t first = (_next + _capacity - _count) % (_capacity ? _capacity : 1);
+        size_t count = _count;
+        _count = 0;
+        for (size_t i = 0; i < count; i++) {
+            _replayed++;
+            send(_frames[(first + i) % _capacity]);
+        }
+    }
+
+    // Forget held frames (stale once an answer has played)
+    void reset() { _count = 0; }
+
+    size_t pending() const { return _count; }
+    uint32_t framesReplayed() const { return _replayed; }
+    uint32_t framesLost() const { return _lost; }
+    uint32_t duplicatesSkipped() const { return _duplicates; }
+
+private:
+    CaptureFrame* _frames = NULL;
+    size_t _capacity;
+    size_t _next = 0;
+    size_t _count = 0;
+    Sink _sink;
+    bool _sentAny = false;
+    uint32_t _sentEnd = 0;      // firstSample just past the last frame sent
+    uint32_t _replayed = 0;
+    uint32_t _lost = 0;         // Overwritten before the session was ready
+    uint32_t _duplicates = 0;
+
+    void store(const CaptureFrame& f) {
+        if (!_frames) {
+            _lost++;
+            return;
+        }
+        if (_count == _capacity) _lost++;
+        memcpy(&_frames[_next], &f, sizeof(CaptureFrame));
+        _next = (_next + 1) % _capacity;
+        if (_count < _capacity) _count++;
+    }
+
+    void send(const CaptureFrame& f) {
+        // Signed distance, so the index may wrap
+        if (_sentAny && (int32_t)(f.firstSample - _sentEnd) < 0) {
+            _duplicates++;
+            return;
+        }
+        _sentAny = true;
+        _sentEnd = f.firstSample + f.samples;
+        if (_sink) _sink(f);
+    }
+};
+
+#endif
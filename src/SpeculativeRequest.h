@@ -0,0 +1,97 @@
+#ifndef SPECULATIVE_REQUEST_H
+#define SPECULATIVE_REQUEST_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "PartialTranscript.h"
+
+// The LLM request started on a settled partial transcript.
+//
+// Client is LLMClient (a fake in the host tests): startChat(), poll(),
+// responseSoFar() and cancel(). A speculation only stands in for the final
+// transcript while its request is alive. One that died (connect, HTTP or
+// timeout error) is dropped as soon as service() sees it, so a later
+// partial can try again, and ask() then sends the final transcript itself.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+template <class Client>
+class SpeculativeRequest {
+public:
+    enum Outcome { NONE, HIT, MISS, DEAD };
+
+    void setClient(Client* client) { _client = client; }
+
+    bool active() const { return _text[0] != '\0'; }
+    const char* text() const { return _text; }
+    uint32_t startMs() const { return _startMs; }
+
+    bool start(const char* partial, uint32_t nowMs) {
+        if (!_client || active() || !partial[0]) return false;
+        if (!_client->startChat(partial)) return false;
+        strncpy(_text, partial, sizeof(_text) - 1);
+        _text[sizeof(_text) - 1] = '\0';
+        _startMs = nowMs;
+        return true;
+    }
+
+    // From loop(): keeps the request reading. False once it has died.
+    bool service() {
+        if (!active()) return true;
+        if (alive()) return true;
+        _failed++;
+        drop();
+        return false;
+    }
+
+    // Final transcript in: afterwards the request answering it is running,
+    // the speculative one on a hit, a fresh one otherwise. False if none
+    // could be started. outcome() tells which.
+    bool ask(const char* finalText) {
+        _outcome = NONE;
+        if (active()) {
+            if (!alive()) {
+                _outcome = DEAD;
+                _failed++;
+                drop();
+            } else if (PartialTranscript::matches(_text, finalText)) {
+                _outcome = HIT;
+                _hits++;
+                _text[0] = '\0';
+                return true;
+            } else {
+                _outcome = MISS;
+                _misses++;
+                drop();
+            }
+        }
+        return _client && _client->startChat(finalText);
+    }
+
+    Outcome outcome() const { return _outcome; }
+    uint32_t hits() const { return _hits; }
+    uint32_t misses() const { return _misses; }
+    uint32_t failed() const { return _failed; }
+
+private:
+    Client* _client = nullptr;
+    char _text[PARTIAL_TRANSCRIPT_MAX] = "";
+    uint32_t _startMs = 0;
+    Outcome _outcome = NONE;
+    uint32_t _hits = 0;
+    uint32_t _misses = 0;
+    uint32_t _failed = 0;
+
+    // Still running, or finished with text
+    bool alive() {
+        return _client->poll() || _client->responseSoFar().length() > 0;
+    }
+
+    void drop() {
+        _client->cancel();
+        _text[0] = '\0';
+    }
+};
+
+#endif
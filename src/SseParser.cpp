@@ -0,0 +1,122 @@
+#include "SseParser.h"
+#include <string.h>
+
+void SseParser::reset() {
+    _state = FIELD;
+    _field = F_OTHER;
+    _afterCR = false;
+    _fieldLen = 0;
+    _dataLen = 0;
+    _hasData = false;
+    _overflow = false;
+    _nameLen = 0;
+}
+
+void SseParser::feed(const char* data, size_t len) {
+    size_t i = 0;
+    while (i < len) {
+        char c = data[i];
+        if (_afterCR) {
+            _afterCR = false;
+            if (c == '\n') {
+                i++;
+                continue;
+            }
+        }
+
+        if (_state == VALUE || _state == IGNORE) {
+            // Bulk of the bytes: copy up to the end of the line in one go
+            size_t end = i;
+            while (end < len && data[end] != '\n' && data[end] != '\r') end++;
+            if (_state == VALUE) append(data + i, end - i);
+            i = end;
+            if (i < len) {
+                _afterCR = data[i++] == '\r';
+                endLine();
+            }
+            continue;
+        }
+
+        if (_state == VALUE_START) {
+            // One space after the colon is not part of the value
+            if (c == ' ') i++;
+            _state = VALUE;
+            startValue();
+            continue;
+        }
+
+        // FIELD
+        i++;
+        if (c == ':') {
+            _field = F_OTHER;
+            if (_fieldLen == 4 && memcmp(_fieldName, "data", 4) == 0) _field = F_DATA;
+            else if (_fieldLen == 5 && memcmp(_fieldName, "event", 5) == 0) _field = F_EVENT;
+            _state = _field == F_OTHER ? IGNORE : VALUE_START;   // Comments too
+        } else if (c == '\n' || c == '\r') {
+            _afterCR = c == '\r';
+            if (_fieldLen == 0) {
+                dispatch();
+            } else {
+                // A field without a colon has an empty value
+                if (_fieldLen == 4 && memcmp(_fieldName, "data", 4) == 0) {
+                    _field = F_DATA;
+                    startValue();
+                }
+                endLine();
+            }
+        } else {
+            // Longer names match nothing; count them so they can't
+            if (_fieldLen < sizeof(_fieldName)) _fieldName[_fieldLen] = c;
+            _fieldLen++;
+        }
+    }
+}
+
+void SseParser::startValue() {
+    if (_field == F_DATA) {
+        // Data lines of one event are joined with a newline
+        if (_hasData) append("\n", 1);
+        _hasData = true;
+    } else if (_field == F_EVENT) {
+        _nameLen = 0;
+    }
+}
+
+void SseParser::append(const char* text, size_t len) {
+    if (_field == F_DATA) {
+        size_t room = SSE_DATA_MAX - 1 - _dataLen;
+        if (len > room) {
+            len = room;
+            _overflow = true;
+        }
+        memcpy(_data + _dataLen, text, len);
+        _dataLen += len;
+    } else if (_field == F_EVENT) {
+        size_t room = SSE_NAME_MAX - 1 - _nameLen;
+        if (len > room) len = room;
+        memcpy(_name + _nameLen, text, len);
+        _nameLen += len;
+    }
+}
+
+void SseParser::endLine() {
+    _state = FIELD;
+    _field = F_OTHER;
+    _fieldLen = 0;
+}
+
+// Blank line: the event is complete
+void SseParser::dispatch() {
+    if (_hasData) {
+        _data[_dataLen] = '\0';
+        _name[_nameLen] = '\0';
+        SseEvent event = {_name, _data, _dataLen, _overflow};
+        _events++;
+        if (_overflow) _truncated++;
+        if (_handler) _handler(event);
+    }
+    _dataLen = 0;
+    _hasData = false;
+    _overflow = false;
+    _nameLen = 0;
+}
@@ -0,0 +1,66 @@
+#ifndef SSE_PARSER_H
+#define SSE_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+
+// Incremental server-sent events parser (text/event-stream).
+//
+// Bytes go in as they arrive, split anywhere; each complete event comes
+// out once, with its data lines joined by '\n' in a fixed buffer. Data
+// beyond SSE_DATA_MAX is dropped and the event flagged truncated, so a
+// huge event costs no memory but can still be recognised by its start.
+// Line ends may be LF, CRLF or CR; comments and unknown fields are skipped.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+static const size_t SSE_DATA_MAX = 4096;
+static const size_t SSE_NAME_MAX = 48;
+
+struct SseEvent {
+    const char* name;       // "event:" field, "" if none
+    char* data;             // NUL-terminated; the handler may parse it in place
+    size_t dataLen;
+    bool truncated;
+};
+
+class SseParser {
+public:
+    typedef std::function<void(SseEvent& event)> Handler;
+
+    void setHandler(Handler handler) { _handler = handler; }
+    void reset();
+    void feed(const char* data, size_t len);
+
+    uint32_t events() const { return _events; }
+    uint32_t truncatedEvents() const { return _truncated; }
+
+private:
+    enum State { FIELD, VALUE_START, VALUE, IGNORE };
+    enum Field { F_OTHER, F_DATA, F_EVENT };
+
+    Handler _handler;
+    State _state = FIELD;
+    Field _field = F_OTHER;
+    bool _afterCR = false;          // Swallow the LF of a CRLF
+    char _fieldName[8];
+    size_t _fieldLen = 0;
+
+    char _data[SSE_DATA_MAX];
+    size_t _dataLen = 0;
+    bool _hasData = false;
+    bool _overflow = false;
+    char _name[SSE_NAME_MAX];
+    size_t _nameLen = 0;
+
+    uint32_t _events = 0;
+    uint32_t _truncated = 0;
+
+    void startValue();
+    void append(const char* text, size_t len);
+    void endLine();
+    void dispatch();
+};
+
+#endif
@@ -1,7 +1,23 @@
 #include "TranscriptionClient.h"
-#include <mbedtls/base64.h>
-
-TranscriptionClient::TranscriptionClient(String apiKey) : _apiKey(apiKey) {
+#include "G711.h"
+
+#if UPLINK_AUDIO_FORMAT == UPLINK_FORMAT_G711_ULAW
+static const char INPUT_AUDIO_FORMAT[] = "g711_ulaw";
+#elif UPLINK_AUDIO_FORMAT == UPLINK_FORMAT_G711_ALAW
+static const char INPUT_AUDIO_FORMAT[] = "g711_alaw";
+#else
+static const char INPUT_AUDIO_FORMAT[] = "pcm16";
+#endif
+
+TranscriptionClient::TranscriptionClient(String apiKey)
+    : _apiKey(apiKey), _append(WEBSOCKETS_MAX_HEADER_SIZE, APPEND_MAX_AUDIO_BYTES), _eventDoc(4096) {
+    _packetizer.begin(UPLINK_SAMPLE_RATE, UPLINK_PACKET_MIN_MS, UPLINK_PACKET_MAX_MS, UPLINK_PACKET_START_MS);
+
+    _eventFilter["type"] = true;
+    _eventFilter["transcript"] = true;
+    _eventFilter["text"] = true;
+    _eventFilter["delta"] = true;
+    _eventFilter["error"]["message"] = true;
 }
 
 bool TranscriptionClient::connect() {
@@ -17,6 +33,8 @@ bool TranscriptionClient::connect() {
 
     _webSocket.setReconnectInterval(5000);
     _ready = false;
+    _connectStartMs = millis();
+    _packetizer.clear();
 
     return true;
 }
@@ -42,6 +60,10 @@ void TranscriptionClient::onTranscriptionComplete(std::function<void(String)> ca
     _transcriptionCallback = callback;
 }
 
+void TranscriptionClient::onTranscriptionDelta(std::function<void(String)> callback) {
+    _deltaCallback = callback;
+}
+
 void TranscriptionClient::onSpeechStarted(std::function<void()> callback) {
     _speechStartedCallback = callback;
 }
@@ -57,57 +79,92 @@ void TranscriptionClient::onError(std::function<void(String)> callback) {
 void TranscriptionClient::webSocketEvent(WStype_t type, uint8_t* payload, size_t length) {
     switch (type) {
         case WStype_DISCONNECTED:
+            // Also fired for each failed attempt; only count real drops
+            if (_open) {
+                _session.disconnects++;
+                _connectStartMs = millis();  // The library reconnects on its own
+            }
+            _open = false;
             _ready = false;
             break;
 
         case WStype_CONNECTED:
+            _open = true;
+            _session.connects++;
             Serial.println("[WS] Connected");
             sendSessionUpdate();
             break;
 
         case WStype_TEXT: {
-            DynamicJsonDocument doc(4096);
-            if (deserializeJson(doc, payload, length)) return;
+            _events.events++;
+            RealtimeEvents::Type eventType = RealtimeEvents::classify((const char*)payload, length);
+
+            // Deltas are frequent: only parse them for a listener
+            if (eventType == RealtimeEvents::IGNORED ||
+                (eventType == RealtimeEvents::TRANSCRIPT_DELTA && !_deltaCallback)) {
+                _events.skipped++;
+                return;
+            }
+            handleEvent(eventType, payload, length);
+            break;
+        }
 
-            const char* eventType = doc["type"];
-            if (!eventType) return;
+        default:
+            break;
+    }
+}
 
-            if (strcmp(eventType, "transcription_session.updated") == 0 ||
-                strcmp(eventType, "session.updated") == 0) {
-                _ready = true;
-                Serial.println("[WS] Ready");
-            }
-            else if (strcmp(eventType, "conversation.item.input_audio_transcription.completed") == 0) {
-                if (doc.containsKey("transcript") && _transcriptionCallback) {
-                    String text = doc["transcript"].as<String>();
-                    if (text.length() > 0) _transcriptionCallback(text);
-                }
-            }
-            else if (strcmp(eventType, "input_audio_buffer.transcription.completed") == 0 ||
-                     strcmp(eventType, "transcription.completed") == 0) {
-                String text = "";
-                if (doc.containsKey("transcript")) text = doc["transcript"].as<String>();
-                else if (doc.containsKey("text")) text = doc["text"].as<String>();
-                if (text.length() > 0 && _transcriptionCallback) _transcriptionCallback(text);
-            }
-            else if (strcmp(eventType, "input_audio_buffer.speech_started") == 0) {
-                if (_speechStartedCallback) _speechStartedCallback();
-            }
-            else if (strcmp(eventType, "input_audio_buffer.speech_stopped") == 0) {
-                if (_speechStoppedCallback) _speechStoppedCallback();
-            }
-            else if (strcmp(eventType, "error") == 0) {
-                if (_errorCallback) {
-                    String msg = "Error";
-                    if (doc.containsKey("error") && doc["error"].containsKey("message")) {
-                        msg = doc["error"]["message"].as<String>();
-                    }
-                    _errorCallback(msg);
-                }
-            }
+void TranscriptionClient::handleEvent(RealtimeEvents::Type eventType, uint8_t* payload, size_t length) {
+    uint32_t start = micros();
+    DeserializationError err = deserializeJson(_eventDoc, (const char*)payload, length,
+                                               DeserializationOption::Filter(_eventFilter));
+    _events.lastParseUs = micros() - start;
+    if (_events.lastParseUs > _events.maxParseUs) _events.maxParseUs = _events.lastParseUs;
+    if (err) {
+        _events.parseErrors++;
+        return;
+    }
+    _events.parsed++;
+
+    // The quick check couldn't find the type: fall back to the parsed one
+    if (eventType == RealtimeEvents::TYPE_NOT_FOUND) {
+        const char* name = _eventDoc["type"];
+        if (!name) return;
+        eventType = RealtimeEvents::fromName(name, strlen(name));
+    }
+
+    switch (eventType) {
+        case RealtimeEvents::SESSION_UPDATED:
+            if (!_ready) _session.lastTimeToReadyMs = millis() - _connectStartMs;
+            _ready = true;
+            Serial.printf("[WS] Ready (%u ms)\n", _session.lastTimeToReadyMs);
+            break;
+
+        case RealtimeEvents::TRANSCRIPT_COMPLETED: {
+            const char* text = _eventDoc["transcript"];
+            if (!text) text = _eventDoc["text"];
+            if (text && text[0] && _transcriptionCallback) _transcriptionCallback(String(text));
+            break;
+        }
+
+        case RealtimeEvents::TRANSCRIPT_DELTA: {
+            const char* delta = _eventDoc["delta"];
+            if (delta && delta[0] && _deltaCallback) _deltaCallback(String(delta));
             break;
         }
 
+        case RealtimeEvents::SPEECH_STARTED:
+            if (_speechStartedCallback) _speechStartedCallback();
+            break;
+
+        case RealtimeEvents::SPEECH_STOPPED:
+            if (_speechStoppedCallback) _speechStoppedCallback();
+            break;
+
+        case RealtimeEvents::SERVER_ERROR:
+            if (_errorCallback) _errorCallback(String(_eventDoc["error"]["message"] | "Error"));
+            break;
+
         default:
             break;
     }
@@ -118,7 +175,7 @@ void TranscriptionClient::sendSessionUpdate() {
     doc["type"] = "transcription_session.update";
 
     JsonObject session = doc.createNestedObject("session");
-    session["input_audio_format"] = "pcm16";
+    session["input_audio_format"] = INPUT_AUDIO_FORMAT;
 
     JsonObject transcription = session.createNestedObject("input_audio_transcription");
     transcription["model"] = "gpt-4o-mini-transcribe";
@@ -135,26 +192,62 @@ void TranscriptionClient::sendSessionUpdate() {
 }
 
 void TranscriptionClient::sendAudio(uint8_t* data, size_t len) {
-    if (!_webSocket.isConnected()) return;
-
-    size_t b64Len = ((len + 2) / 3) * 4 + 1;
-    char* b64Data = (char*)malloc(b64Len);
-
-    if (b64Data) {
-        size_t written;
-        mbedtls_base64_encode((unsigned char*)b64Data, b64Len, &written, data, len);
-        b64Data[written] = 0;
+    if (!_webSocket.isConnected() || !_append.isAllocated() || !_packetizer.isReady()) return;
+
+    const int16_t* pcm = (const int16_t*)data;
+    size_t samples = len / 2;
+    while (samples > 0) {
+        size_t used = _packetizer.append(pcm, samples);
+        pcm += used;
+        samples -= used;
+        if (_packetizer.packetReady()) sendPacket();
+    }
+}
 
-        String json = "{\"type\":\"input_audio_buffer.append\",\"audio\":\"";
-        json += b64Data;
-        json += "\"}";
+void TranscriptionClient::flushAudio() {
+    if (!_webSocket.isConnected() || _packetizer.packetSamples() == 0) return;
+    sendPacket();
+}
 
-        _webSocket.sendTXT(json);
-        free(b64Data);
+void TranscriptionClient::sendPacket() {
+    size_t samples = _packetizer.packetSamples();
+#if UPLINK_AUDIO_FORMAT == UPLINK_FORMAT_G711_ULAW
+    G711::encodeUlaw(_packetizer.packet(), _encoded, samples);
+    size_t written = _append.build(_encoded, samples);
+#elif UPLINK_AUDIO_FORMAT == UPLINK_FORMAT_G711_ALAW
+    G711::encodeAlaw(_packetizer.packet(), _encoded, samples);
+    size_t written = _append.build(_encoded, samples);
+#else
+    size_t written = _append.build((const uint8_t*)_packetizer.packet(), samples * 2);
+#endif
+
+    // headerToPayload: the library writes the header into the headroom
+    // and masks in place, so nothing is copied or allocated. sendTXT
+    // blocks while TCP is backed up, so its duration drives the packet size.
+    uint32_t start = micros();
+    bool ok = written > 0 && _webSocket.sendTXT(_append.buffer(), written, true);
+    _packetizer.packetSent(micros() - start, ok);
+
+    if (ok) {
+        _uplink.messages++;
+        _uplink.samples += samples;
+        _uplink.audioBytes += samples * UPLINK_BYTES_PER_SAMPLE;
+        _uplink.wireBytes += UplinkPacketizer::wireBytes(written);
+        _uplink.tlsRecords += UplinkPacketizer::tlsRecords(written);
+    } else {
+        _uplink.failures++;
     }
 }
 
+void TranscriptionClient::clearAudio() {
+    _packetizer.clear();
+    if (!_webSocket.isConnected()) return;
+    _webSocket.sendTXT("{\"type\":\"input_audio_buffer.clear\"}");
+    _session.clears++;
+}
+
 void TranscriptionClient::commitAudio() {
     if (!_webSocket.isConnected()) return;
+    flushAudio();
     _webSocket.sendTXT("{\"type\":\"input_audio_buffer.commit\"}");
 }
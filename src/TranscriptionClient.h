@@ -4,10 +4,43 @@
 #include <Arduino.h>
 #include <WebSocketsClient.h>
 #include <ArduinoJson.h>
+#include "AudioFraming.h"
+#include "BoardConfig.h"
+#include "UplinkPacketizer.h"
+#include "RealtimeEvents.h"
 
 // OpenAI Realtime Transcription API
 // Model: gpt-4o-mini-transcribe
-// Audio format: PCM16 24kHz Mono
+// Audio format: UPLINK_AUDIO_FORMAT (PCM16 24kHz or G.711 8kHz), Mono
+
+// Largest audio payload of one append message (one full-size uplink packet)
+static const size_t APPEND_MAX_PCM_SAMPLES = (size_t)UPLINK_SAMPLE_RATE * UPLINK_PACKET_MAX_MS / 1000;
+static const size_t APPEND_MAX_AUDIO_BYTES = APPEND_MAX_PCM_SAMPLES * UPLINK_BYTES_PER_SAMPLE;
+
+struct UplinkStats {
+    uint32_t messages;          // input_audio_buffer.append messages sent
+    uint32_t samples;
+    uint32_t audioBytes;        // Encoded, before base64
+    uint32_t wireBytes;         // Estimated, with WebSocket and TLS framing
+    uint32_t tlsRecords;        // Estimated
+    uint32_t failures;          // Socket refused the frame
+};
+
+struct EventStats {
+    uint32_t events;            // Text frames received
+    uint32_t skipped;           // Dropped by the type check, never parsed
+    uint32_t parsed;
+    uint32_t parseErrors;
+    uint32_t lastParseUs;
+    uint32_t maxParseUs;
+};
+
+struct SessionStats {
+    uint32_t connects;          // WebSocket handshakes completed
+    uint32_t disconnects;
+    uint32_t clears;            // input_audio_buffer.clear sent
+    uint32_t lastTimeToReadyMs; // connect() or drop -> session.updated
+};
 
 class TranscriptionClient {
 public:
@@ -18,8 +51,16 @@ public:
     void loop();
 
     // Audio input
+    // PCM16 at UPLINK_SAMPLE_RATE; buffered until a packet is full, then
+    // encoded in the session's input format
     void sendAudio(uint8_t* data, size_t len);
+    void flushAudio();   // Send a partial packet now (end of an utterance)
     void commitAudio();  // Signal end of speech
+    void clearAudio();   // Drop unsent audio here and in the server's input buffer
+    const UplinkStats& uplinkStats() const { return _uplink; }
+    const UplinkPacketizer& packetizer() const { return _packetizer; }
+    const EventStats& eventStats() const { return _events; }
+    const SessionStats& sessionStats() const { return _session; }
 
     // State
     bool isConnected();
@@ -27,6 +68,7 @@ public:
 
     // Events
     void onTranscriptionComplete(std::function<void(String)> callback);
+    void onTranscriptionDelta(std::function<void(String)> callback);  // Partial text as it streams
     void onSpeechStarted(std::function<void()> callback);
     void onSpeechStopped(std::function<void()> callback);
     void onError(std::function<void(String)> callback);
@@ -35,14 +77,35 @@ private:
     String _apiKey;
     WebSocketsClient _webSocket;
     bool _ready = false;
+    bool _open = false;         // WebSocket up (session may not be configured yet)
+    unsigned long _connectStartMs = 0;
+    SessionStats _session = {};
+
+    // Append messages are encoded in place, after room for the WebSocket
+    // header, and sent without another copy or allocation
+    AudioFraming::AppendFrameBuilder _append;
+    UplinkPacketizer _packetizer;
+#if UPLINK_AUDIO_FORMAT != UPLINK_FORMAT_PCM16
+    uint8_t _encoded[APPEND_MAX_PCM_SAMPLES];
+#endif
+    UplinkStats _uplink = {};
+
+    // Server events: one arena for the life of the client, and a filter
+    // that keeps only the fields the handlers read
+    DynamicJsonDocument _eventDoc;
+    StaticJsonDocument<128> _eventFilter;
+    EventStats _events = {};
 
     std::function<void(String)> _transcriptionCallback;
+    std::function<void(String)> _deltaCallback;
     std::function<void()> _speechStartedCallback;
     std::function<void()> _speechStoppedCallback;
     std::function<void(String)> _errorCallback;
 
     void webSocketEvent(WStype_t type, uint8_t* payload, size_t length);
+    void handleEvent(RealtimeEvents::Type type, uint8_t* payload, size_t length);
     void sendSessionUpdate();
+    void sendPacket();
 };
 
 #endif
@@ -0,0 +1,100 @@
+#ifndef UPLINK_GATE_H
+#define UPLINK_GATE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <functional>
+#include <esp_heap_caps.h>
+#include "CaptureFrameRing.h"
+#include "VoiceActivityDetector.h"
+
+// Opens the uplink only while the VAD hears speech.
+//
+// While closed, frames go into a small pre-roll ring (oldest overwritten) so
+// the start of an utterance, including the frames the VAD needed to decide,
+// is sent first when the gate opens. Everything that never reaches the sink
+// counts as suppressed.
+
+class UplinkGate {
+public:
+    typedef std::function<void(const CaptureFrame&)> Sink;
+
+    UplinkGate(size_t prerollFrames) : _capacity(prerollFrames) {
+        // Touched once per frame: PSRAM is fine, internal RAM as fallback
+        if (_capacity) {
+            size_t bytes = _capacity * sizeof(CaptureFrame);
+            _preroll = (CaptureFrame*)heap_caps_malloc(bytes, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+            if (!_preroll) _preroll = (CaptureFrame*)heap_caps_malloc(bytes, MALLOC_CAP_8BIT);
+        }
+    }
+
+    ~UplinkGate() {
+        if (_preroll) heap_caps_free(_preroll);
+    }
+
+    bool begin(uint32_t sampleRate) {
+        return (_capacity == 0 || _preroll) && _vad.begin(sampleRate);
+    }
+
+    VoiceActivityDetector& vad() { return _vad; }
+    void setSink(Sink sink) { _sink = sink; }
+    bool isOpen() const { return _vad.isSpeech(); }
+
+    void process(const CaptureFrame& f) {
+        _framesIn++;
+        bool wasOpen = _vad.isSpeech();
+        bool open = _vad.process(f.pcm, f.samples);
+
+        if (open) {
+            if (!wasOpen) flushPreroll();
+            send(f);
+        } else {
+            store(f);
+        }
+    }
+
+    // Forget buffered audio and return to silence (e.g. after TTS)
+    void reset() {
+        _count = 0;
+        _vad.reset();
+    }
+
+    uint32_t framesIn() const { return _framesIn; }
+    uint32_t framesSent() const { return _framesSent; }
+    float suppressedPercent() const {
+        if (_framesIn == 0) return 0;
+        uint32_t sent = _framesSent > _framesIn ? _framesIn : _framesSent;
+        return 100.0f * (float)(_framesIn - sent) / (float)_framesIn;
+    }
+
+private:
+    VoiceActivityDetector _vad;
+    Sink _sink;
+    CaptureFrame* _preroll = NULL;
+    size_t _capacity;
+    size_t _next = 0;       // Slot for the next stored frame
+    size_t _count = 0;      // Valid frames in the pre-roll
+    uint32_t _framesIn = 0;
+    uint32_t _framesSent = 0;
+
+    void send(const CaptureFrame& f) {
+        _framesSent++;
+        if (_sink) _sink(f);
+    }
+
+    void store(const CaptureFrame& f) {
+        if (!_preroll) return;
+        memcpy(&_preroll[_next], &f, sizeof(CaptureFrame));
+        _next = (_next + 1) % _capacity;
+        if (_count < _capacity) _count++;
+    }
+
+    void flushPreroll() {
+        size_t first = (_next + _capacity - _count) % (_capacity ? _capacity : 1);
+        for (size_t i = 0; i < _count; i++) send(_preroll[(first + i) % _capacity]);
+        _count = 0;
+    }
+};
+
+#endif
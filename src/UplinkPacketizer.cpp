@@ -0,0 +1,103 @@
+#include "UplinkPacketizer.h"
+#include <string.h>
+#include <esp_heap_caps.h>
+
+static const uint32_t SLOW_SEND_DIV = 4;     // Send took > 1/4 of the packet's audio
+static const uint32_t CHEAP_SEND_DIV = 16;   // Send took < 1/16
+static const uint32_t CALM_PACKETS = 16;     // Cheap sends in a row before shrinking
+
+// mbedTLS on Arduino-ESP32 encrypts at most 4 KB per record (SSL_OUT_CONTENT_LEN);
+// AES-GCM adds a 5-byte header, 8-byte explicit nonce and 16-byte tag
+static const size_t TLS_RECORD_PAYLOAD = 4096;
+static const size_t TLS_RECORD_OVERHEAD = 29;
+
+UplinkPacketizer::~UplinkPacketizer() {
+    if (_buf) heap_caps_free(_buf);
+}
+
+bool UplinkPacketizer::begin(uint32_t sampleRate, uint32_t minMs, uint32_t maxMs, uint32_t startMs) {
+    if (sampleRate == 0 || minMs == 0 || maxMs < minMs) return false;
+
+    if (_buf) heap_caps_free(_buf);
+    _capacity = (size_t)sampleRate * maxMs / 1000;
+
+    // Written and read once per packet: PSRAM is fine, internal RAM as fallback
+    _buf = (int16_t*)heap_caps_malloc(_capacity * sizeof(int16_t), MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!_buf) _buf = (int16_t*)heap_caps_malloc(_capacity * sizeof(int16_t), MALLOC_CAP_8BIT);
+    if (!_buf) return false;
+
+    _rate = sampleRate;
+    _minMs = minMs;
+    _maxMs = maxMs;
+    _fill = 0;
+    _calm = 0;
+    memset(&_stats, 0, sizeof(_stats));
+    setTargetMs(startMs);
+    return true;
+}
+
+void UplinkPacketizer::setTargetMs(uint32_t ms) {
+    if (ms < _minMs) ms = _minMs;
+    if (ms > _maxMs) ms = _maxMs;
+    _targetMs = ms;
+    _target = (size_t)_rate * ms / 1000;
+    if (_target > _capacity) _target = _capacity;
+    if (_target == 0) _target = 1;
+}
+
+size_t UplinkPacketizer::append(const int16_t* pcm, size_t n) {
+    if (!_buf || _fill >= _target) return 0;
+    size_t take = _target - _fill;
+    if (take > n) take = n;
+    memcpy(_buf + _fill, pcm, take * sizeof(int16_t));
+    _fill += take;
+    return take;
+}
+
+void UplinkPacketizer::packetSent(uint32_t sendUs, bool ok) {
+    bool full = _fill >= _target;
+    uint32_t audioUs = (uint32_t)((uint64_t)_fill * 1000000 / (_rate ? _rate : 1));
+    _fill = 0;
+
+    _stats.packets++;
+    _stats.avgSendUs = (_stats.avgSendUs * 7 + sendUs) / 8;
+    if (sendUs > _stats.maxSendUs) _stats.maxSendUs = sendUs;
+
+    // A short flush says nothing about the link at this packet size
+    if (!full) return;
+
+    if (!ok || (uint64_t)sendUs * SLOW_SEND_DIV > audioUs) {
+        _calm = 0;
+        if (_targetMs < _maxMs) {
+            setTargetMs(_targetMs * 2);
+            _stats.grows++;
+        }
+    } else if ((uint64_t)sendUs * CHEAP_SEND_DIV < audioUs) {
+        if (++_calm >= CALM_PACKETS) {
+            _calm = 0;
+            if (_targetMs > _minMs) {
+                setTargetMs(_targetMs - _targetMs / 4);
+                _stats.shrinks++;
+            }
+        }
+    } else {
+        _calm = 0;
+    }
+}
+
+// Client frames are always masked: 2-byte header, extended length, 4-byte key
+static size_t webSocketFrameBytes(size_t payload) {
+    size_t header = 2 + 4;
+    if (payload > 65535) header += 8;
+    else if (payload > 125) header += 2;
+    return header + payload;
+}
+
+size_t UplinkPacketizer::tlsRecords(size_t payload) {
+    size_t frame = webSocketFrameBytes(payload);
+    return (frame + TLS_RECORD_PAYLOAD - 1) / TLS_RECORD_PAYLOAD;
+}
+
+size_t UplinkPacketizer::wireBytes(size_t payload) {
+    return webSocketFrameBytes(payload) + tlsRecords(payload) * TLS_RECORD_OVERHEAD;
+}
@@ -0,0 +1,77 @@
+#ifndef UPLINK_PACKETIZER_H
+#define UPLINK_PACKETIZER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// Coalesces capture frames into uplink packets of a target duration.
+//
+// Every append message costs JSON, WebSocket and TLS framing plus a TLS
+// encrypt and a TCP send, so ~10 ms frames are grouped into packets of
+// minMs..maxMs. The size adapts to how long sends take: a send that blocks
+// for more than a quarter of the audio it carries (slow link, full TCP
+// window) or fails doubles the packet; a long run of cheap sends shrinks
+// it back towards minMs, which keeps the added latency low when the link
+// allows it.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+struct PacketizerStats {
+    uint32_t packets;
+    uint32_t grows;
+    uint32_t shrinks;
+    uint32_t avgSendUs;     // Smoothed over recent packets
+    uint32_t maxSendUs;
+};
+
+class UplinkPacketizer {
+public:
+    UplinkPacketizer() {}
+    ~UplinkPacketizer();
+
+    bool begin(uint32_t sampleRate, uint32_t minMs, uint32_t maxMs, uint32_t startMs);
+    bool isReady() const { return _buf != nullptr; }
+
+    // Copies as much of pcm as fits in the current packet; returns samples taken.
+    // Call until everything is consumed, sending whenever packetReady().
+    size_t append(const int16_t* pcm, size_t n);
+
+    bool packetReady() const { return _buf && _fill >= _target; }
+    const int16_t* packet() const { return _buf; }
+    size_t packetSamples() const { return _fill; }
+
+    // The current packet went out (ok) or was refused, taking sendUs.
+    // Empties the packet; full packets also drive the size adaptation.
+    void packetSent(uint32_t sendUs, bool ok);
+
+    // Drop buffered audio (e.g. on reconnect)
+    void clear() { _fill = 0; }
+
+    uint32_t packetMs() const { return _targetMs; }
+    size_t maxPacketSamples() const { return _capacity; }
+    const PacketizerStats& stats() const { return _stats; }
+
+    // Estimated cost of one client text message with this payload size:
+    // masked WebSocket header plus TLS record framing
+    static size_t wireBytes(size_t payload);
+    static size_t tlsRecords(size_t payload);
+
+private:
+    int16_t* _buf = nullptr;
+    size_t _capacity = 0;
+    size_t _fill = 0;
+    size_t _target = 0;
+    uint32_t _rate = 0;
+    uint32_t _minMs = 0;
+    uint32_t _maxMs = 0;
+    uint32_t _targetMs = 0;
+    uint32_t _calm = 0;         // Cheap sends in a row
+    PacketizerStats _stats = {};
+
+    UplinkPacketizer(const UplinkPacketizer&) = delete;
+    UplinkPacketizer& operator=(const UplinkPacketizer&) = delete;
+
+    void setTargetMs(uint32_t ms);
+};
+
+#endif
@@ -0,0 +1,116 @@
+#include "VoiceActivityDetector.h"
+#include <math.h>
+#include <string.h>
+
+static const float NOISE_DOWN = 0.3f;      // Per frame, towards a quieter level
+static const float NOISE_UP = 0.01f;       // Per frame, towards a louder level
+static const float FLATNESS_MAX = 0.3f;      // Noise sits around 0.56
+
+bool VoiceActivityDetector::begin(uint32_t sampleRate) {
+    if (!_fft.begin(VAD_FRAME)) return false;
+
+    for (size_t i = 0; i < VAD_FRAME; i++) {
+        _window[i] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * i / VAD_FRAME);
+    }
+
+    float binHz = (float)sampleRate / VAD_FRAME;
+    _bandLo = (size_t)(300.0f / binHz + 0.5f);
+    _bandHi = (size_t)(4000.0f / binHz + 0.5f);
+    if (_bandLo < 1) _bandLo = 1;
+    if (_bandHi > VAD_FRAME / 2) _bandHi = VAD_FRAME / 2;
+    reset();
+    return true;
+}
+
+void VoiceActivityDetector::setNoiseFloorRms(float rms) {
+    _noiseDb = 20.0f * log10f(rms + 1.0f);
+
+    // White noise of that RMS through the Hann window
+    float power = rms * rms * VAD_FRAME * 0.375f;
+    for (size_t k = 0; k <= VAD_FRAME / 2; k++) _noiseSpec[k] = power;
+    _noiseKnown = true;
+}
+
+void VoiceActivityDetector::reset() {
+    _speech = false;
+    _run = 0;
+    _quiet = 0;
+}
+
+void VoiceActivityDetector::analyse(const int16_t* pcm, size_t n) {
+    if (n > VAD_FRAME) n = VAD_FRAME;
+
+    float energy = 0;
+    for (size_t i = 0; i < n; i++) {
+        float x = pcm[i];
+        energy += x * x;
+        _time[i] = x * _window[i];
+    }
+    for (size_t i = n; i < VAD_FRAME; i++) _time[i] = 0;
+    _fft.forward(_time, _spec);
+
+    // First frame ever: take it as the noise spectrum
+    if (!_noiseKnown) {
+        for (size_t k = 0; k <= VAD_FRAME / 2; k++) {
+            _noiseSpec[k] = _spec[2 * k] * _spec[2 * k] + _spec[2 * k + 1] * _spec[2 * k + 1];
+        }
+        _noiseKnown = true;
+    }
+
+    float band = 0, bandNoise = 0, ratioSum = 0, logSum = 0;
+    for (size_t k = _bandLo; k <= _bandHi; k++) {
+        float p = _spec[2 * k] * _spec[2 * k] + _spec[2 * k + 1] * _spec[2 * k + 1];
+        float r = (p + 1.0f) / (_noiseSpec[k] + 1.0f);
+        band += p;
+        bandNoise += _noiseSpec[k];
+        ratioSum += r;
+        logSum += logf(r);
+    }
+
+    size_t bins = _bandHi - _bandLo + 1;
+    VadFeatures& f = _features;
+    f.levelDb = 10.0f * log10f(energy / (n ? n : 1) + 1.0f);
+    f.snrDb = f.levelDb - _noiseDb;
+    f.bandSnrDb = 10.0f * log10f((band + 1.0f) / (bandNoise + 1.0f));
+    f.flatness = expf(logSum / bins) / (ratioSum / bins);
+    f.speechLike = f.snrDb > _thresholdDb && f.bandSnrDb > _thresholdDb &&
+                   f.flatness < FLATNESS_MAX;
+}
+
+// Fast down, slow up; called on frames that do not look like speech
+void VoiceActivityDetector::trackNoise() {
+    float rate = _features.levelDb < _noiseDb ? NOISE_DOWN : NOISE_UP;
+    _noiseDb += rate * (_features.levelDb - _noiseDb);
+
+    for (size_t k = 0; k <= VAD_FRAME / 2; k++) {
+        float p = _spec[2 * k] * _spec[2 * k] + _spec[2 * k + 1] * _spec[2 * k + 1];
+        float r = p < _noiseSpec[k] ? NOISE_DOWN : NOISE_UP;
+        _noiseSpec[k] += r * (p - _noiseSpec[k]);
+    }
+}
+
+bool VoiceActivityDetector::process(const int16_t* pcm, size_t n) {
+    if (n == 0) return _speech;
+    analyse(pcm, n);
+    _frames++;
+
+    const VadFeatures& f = _features;
+    if (!f.speechLike) trackNoise();
+
+    if (f.speechLike) {
+        _quiet = 0;
+        if (!_speech && ++_run >= _onsetFrames) {
+            _speech = true;
+            if (_startCallback) _startCallback();
+        }
+    } else {
+        _run = 0;
+        if (_speech && ++_quiet > _hangoverFrames) {
+            _speech = false;
+            if (_stopCallback) _stopCallback();
+        }
+    }
+
+    if (_speech) _speechFrames++;
+    return _speech;
+}
@@ -0,0 +1,89 @@
+#ifndef VOICE_ACTIVITY_DETECTOR_H
+#define VOICE_ACTIVITY_DETECTOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <functional>
+#include "AudioFft.h"
+
+// Frame-level voice activity detector for gating the uplink.
+//
+// Per frame (up to VAD_FRAME samples) it looks at:
+//   - level over an adaptive noise floor (fast down, slow up, frozen in speech)
+//   - SNR in the speech band (300 Hz - 4 kHz) against a per-bin noise spectrum
+//   - flatness of that per-bin SNR: stationary noise of any colour divides out
+//     to a flat ratio, voiced speech leaves harmonic peaks
+// A frame is speech-like when all three agree. Speech starts after
+// onsetFrames speech-like frames in a row and ends after hangoverFrames
+// without one.
+//
+// No Arduino dependencies, so it also builds in the native test env.
+
+static const size_t VAD_FRAME = 256;
+
+struct VadFeatures {
+    float levelDb;      // Frame RMS, dBFS-ish (20 log10 rms)
+    float snrDb;        // Over the tracked noise floor
+    float bandSnrDb;    // Speech band over the noise spectrum
+    float flatness;     // Flatness of the per-bin SNR in the band, 0..1
+    bool speechLike;
+};
+
+class VoiceActivityDetector {
+public:
+    bool begin(uint32_t sampleRate);
+
+    // Returns true while speech is active (including hangover)
+    bool process(const int16_t* pcm, size_t n);
+    bool isSpeech() const { return _speech; }
+    const VadFeatures& lastFeatures() const { return _features; }
+
+    void onSpeechStart(std::function<void()> callback) { _startCallback = callback; }
+    void onSpeechStop(std::function<void()> callback) { _stopCallback = callback; }
+
+    // Tuning
+    void setThresholdDb(float db) { _thresholdDb = db; }
+    void setOnsetFrames(uint16_t frames) { _onsetFrames = frames; }
+    void setHangoverFrames(uint16_t frames) { _hangoverFrames = frames; }
+
+    // Seed the noise floor (e.g. from calibration) instead of learning it
+    void setNoiseFloorRms(float rms);
+    float noiseFloorDb() const { return _noiseDb; }
+
+    // Back to silence without firing onSpeechStop (e.g. after TTS)
+    void reset();
+
+    uint32_t framesProcessed() const { return _frames; }
+    uint32_t speechFrames() const { return _speechFrames; }
+
+private:
+    RealFft _fft;
+    float _window[VAD_FRAME];
+    float _time[VAD_FRAME];
+    float _spec[VAD_FRAME + 2];
+    float _noiseSpec[VAD_FRAME / 2 + 1];
+    bool _noiseKnown = false;
+    size_t _bandLo = 0;
+    size_t _bandHi = 0;
+
+    float _thresholdDb = 9.0f;
+    uint16_t _onsetFrames = 2;
+    uint16_t _hangoverFrames = 30;
+
+    float _noiseDb = 40.0f;     // Learned quickly on the first quiet frames
+    bool _speech = false;
+    uint16_t _run = 0;          // Consecutive speech-like frames (onset)
+    uint16_t _quiet = 0;        // Consecutive non-speech frames (hangover)
+    VadFeatures _features = {};
+
+    uint32_t _frames = 0;
+    uint32_t _speechFrames = 0;
+
+    std::function<void()> _startCallback;
+    std::function<void()> _stopCallback;
+
+    void analyse(const int16_t* pcm, size_t n);
+    void trackNoise();
+};
+
+#endif
@@ -1,6 +1,7 @@
 #include <Arduino.h>
 #include "BoardConfig.h"
 #include "AudioRingBuffer.h"
+#include "AudioDsp.h"
 
 // Disable brownout detector
 #include "soc/soc.h"
@@ -9,12 +10,20 @@
 #include <FastLED.h>
 #include <driver/i2s.h>
 #include <esp_wifi.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
 #include "ConfigManager.h"
 #include "AudioManager.h"
 #include "LedManager.h"
 #include "TranscriptionClient.h"
 #include "LLMClient.h"
 #include "ElevenLabsStreamClient.h"
+#include "UplinkGate.h"
+#include "SessionPreroll.h"
+#include "Resampler.h"
+#include "PartialTranscript.h"
+#include "SpeculativeRequest.h"
+#include "SentenceSegmenter.h"
 
 
 // ===========================================================================
@@ -25,11 +34,25 @@ AudioManager audioManager;
 TranscriptionClient* transcriptionClient = NULL;
 LLMClient* llmClient = NULL;
 ElevenLabsStreamClient* ttsClient = NULL;
-
-// Buffers - PCM 16kHz 16bit = 32KB/s
-// PSRAM: 3MB buffer = ~90s | Internal: 128KB = 4s
+UplinkGate* uplinkGate = NULL;
+SessionPreroll* sessionPreroll = NULL;
+
+// Rate converters between stages (see BoardConfig.h); compiled out when
+// the rates match
+#if TTS_SAMPLE_RATE != AUDIO_SAMPLE_RATE
+Resampler ttsResampler;
+#endif
+#if UPLINK_SAMPLE_RATE != CAPTURE_SAMPLE_RATE
+Resampler uplinkResampler;
+#endif
+
+// Buffers - PCM 24kHz 16bit = 48KB/s
+// PSRAM: 2MB buffer = ~43s | Internal: 128KB = 2.7s
+// Lock-free SPSC ring: capacity must be a power of two
 AudioRingBuffer* playbackBuffer = NULL;
-const size_t PLAYBACK_BUF_SIZE = 3 * 1024 * 1024;  // 3MB in PSRAM (4MB limit)
+const size_t PLAYBACK_BUF_SIZE = 2 * 1024 * 1024;  // 2MB in PSRAM (4MB limit)
+const size_t PLAYBACK_START_BYTES = 20 * 1024;      // Pre-buffer before playback starts
+const size_t PLAYBACK_HOT_SIZE = 16 * 1024;         // Internal DRAM window feeding I2S
 
 // Anti-echo cooldown
 unsigned long cooldownUntil = 0;
@@ -46,6 +69,38 @@ AppState currentState = STATE_IDLE;
 volatile bool isSpeaking = false;
 String pendingText = "";
 bool hasTranscription = false;
+unsigned long turnEndMs = 0;    // Playback finished, transcription not yet confirmed ready
+
+// Milestones of the current turn (millis(); 0 = not reached)
+struct TurnTiming {
+    unsigned long startMs;          // Final transcript
+    unsigned long llmFirstTokenMs;
+    unsigned long firstSegmentMs;   // First text handed to TTS
+    unsigned long ttsFirstByteMs;
+    unsigned long firstAudioMs;     // First chunk queued to I2S
+    unsigned long llmDoneMs;
+    unsigned long ttsDoneMs;
+    unsigned long playbackDoneMs;
+};
+TurnTiming turnTiming = {};
+
+#if LLM_STREAMING_TTS
+// LLM deltas -> segmenter -> queue -> TTS task -> playback ring
+SentenceSegmenter segmenter;
+QueueHandle_t ttsQueue = NULL;          // String*, NULL ends the answer
+SemaphoreHandle_t ttsDone = NULL;
+bool streamingTurn = false;             // Deltas belong to the answer being spoken
+bool ttsStarted = false;
+uint32_t ttsSegmentsOk = 0;
+uint32_t ttsSegmentsFailed = 0;
+#endif
+
+#if LLM_SPECULATIVE_ENABLED
+// Deltas of the utterance being transcribed, and the LLM request started
+// on them (active while one is outstanding)
+PartialTranscript partialTranscript;
+SpeculativeRequest<LLMClient> speculation;
+#endif
 
 // Button state
 KorvoButton lastBtn = BTN_NONE;
@@ -87,54 +142,325 @@ void playAudio() {
     if (!playbackBuffer) return;
 
     Serial.println("[Play] Start streaming");
+    playbackBuffer->psramBytesPerSecond();  // Reset rate window
+    uint32_t accessesAtStart = playbackBuffer->psramAccesses();
     
-    uint8_t buf[2048];
-    unsigned long startTime = millis();
-    bool buffering = true;
-
-    while (isSpeaking || playbackBuffer->available() > 0) {
-        size_t avail = playbackBuffer->available();
-        
-        // Initial buffering to prevent stutter (need at least 20KB to start)
-        if (buffering && avail < 20 * 1024 && isSpeaking) {
-            delay(10);
-            if (millis() - startTime > 5000) buffering = false; // Safety timeout
-            continue;
-        }
-        buffering = false;
-
-        if (avail == 0) {
-            if (!isSpeaking) break;
-            delay(5);
+    const size_t CHUNK = 2048;
+
+    // Initial buffering to prevent stutter: wake exactly when the high
+    // watermark is reached or the download ends (5s safety timeout)
+    playbackBuffer->waitForHighWater(pdMS_TO_TICKS(5000));
+
+    // When the next chunk handed to I2S will start playing (AEC reference)
+    int64_t nextPlayUs = 0;
+
+#if TTS_SAMPLE_RATE != AUDIO_SAMPLE_RATE
+    static int16_t converted[CHUNK / 2 * AUDIO_SAMPLE_RATE / TTS_SAMPLE_RATE + 2];
+    ttsResampler.reset();
+#endif
+
+    while (true) {
+        // Zero-copy: hand the ring buffer region straight to I2S
+        AudioRingBuffer::Span span = playbackBuffer->acquireRead(CHUNK);
+        span.len &= ~(size_t)1;  // Whole samples only: keeps the read side 16-bit aligned
+        if (span.len == 0) {
+            if (playbackBuffer->available() == 1) {
+                // Half a sample: wait for its other byte, or drop it at the end
+                if (playbackBuffer->isEndOfStream()) {
+                    playbackBuffer->commitRead(1);
+                    break;
+                }
+                delay(1);
+                continue;
+            }
+            // Underrun: sleep until the producer publishes more data
+            if (!playbackBuffer->waitForData(pdMS_TO_TICKS(100)) &&
+                playbackBuffer->isEndOfStream()) break;
             continue;
         }
 
-        size_t toRead = (avail > sizeof(buf)) ? sizeof(buf) : avail;
-        playbackBuffer->read(buf, toRead);
-
-        // Calculate audio level for LED animation
-        int16_t* samples = (int16_t*)buf;
-        size_t sampleCount = toRead / 2;
-        int16_t maxVal = 0;
-        for (size_t i = 0; i < sampleCount; i += 8) { // Optimized check
-            int16_t val = abs(samples[i]);
-            if (val > maxVal) maxVal = val;
-        }
-        uint8_t ledLevel = map(constrain(maxVal, 0, 15000), 0, 15000, 0, 255);
+        // TTS at another rate goes through the converter; otherwise zero-copy
+        const int16_t* pcm = (const int16_t*)span.data;
+        size_t bytes = span.len;
+#if TTS_SAMPLE_RATE != AUDIO_SAMPLE_RATE
+        bytes = ttsResampler.process(pcm, span.len / 2, converted) * 2;
+        pcm = converted;
+#endif
+
+        // Calculate audio level for LED animation (peak + RMS in one pass)
+        AudioDsp::Level level = AudioDsp::measureLevel(pcm, bytes / 2);
+        uint8_t ledLevel = map(constrain((int)level.peak, 0, 15000), 0, 15000, 0, 255);
         ledManager.setAudioLevel(ledLevel);
         ledManager.loop();
 
+        // Idle or underrun: the DMA was playing silence, so this chunk
+        // starts (at the earliest) now
+        int64_t now = esp_timer_get_time();
+        if (nextPlayUs < now) nextPlayUs = now;
+
+        // Blocks until all of it is queued
         size_t written = 0;
-        i2s_write(I2S_NUM_0, buf, toRead, &written, portMAX_DELAY);
+        if (!turnTiming.firstAudioMs) turnTiming.firstAudioMs = millis();
+        i2s_write(I2S_NUM_0, pcm, bytes, &written, portMAX_DELAY);
+        audioManager.pushEchoReference(pcm, written / 2, nextPlayUs);
+        nextPlayUs += (int64_t)(written / 2) * 1000000 / AUDIO_SAMPLE_RATE;
+        playbackBuffer->commitRead(span.len);
     }
 
     // Flush
     delay(200);
-    memset(buf, 0, sizeof(buf));
+    static const uint8_t silence[CHUNK] = {0};
     size_t w = 0;
-    i2s_write(I2S_NUM_0, buf, sizeof(buf), &w, 100);
+    i2s_write(I2S_NUM_0, silence, sizeof(silence), &w, 100);
+
+    Serial.printf("[Play] Done (PSRAM %u B/s, %u accesses%s)\n",
+                  playbackBuffer->psramBytesPerSecond(),
+                  playbackBuffer->psramAccesses() - accessesAtStart,
+                  playbackBuffer->isTiered() ? ", tiered" : "");
+#if TTS_SAMPLE_RATE != AUDIO_SAMPLE_RATE
+    Serial.printf("[SRC] TTS %d -> %d Hz: %.0f cycles/sample\n", TTS_SAMPLE_RATE, AUDIO_SAMPLE_RATE,
+                  ttsResampler.cyclesPerOutputSample());
+#endif
+}
+
+// ===========================================================================
+// Uplink - consumes frames produced by the capture task
+// ===========================================================================
+// Captured PCM to the transcription session, at the rate it expects
+void sendUplink(const int16_t* pcm, size_t samples) {
+    if (!transcriptionClient || !transcriptionClient->isConnected()) return;
+#if UPLINK_SAMPLE_RATE != CAPTURE_SAMPLE_RATE
+    static int16_t converted[CAPTURE_FRAME_SAMPLES * UPLINK_SAMPLE_RATE / CAPTURE_SAMPLE_RATE + 2];
+    samples = uplinkResampler.process(pcm, samples, converted);
+    pcm = converted;
+#endif
+    transcriptionClient->sendAudio((uint8_t*)pcm, samples * 2);
+}
 
-    Serial.println("[Play] Done");
+// Frames for the session go through the pre-roll, which holds them until
+// the session is ready
+void deliverUplink(const CaptureFrame& f) {
+    if (sessionPreroll) {
+        sessionPreroll->process(f, transcriptionClient && transcriptionClient->isReady());
+    } else {
+        sendUplink(f.pcm, f.samples);
+    }
+}
+
+void pumpUplink() {
+    CaptureFrameRing* ring = audioManager.captureRing();
+    if (!ring) return;
+
+    // Replay as soon as the session is ready, even if nobody is talking now
+    if (sessionPreroll && sessionPreroll->pending() && transcriptionClient && transcriptionClient->isReady()) {
+        sessionPreroll->flush();
+    }
+
+    // Bounded per call so loop() keeps servicing the socket and LEDs
+    for (int i = 0; i < 8; i++) {
+        const CaptureFrame* f = ring->peek();
+        if (!f) break;
+
+        // Frames captured during the anti-echo cooldown are discarded
+        if (millis() >= cooldownUntil) {
+            if (uplinkGate) {
+                uplinkGate->process(*f);  // Sends only around detected speech
+            } else {
+                deliverUplink(*f);
+            }
+        }
+        ring->pop();
+    }
+}
+
+#if LLM_SPECULATIVE_ENABLED
+// ===========================================================================
+// Speculative LLM - started on the partial transcript, polled from loop()
+// ===========================================================================
+void serviceSpeculation() {
+    if (speculation.active()) {
+        // A dead request is dropped so a later partial can try again
+        if (!speculation.service()) Serial.println("[Spec] Request failed, dropped");
+        return;
+    }
+    if (currentState == STATE_PROCESSING || currentState == STATE_SPEAKING) return;
+    if (!partialTranscript.isStable(millis(), LLM_SPECULATIVE_QUIET_MS)) return;
+
+    bool started = speculation.start(partialTranscript.text(), millis());
+    partialTranscript.reset();  // One attempt per settled partial
+    if (started) Serial.printf("[Spec] LLM started on partial: %s\n", speculation.text());
+}
+#endif
+
+// Starts the LLM on the final transcript, or keeps the speculative request
+// if it asked the same thing and is still alive. False if none is running.
+bool askLLM(const String& finalText) {
+#if LLM_SPECULATIVE_ENABLED
+    String spec = speculation.text();
+    bool running = speculation.ask(finalText.c_str());
+    partialTranscript.reset();
+    switch (speculation.outcome()) {
+        case SpeculativeRequest<LLMClient>::HIT:
+            Serial.printf("[Spec] Hit, %lu ms head start (%u hits, %u misses, %u failed)\n",
+                          millis() - speculation.startMs(), speculation.hits(),
+                          speculation.misses(), speculation.failed());
+            break;
+        case SpeculativeRequest<LLMClient>::MISS:
+            Serial.println("[Spec] Miss, cancelled: " + spec);
+            break;
+        case SpeculativeRequest<LLMClient>::DEAD:
+            Serial.println("[Spec] Request had failed, asking again");
+            break;
+        default:
+            break;
+    }
+    return running;
+#else
+    return llmClient->startChat(finalText);
+#endif
+}
+
+// ===========================================================================
+// Speaking - shared by the whole-reply and streaming paths
+// ===========================================================================
+// Mic/session handling for the answer, then start the player
+void beginSpeaking() {
+    isSpeaking = true;
+    currentState = STATE_SPEAKING;
+    ledManager.setState(LED_SPEAKING);
+
+    if (audioManager.aecEnabled()) {
+        // Mic stays open: the echo canceller keeps adapting to the speaker
+        // while nothing is queued for upload. Hold the beam still so the
+        // echo path does not jump under the canceller.
+        audioManager.setUplinkPaused(true);
+        audioManager.beamformer().steer(audioManager.beamformer().direction());
+    } else {
+        // Stop mic BEFORE TTS
+        audioManager.stopMic();
+#if !TRANSCRIPTION_KEEP_SESSION
+        if (transcriptionClient) {
+            transcriptionClient->disconnect();
+        }
+#endif
+    }
+
+    // Clear buffer (also resets end-of-stream and watermark events)
+    playbackBuffer->clear();
+
+    // Task to play audio while it downloads
+    xTaskCreate([](void* p) {
+        playAudio();
+        vTaskDelete(NULL);
+    }, "play_task", 4096, NULL, 5, NULL);
+}
+
+#if LLM_STREAMING_TTS
+// Downloads each queued segment into the playback ring, in order
+void ttsTask(void* param) {
+    String previous = "";
+    String* segment = NULL;
+    while (xQueueReceive(ttsQueue, &segment, portMAX_DELAY) == pdTRUE && segment) {
+        if (ttsClient->speak(*segment, playbackBuffer, previous)) {
+            ttsSegmentsOk++;
+        } else {
+            ttsSegmentsFailed++;
+            Serial.println("[TTS] Segment failed: " + ttsClient->getLastError());
+        }
+        previous = *segment;
+        delete segment;
+    }
+    xSemaphoreGive(ttsDone);
+    vTaskDelete(NULL);
+}
+
+// Segmenter output: the first segment starts playback and the TTS task
+void queueSegment(const char* text, size_t len) {
+    if (!ttsStarted) {
+        turnTiming.firstSegmentMs = millis();
+        ttsStarted = true;
+        beginSpeaking();
+        // TLS handshakes need a deep stack
+        xTaskCreate(ttsTask, "tts_task", 8192, NULL, 5, NULL);
+    }
+    Serial.printf("[TTS] Segment %u: %s\n", segmenter.segments(), text);
+    String* segment = new String(text);
+    xQueueSend(ttsQueue, &segment, portMAX_DELAY);
+}
+
+// LLM reply streamed into TTS segment by segment. Returns false if any
+// segment failed; ttsStarted tells whether anything was said at all.
+bool streamAnswer(const String& text) {
+    segmenter.reset();
+    ttsStarted = false;
+    ttsSegmentsOk = 0;
+    ttsSegmentsFailed = 0;
+
+    if (!askLLM(text)) return false;
+    if (llmClient->responseSoFar().length() > 0) {
+        // Text that arrived while speculating
+        if (!turnTiming.llmFirstTokenMs) turnTiming.llmFirstTokenMs = millis();
+        segmenter.push(llmClient->responseSoFar().c_str());
+    }
+
+    streamingTurn = true;
+    while (llmClient->poll()) {
+        delay(1);
+    }
+    String response = llmClient->finishChat();
+    streamingTurn = false;
+    turnTiming.llmDoneMs = millis();
+
+    segmenter.flush();
+    if (!ttsStarted) return false;
+    Serial.println("[AI] " + response);
+
+    // End of the answer: wait for the last segment's download
+    String* end = NULL;
+    xQueueSend(ttsQueue, &end, portMAX_DELAY);
+    xSemaphoreTake(ttsDone, portMAX_DELAY);
+    return ttsSegmentsFailed == 0;
+}
+#endif
+
+#if HTTP_PREWARM_ON_SPEECH
+volatile bool prewarming = false;
+
+// Open the LLM and TTS connections while the user is still talking
+void prewarmConnections() {
+    if (prewarming || !llmClient || !ttsClient) return;
+    prewarming = true;
+    xTaskCreate([](void* p) {
+        llmClient->prewarm();
+        ttsClient->prewarm();
+        prewarming = false;
+        vTaskDelete(NULL);
+    }, "prewarm_task", 8192, NULL, 1, NULL);
+}
+#endif
+
+// Connection counters at the end of the previous turn
+ConnectionStats llmConnLast = {};
+ConnectionStats ttsConnLast = {};
+
+void logConnection(const char* name, const ConnectionStats& now, ConnectionStats& last) {
+    uint32_t handshakes = now.handshakes - last.handshakes;
+    Serial.printf("[HTTP] %s: %u handshakes (%u ms, last %u ms), %u reused, %u stale, %u failed\n",
+                  name, handshakes, now.handshakeMs - last.handshakeMs, handshakes ? now.lastHandshakeMs : 0,
+                  now.reuses - last.reuses, now.staleRetries - last.staleRetries, now.failures - last.failures);
+    last = now;
+}
+
+void logTurnTiming() {
+    const TurnTiming& t = turnTiming;
+    auto since = [&](unsigned long ms) -> long { return ms ? (long)(ms - t.startMs) : -1; };
+    Serial.printf("[Turn] ms after final transcript: LLM first token %ld, first segment %ld, TTS first byte %ld, "
+                  "first audio %ld | LLM done %ld, TTS done %ld, playback done %ld\n",
+                  since(t.llmFirstTokenMs), since(t.firstSegmentMs), since(t.ttsFirstByteMs),
+                  since(t.firstAudioMs), since(t.llmDoneMs), since(t.ttsDoneMs), since(t.playbackDoneMs));
+#if LLM_STREAMING_TTS
+    Serial.printf("[Turn] %u segments, %u failed\n", ttsSegmentsOk + ttsSegmentsFailed, ttsSegmentsFailed);
+#endif
 }
 
 // ===========================================================================
@@ -150,65 +476,159 @@ void processPipeline(String text) {
     Serial.println("[User] " + text);
     currentState = STATE_PROCESSING;
     ledManager.setState(LED_PROCESSING);
-
+    // loop() is blocked until the answer is done: nothing drains the capture
+    // ring, so stop queueing rather than count the overrun as drops
+    audioManager.setUplinkPaused(true);
+    memset(&turnTiming, 0, sizeof(turnTiming));
+    turnTiming.startMs = millis();
+
+#if LLM_STREAMING_TTS
+    bool ok = streamAnswer(text);
+    if (!ttsStarted) {
+#else
     // Get LLM response
-    String response = llmClient->chat(text);
+    String response;
+    if (askLLM(text)) response = llmClient->finishChat();
+    turnTiming.llmDoneMs = millis();
     if (response.length() == 0) {
+#endif
         Serial.println("[LLM] No response");
+        audioManager.setUplinkPaused(false);
+        if (audioManager.captureRing()) audioManager.captureRing()->discardAll();
         currentState = STATE_IDLE;
         ledManager.setState(LED_IDLE);
         return;
     }
 
+#if !LLM_STREAMING_TTS
     Serial.println("[AI] " + response);
-
-    // Prepare for TTS
-    isSpeaking = true;
-    currentState = STATE_SPEAKING;
-    ledManager.setState(LED_SPEAKING);
-
-    // Stop mic and disconnect WebSocket BEFORE TTS
-    audioManager.stopMic();
-    if (transcriptionClient) {
-        transcriptionClient->disconnect();
-    }
-
-    // Clear buffer
-    playbackBuffer->clear();
-
-    // Task to play audio while it downloads
-    xTaskCreate([](void* p) {
-        playAudio();
-        vTaskDelete(NULL);
-    }, "play_task", 4096, NULL, 5, NULL);
+    beginSpeaking();
 
     // Stream TTS to buffer (now non-blocking to the player task)
     bool ok = ttsClient->speak(response, playbackBuffer);
-    
+#endif
+    turnTiming.ttsDoneMs = millis();
+
     // Signal end of download
+    playbackBuffer->markEndOfStream();
     isSpeaking = false;
 
     if (!ok) {
         Serial.println("[TTS] Failed");
     }
 
-    // Wait for playback task to finish (isSpeaking is false, buffer will drain)
-    while (playbackBuffer->available() > 0) {
-        delay(50); // Check faster
-    }
+    // Wait for the player to consume the last byte (woken by the ring)
+    playbackBuffer->waitForDrain(pdMS_TO_TICKS(60000));
+    turnTiming.playbackDoneMs = millis();
 
     // Quick Cleanup
     delay(50); // Minimal settling time for speaker
-    cooldownUntil = millis() + COOLDOWN_MS;
     pendingText = "";
     hasTranscription = false;
 
-    // Reconnect transcription IMMEDIATELY
-    audioManager.startMic();
+#if TRANSCRIPTION_KEEP_SESSION
+    // The session stayed open: drop anything buffered around the answer
+    if (transcriptionClient) transcriptionClient->clearAudio();
+#endif
+    turnEndMs = millis();
+
+    bool aec = audioManager.aecEnabled();
+    if (aec) {
+        // Residual room echo is cancelled too: no cooldown, no reconnect
+        audioManager.beamformer().steer(-1);
+        audioManager.setUplinkPaused(false);
+        if (audioManager.captureRing()) audioManager.captureRing()->discardAll();
+    } else {
+        cooldownUntil = millis() + COOLDOWN_MS;
+        audioManager.setUplinkPaused(false);
+        audioManager.startMic();
+        if (audioManager.captureRing()) audioManager.captureRing()->discardAll();  // Stale pre-TTS audio
+    }
+
+    logTurnTiming();
+    logConnection("LLM", llmClient->connectionStats(), llmConnLast);
+    logConnection("TTS", ttsClient->connectionStats(), ttsConnLast);
+    // Speculative requests that were dropped count too
+    static uint32_t uploadedLast = 0;
+    Serial.printf("[LLM] Uploaded %u B this turn\n", llmClient->uploadedBytes() - uploadedLast);
+    uploadedLast = llmClient->uploadedBytes();
+    const StreamStats& ls = llmClient->streamStats();
+    if (ls.events > 0) {
+        if (ls.chained) {
+            Serial.printf("[LLM] Request: %u B, chained on the stored response\n", ls.requestBytes);
+        } else {
+            Serial.printf("[LLM] Request: %u B%s, history %u messages, ~%u tokens\n", ls.requestBytes,
+                          ls.chainLost ? " (chain lost, resent)" : "", ls.historyMessages, ls.historyTokens);
+        }
+        Serial.printf("[LLM] Stream: %u B, %u events (%u parsed, %u skipped, %u errors), %u cycles/event\n",
+                      ls.bodyBytes, ls.events, ls.parsed, ls.skipped, ls.parseErrors, ls.cycles / ls.events);
+    }
+    CaptureStats cs = audioManager.captureStats();
+    Serial.printf("[Capture] frames=%u ringDrops=%u dmaOverflows=%u beam=%d deg (max %u cycles/frame)\n",
+                  cs.framesCaptured, cs.framesDropped, cs.dmaOverflows,
+                  cs.beamDegrees, cs.beamMaxCycles);
+    if (!audioManager.captureResampler().isPassthrough()) {
+        Serial.printf("[SRC] Capture %d -> %d Hz: %.0f cycles/sample\n", AUDIO_SAMPLE_RATE, CAPTURE_SAMPLE_RATE,
+                      audioManager.captureResampler().cyclesPerOutputSample());
+    }
+#if UPLINK_SAMPLE_RATE != CAPTURE_SAMPLE_RATE
+    Serial.printf("[SRC] Uplink %d -> %d Hz: %.0f cycles/sample\n", CAPTURE_SAMPLE_RATE, UPLINK_SAMPLE_RATE,
+                  uplinkResampler.cyclesPerOutputSample());
+#endif
+#if AGC_ENABLED
+    Serial.printf("[AGC] PGA %.1f dB, digital %.1f dB, speech %.1f dBFS, noise %.1f dBFS, clipped frames %u, saturated %u\n",
+                  cs.agc.pgaDb, cs.agc.digitalGainDb, cs.agc.speechLevelDb, cs.agc.noiseFloorDb,
+                  cs.agc.clippedFrames, cs.agc.saturatedSamples);
+#endif
+#if NS_ENABLED
+    // One capture frame of CPU time on the capture core
+    uint32_t frameBudget = getCpuFrequencyMhz() * (uint32_t)(CAPTURE_FRAME_SAMPLES * 1000000ULL / AUDIO_SAMPLE_RATE);
+    Serial.printf("[NS] gain %.1f dB, %u cycles/frame (max %u, %.1f%% of budget)\n",
+                  cs.nsGainDb, cs.nsLastCycles, cs.nsMaxCycles, 100.0f * cs.nsMaxCycles / frameBudget);
+#endif
     if (transcriptionClient) {
-        // If already connected, this is a no-op or quick reset
+        // Rates per second of audio sent, so VAD-suppressed silence doesn't dilute them
+        const UplinkStats& up = transcriptionClient->uplinkStats();
+        const PacketizerStats& ps = transcriptionClient->packetizer().stats();
+        float audioSec = (float)up.samples / UPLINK_SAMPLE_RATE;
+        if (audioSec > 0) {
+            Serial.printf("[Uplink] packet %u ms (%u up, %u down): %.1f msg/s, %.1f TLS records/s, %.1f KB/s on wire for %.1f KB/s audio; send avg %u us, max %u us, %u failed\n",
+                          transcriptionClient->packetizer().packetMs(), ps.grows, ps.shrinks,
+                          up.messages / audioSec, up.tlsRecords / audioSec,
+                          up.wireBytes / audioSec / 1024, up.audioBytes / audioSec / 1024,
+                          ps.avgSendUs, ps.maxSendUs, up.failures);
+        }
+        const SessionStats& ss = transcriptionClient->sessionStats();
+        Serial.printf("[WS] Session: %u connects, %u drops, %u clears; last connect ready in %u ms\n",
+                      ss.connects, ss.disconnects, ss.clears, ss.lastTimeToReadyMs);
+        const EventStats& ev = transcriptionClient->eventStats();
+        Serial.printf("[WS] %u events, %u skipped unparsed, %u parse errors; parse %u us (max %u us)\n",
+                      ev.events, ev.skipped, ev.parseErrors, ev.lastParseUs, ev.maxParseUs);
+        // Steady state should leave the internal heap untouched turn after turn
+        Serial.printf("[Uplink] heap %u free, largest block %u\n",
+                      heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+                      heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    }
+    if (uplinkGate) {
+        uplinkGate->reset();  // Pre-roll is from before the answer
+        Serial.printf("[VAD] %.1f%% of captured audio suppressed\n", uplinkGate->suppressedPercent());
+    }
+    if (sessionPreroll) {
+        sessionPreroll->reset();
+        Serial.printf("[Preroll] %u frames replayed after connect, %u lost, %u duplicates skipped\n",
+                      sessionPreroll->framesReplayed(), sessionPreroll->framesLost(),
+                      sessionPreroll->duplicatesSkipped());
+    }
+    if (aec) {
+        Serial.printf("[AEC] ERLE %.1f dB, double-talk blocks %u, max %u cycles/block\n",
+                      cs.aecErleDb, cs.aecDoubleTalkBlocks, cs.aecMaxCycles);
+    }
+#if !TRANSCRIPTION_KEEP_SESSION
+    else if (transcriptionClient) {
+        // Reconnect transcription IMMEDIATELY
         transcriptionClient->connect();
     }
+#endif
 
     currentState = STATE_IDLE;
     ledManager.setState(LED_IDLE);
@@ -239,6 +659,12 @@ void setup() {
         Serial.println("Audio fail!");
         while (1) delay(1000);
     }
+#if TTS_SAMPLE_RATE != AUDIO_SAMPLE_RATE
+    if (!ttsResampler.begin(TTS_SAMPLE_RATE, AUDIO_SAMPLE_RATE)) Serial.println("[SRC] TTS resampler fail");
+#endif
+#if UPLINK_SAMPLE_RATE != CAPTURE_SAMPLE_RATE
+    if (!uplinkResampler.begin(CAPTURE_SAMPLE_RATE, UPLINK_SAMPLE_RATE)) Serial.println("[SRC] Uplink resampler fail");
+#endif
 
     // WiFi setup
     WiFi.mode(WIFI_STA);
@@ -260,6 +686,9 @@ void setup() {
 
     transcriptionClient = new TranscriptionClient(openaiKey);
     llmClient = new LLMClient(openaiKey);
+#if LLM_SPECULATIVE_ENABLED
+    speculation.setClient(llmClient);
+#endif
     ttsClient = new ElevenLabsStreamClient(elevenKey, voiceId);
 
     llmClient->setSystemPrompt(
@@ -269,7 +698,26 @@ void setup() {
     );
     llmClient->setMaxTokens(150);
 
+    // Timing milestones
+    llmClient->onTextDelta([](const char* delta) {
+        if (!turnTiming.llmFirstTokenMs && turnTiming.startMs) turnTiming.llmFirstTokenMs = millis();
+#if LLM_STREAMING_TTS
+        if (streamingTurn) segmenter.push(delta);
+#endif
+    });
+    ttsClient->onAudioStart([]() {
+        if (!turnTiming.ttsFirstByteMs) turnTiming.ttsFirstByteMs = millis();
+    });
+
+#if LLM_STREAMING_TTS
+    ttsQueue = xQueueCreate(TTS_SEGMENT_QUEUE, sizeof(String*));
+    ttsDone = xSemaphoreCreateBinary();
+    segmenter.setSink(queueSegment);
+#endif
+
     playbackBuffer = new AudioRingBuffer(PLAYBACK_BUF_SIZE);
+    playbackBuffer->setWatermarks(PLAYBACK_START_BYTES, playbackBuffer->capacity() / 2);
+    playbackBuffer->enableHotTier(PLAYBACK_HOT_SIZE);
     if (playbackBuffer->isAllocated()) {
         Serial.printf("Playback buffer: %d KB allocated\n", PLAYBACK_BUF_SIZE / 1024);
     } else {
@@ -286,18 +734,69 @@ void setup() {
         hasTranscription = true;
     });
 
+#if LLM_SPECULATIVE_ENABLED
+    transcriptionClient->onTranscriptionDelta([](String delta) {
+        if (isSpeaking || millis() < cooldownUntil) return;
+        partialTranscript.append(delta.c_str(), millis());
+    });
+#endif
+
     transcriptionClient->onSpeechStarted([]() {
         if (isSpeaking || millis() < cooldownUntil || currentState != STATE_IDLE) return;
         currentState = STATE_LISTENING;
+#if HTTP_PREWARM_ON_SPEECH
+        prewarmConnections();
+#endif
     });
 
     transcriptionClient->onSpeechStopped([]() {
         if (isSpeaking || millis() < cooldownUntil) return;
     });
 
-    // Calibrate and connect
-    delay(500);
-    audioManager.calibrateNoise(20);
+    sessionPreroll = new SessionPreroll(SESSION_PREROLL_FRAMES);
+    if (sessionPreroll->isAllocated()) {
+        sessionPreroll->setSink([](const CaptureFrame& f) { sendUplink(f.pcm, f.samples); });
+    } else {
+        Serial.println("[Preroll] Alloc fail, audio before the session is ready is dropped");
+        delete sessionPreroll;
+        sessionPreroll = NULL;
+    }
+
+#if VAD_ENABLED
+    uplinkGate = new UplinkGate(VAD_PREROLL_FRAMES);
+    if (uplinkGate->begin(CAPTURE_SAMPLE_RATE)) {
+        uplinkGate->vad().setHangoverFrames(VAD_HANGOVER_FRAMES);
+        uplinkGate->setSink(deliverUplink);
+        uplinkGate->vad().onSpeechStart([]() {
+            Serial.println("[VAD] Speech start");
+            if (currentState == STATE_IDLE) currentState = STATE_LISTENING;
+#if HTTP_PREWARM_ON_SPEECH
+            if (!isSpeaking) prewarmConnections();
+#endif
+        });
+        uplinkGate->vad().onSpeechStop([]() {
+            Serial.printf("[VAD] Speech stop (%.1f%% suppressed)\n", uplinkGate->suppressedPercent());
+            if (transcriptionClient) transcriptionClient->flushAudio();  // Don't hold the tail back
+            if (currentState == STATE_LISTENING) currentState = STATE_IDLE;
+        });
+    } else {
+        Serial.println("[VAD] Init fail, streaming everything");
+        delete uplinkGate;
+        uplinkGate = NULL;
+    }
+#endif
+
+    // Calibrate and connect (calibration discards its own settling frames)
+    audioManager.calibrateNoise();
+    if (uplinkGate && audioManager.inputFloorRms() > 0) {
+        // Measured after AEC/NS/AGC: the gate is right from the first word
+        uplinkGate->vad().setNoiseFloorRms(audioManager.inputFloorRms());
+    }
+
+    // From here on the mic is drained by the capture task, not loop()
+    if (!audioManager.startCapture()) {
+        Serial.println("Capture task fail!");
+    }
 
     Serial.println("Connecting...");
     if (transcriptionClient->connect()) {
@@ -328,6 +827,16 @@ void loop() {
         transcriptionClient->loop();
     }
 
+#if LLM_SPECULATIVE_ENABLED
+    serviceSpeculation();
+#endif
+
+    // Time from the end of an answer until the device can hear again
+    if (turnEndMs && transcriptionClient && transcriptionClient->isReady()) {
+        Serial.printf("[WS] Listening %lu ms after playback\n", millis() - turnEndMs);
+        turnEndMs = 0;
+    }
+
     // Check for completed transcription
     if (hasTranscription && pendingText.length() > 0) {
         String text = pendingText;
@@ -341,14 +850,8 @@ void loop() {
     switch (currentState) {
         case STATE_IDLE:
         case STATE_LISTENING:
-            // Stream audio to transcription (skip during cooldown)
-            if (millis() >= cooldownUntil) {
-                uint8_t buf[512];
-                size_t r = audioManager.readBytes((char*)buf, sizeof(buf));
-                if (r > 0 && transcriptionClient && transcriptionClient->isConnected()) {
-                    transcriptionClient->sendAudio(buf, r);
-                }
-            }
+            // Stream captured audio to transcription (skip during cooldown)
+            pumpUplink();
             break;
 
         case STATE_PROCESSING:
@@ -373,6 +876,9 @@ void loop() {
         ledManager.setState(LED_IDLE);
     }
 
+    // PGA steps the AGC asked for (I2C stays on this core)
+    audioManager.serviceAgc();
+
     // Small delay to prevent CPU hogging
     delay(1);
 }
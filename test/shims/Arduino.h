@@ -0,0 +1,76 @@
+// Host (native) shim for the small slice of the Arduino-ESP32 core used by
+// the portable audio modules. Only what the native tests need lives here.
+#ifndef KORVO_NATIVE_ARDUINO_H
+#define KORVO_NATIVE_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <chrono>
+#include <thread>
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/event_groups.h"
+
+inline unsigned long millis() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return (unsigned long)duration_cast<milliseconds>(steady_clock::now() - start).count();
+}
+
+inline unsigned long micros() {
+    using namespace std::chrono;
+    static const steady_clock::time_point start = steady_clock::now();
+    return (unsigned long)duration_cast<microseconds>(steady_clock::now() - start).count();
+}
+
+inline void delay(unsigned long ms) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+inline void yield() {
+    std::this_thread::yield();
+}
+
+template <class T, class L, class H>
+inline T constrain(T v, L lo, H hi) {
+    return v < (T)lo ? (T)lo : (v > (T)hi ? (T)hi : v);
+}
+
+inline long map(long x, long inMin, long inMax, long outMin, long outMax) {
+    return (x - inMin) * (outMax - outMin) / (inMax - inMin) + outMin;
+}
+
+// Serial -> stdout. Quiet by default so benchmarks are not skewed; set
+// HostSerial::echo to see device logs in test output.
+class HostSerial {
+public:
+    bool echo = false;
+
+    int printf(const char* fmt, ...) {
+        if (!echo) return 0;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vprintf(fmt, ap);
+        va_end(ap);
+        return n;
+    }
+    void print(const char* s) { if (echo) fputs(s, stdout); }
+    void println(const char* s = "") { if (echo) puts(s); }
+};
+inline HostSerial Serial;
+
+// ESP.* queries; tests flip psramSize to exercise the internal-RAM fallback.
+class HostEsp {
+public:
+    size_t psramSize = 4 * 1024 * 1024;
+    size_t getPsramSize() { return psramSize; }
+    size_t getFreePsram() { return psramSize; }
+    size_t getFreeHeap() { return 256 * 1024; }
+};
+inline HostEsp ESP;
+
+#endif
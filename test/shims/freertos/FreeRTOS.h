@@ -0,0 +1,15 @@
+// Host shim: ticks are milliseconds.
+#ifndef KORVO_NATIVE_FREERTOS_H
+#define KORVO_NATIVE_FREERTOS_H
+
+#include <stdint.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+
+#define pdTRUE  1
+#define pdFALSE 0
+#define portMAX_DELAY ((TickType_t)0xFFFFFFFFUL)
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+
+#endif
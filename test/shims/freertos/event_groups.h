@@ -0,0 +1,74 @@
+// Host shim: FreeRTOS event groups on top of std::mutex/condition_variable,
+// so the SPSC ring can be exercised from two real threads.
+#ifndef KORVO_NATIVE_EVENT_GROUPS_H
+#define KORVO_NATIVE_EVENT_GROUPS_H
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include "FreeRTOS.h"
+
+typedef uint32_t EventBits_t;
+
+#define BIT0 0x00000001
+#define BIT1 0x00000002
+#define BIT2 0x00000004
+#define BIT3 0x00000008
+#define BIT4 0x00000010
+#define BIT5 0x00000020
+#define BIT6 0x00000040
+#define BIT7 0x00000080
+
+struct HostEventGroup {
+    std::mutex lock;
+    std::condition_variable cv;
+    EventBits_t bits = 0;
+};
+typedef HostEventGroup* EventGroupHandle_t;
+
+inline EventGroupHandle_t xEventGroupCreate() {
+    return new HostEventGroup();
+}
+
+inline void vEventGroupDelete(EventGroupHandle_t group) {
+    delete group;
+}
+
+inline EventBits_t xEventGroupSetBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::lock_guard<std::mutex> guard(group->lock);
+    group->bits |= bits;
+    group->cv.notify_all();
+    return group->bits;
+}
+
+inline EventBits_t xEventGroupClearBits(EventGroupHandle_t group, EventBits_t bits) {
+    std::lock_guard<std::mutex> guard(group->lock);
+    EventBits_t before = group->bits;
+    group->bits &= ~bits;
+    return before;
+}
+
+inline EventBits_t xEventGroupGetBits(EventGroupHandle_t group) {
+    std::lock_guard<std::mutex> guard(group->lock);
+    return group->bits;
+}
+
+inline EventBits_t xEventGroupWaitBits(EventGroupHandle_t group, EventBits_t bits,
+                                       BaseType_t clearOnExit, BaseType_t waitForAll,
+                                       TickType_t timeout) {
+    std::unique_lock<std::mutex> guard(group->lock);
+    auto ready = [&]() {
+        EventBits_t hit = group->bits & bits;
+        return waitForAll ? hit == bits : hit != 0;
+    };
+    if (timeout == portMAX_DELAY) {
+        group->cv.wait(guard, ready);
+    } else {
+        group->cv.wait_for(guard, std::chrono::milliseconds(timeout), ready);
+    }
+    EventBits_t result = group->bits;
+    if (clearOnExit && ready()) group->bits &= ~bits;
+    return result;
+}
+
+#endif
@@ -0,0 +1,87 @@
+// Minimal PCM16 WAV reader/writer for host tests (multichannel, interleaved).
+#ifndef KORVO_TEST_WAV_FILE_H
+#define KORVO_TEST_WAV_FILE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+struct WavData {
+    uint32_t sampleRate = 0;
+    uint16_t channels = 0;
+    std::vector<int16_t> samples;  // Interleaved
+
+    size_t frames() const { return channels ? samples.size() / channels : 0; }
+};
+
+inline bool readWav(const std::string& path, WavData& wav) {
+    FILE* f = fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    char riff[12];
+    bool ok = fread(riff, 1, 12, f) == 12 && !memcmp(riff, "RIFF", 4) && !memcmp(riff + 8, "WAVE", 4);
+    uint16_t bits = 0;
+    bool haveFmt = false;
+
+    while (ok) {
+        char id[4];
+        uint32_t size;
+        if (fread(id, 1, 4, f) != 4 || fread(&size, 4, 1, f) != 1) break;
+
+        if (!memcmp(id, "fmt ", 4)) {
+            uint8_t fmt[40] = {0};
+            size_t n = size < sizeof(fmt) ? size : sizeof(fmt);
+            ok = fread(fmt, 1, n, f) == n;
+            if (size > n) fseek(f, size - n, SEEK_CUR);
+            uint16_t format;
+            memcpy(&format, fmt, 2);
+            memcpy(&wav.channels, fmt + 2, 2);
+            memcpy(&wav.sampleRate, fmt + 4, 4);
+            memcpy(&bits, fmt + 14, 2);
+            // 1 = PCM, 0xFFFE = extensible (assumed PCM subformat)
+            haveFmt = (format == 1 || format == 0xFFFE) && bits == 16;
+        } else if (!memcmp(id, "data", 4) && haveFmt) {
+            wav.samples.resize(size / 2);
+            ok = fread(wav.samples.data(), 2, wav.samples.size(), f) == wav.samples.size();
+            fclose(f);
+            return ok;
+        } else {
+            fseek(f, size + (size & 1), SEEK_CUR);
+        }
+    }
+
+    fclose(f);
+    return false;
+}
+
+inline bool writeWav(const std::string& path, const WavData& wav) {
+    FILE* f = fopen(path.c_str(), "wb");
+    if (!f) return false;
+
+    uint32_t dataSize = wav.samples.size() * 2;
+    uint32_t riffSize = 36 + dataSize;
+    uint16_t format = 1, bits = 16;
+    uint16_t blockAlign = wav.channels * 2;
+    uint32_t byteRate = wav.sampleRate * blockAlign;
+    uint32_t fmtSize = 16;
+
+    fwrite("RIFF", 1, 4, f);
+    fwrite(&riffSize, 4, 1, f);
+    fwrite("WAVEfmt ", 1, 8, f);
+    fwrite(&fmtSize, 4, 1, f);
+    fwrite(&format, 2, 1, f);
+    fwrite(&wav.channels, 2, 1, f);
+    fwrite(&wav.sampleRate, 4, 1, f);
+    fwrite(&byteRate, 4, 1, f);
+    fwrite(&blockAlign, 2, 1, f);
+    fwrite(&bits, 2, 1, f);
+    fwrite("data", 1, 4, f);
+    fwrite(&dataSize, 4, 1, f);
+    bool ok = fwrite(wav.samples.data(), 2, wav.samples.size(), f) == wav.samples.size();
+    fclose(f);
+    return ok;
+}
+
+#endif
@@ -0,0 +1,144 @@
+// AGC host tests: a simulated ES7210 PGA in the loop (source scaled by the
+// analog gain, clipped at the ADC), voiced bursts over background noise.
+#include <unity.h>
+#include <math.h>
+#include <random>
+#include <vector>
+#include "AutoGainControl.h"
+#include "AudioDsp.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t RATE = 24000;
+static const size_t FRAME = 256;
+
+// Talker at `speechDb` dBFS (before the PGA) in 1 s bursts with 0.5 s gaps,
+// over noise at `noiseDb`
+static std::vector<float> talker(float seconds, float speechDb, float noiseDb, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::vector<float> x((size_t)(seconds * RATE));
+    float speechAmp = 32768.0f * powf(10.0f, speechDb / 20.0f) * 1.41f;
+    float noiseAmp = 32768.0f * powf(10.0f, noiseDb / 20.0f);
+    for (size_t i = 0; i < x.size(); i++) {
+        float t = (float)i / RATE;
+        bool on = fmodf(t, 1.5f) < 1.0f;
+        float v = on ? speechAmp * sinf(2.0f * (float)M_PI * 180.0f * t) *
+                           (0.8f + 0.2f * sinf(2.0f * (float)M_PI * 3.0f * t))
+                     : 0.0f;
+        x[i] = v + noiseAmp * gauss(rng);
+    }
+    return x;
+}
+
+struct Loop {
+    AutoGainControl agc;
+    float pgaDb;
+    std::vector<int16_t> out;
+
+    Loop(float startPga) : pgaDb(startPga) {
+        agc.begin(RATE, startPga, 0.0f, 37.5f);
+    }
+
+    void run(const std::vector<float>& source) {
+        int16_t frame[FRAME];
+        for (size_t n = 0; n + FRAME <= source.size(); n += FRAME) {
+            float g = powf(10.0f, pgaDb / 20.0f);
+            for (size_t i = 0; i < FRAME; i++) {
+                frame[i] = AudioDsp::saturate16((int32_t)lrintf(source[n + i] * g));
+            }
+            agc.process(frame, FRAME);
+            out.insert(out.end(), frame, frame + FRAME);
+
+            // The I2C write lands between frames
+            if (agc.pgaChangePending()) {
+                pgaDb = agc.requestedPgaDb();
+                agc.pgaApplied(pgaDb);
+            }
+        }
+    }
+
+    // Output dBFS over the speech bursts in [from, to) seconds
+    float speechDb(float from, float to) const {
+        double e = 0;
+        size_t count = 0;
+        for (size_t i = (size_t)(from * RATE); i < (size_t)(to * RATE) && i < out.size(); i++) {
+            float t = (float)i / RATE;
+            float phase = fmodf(t, 1.5f);
+            if (phase < 0.1f || phase > 0.9f) continue;
+            e += (double)out[i] * out[i];
+            count++;
+        }
+        return 10.0f * log10f((float)(e / count)) - 90.3f;
+    }
+};
+
+void test_brings_quiet_talker_to_target() {
+    Loop loop(24.0f);
+    loop.run(talker(12.0f, -62.0f, -90.0f, 1));   // -38 dBFS at the ADC
+    float level = loop.speechDb(9.0f, 12.0f);
+    printf("quiet: pga %.1f dB, digital %.1f dB, out %.1f dBFS\n",
+           loop.pgaDb, loop.agc.digitalGainDb(), level);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, -18.0f, level);
+    TEST_ASSERT_TRUE(loop.pgaDb > 24.0f);
+    TEST_ASSERT_TRUE(loop.agc.stats().pgaChanges > 0);
+}
+
+void test_backs_off_from_clipping() {
+    Loop loop(37.5f);
+    loop.run(talker(12.0f, -30.0f, -95.0f, 2));   // +7.5 dBFS: clips the ADC
+    const AgcStats& s = loop.agc.stats();
+    uint32_t clippedEarly = s.clippedFrames;
+    TEST_ASSERT_TRUE(clippedEarly > 0);
+
+    // Once the PGA has come down, no more clipping
+    loop.run(talker(3.0f, -30.0f, -95.0f, 3));
+    printf("loud: pga %.1f dB, clipped frames %u, out %.1f dBFS\n",
+           loop.pgaDb, s.clippedFrames, loop.speechDb(13.0f, 15.0f));
+    TEST_ASSERT_EQUAL_UINT32(clippedEarly, s.clippedFrames);
+    TEST_ASSERT_TRUE(loop.pgaDb <= 18.0f);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, -18.0f, loop.speechDb(13.0f, 15.0f));
+}
+
+void test_silence_does_not_pump_gain() {
+    Loop loop(30.0f);
+    loop.run(talker(4.0f, -120.0f, -70.0f, 4));   // Noise only
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, loop.agc.digitalGainDb());
+    TEST_ASSERT_EQUAL_UINT32(0, loop.agc.stats().pgaChanges);
+}
+
+void test_pga_step_does_not_jump_level() {
+    AutoGainControl agc;
+    agc.begin(RATE, 20.0f, 0.0f, 37.5f);
+    std::vector<float> src = talker(2.0f, -45.0f, -100.0f, 5);
+
+    // Steady state, then the PGA goes up 3 dB with the digital gain compensating
+    int16_t frame[FRAME];
+    float before = 0, after = 0;
+    for (size_t n = 0, f = 0; n + FRAME <= RATE; n += FRAME, f++) {
+        float pga = f < 60 ? 20.0f : 23.0f;
+        if (f == 60) agc.pgaApplied(23.0f);
+        float g = powf(10.0f, pga / 20.0f);
+        for (size_t i = 0; i < FRAME; i++) frame[i] = AudioDsp::saturate16((int32_t)lrintf(src[n + i] * g));
+        agc.process(frame, FRAME, false);   // Hold: only the compensation moves
+        // End-to-end gain of this frame: output over source
+        double so = 0, ss = 0;
+        for (size_t i = 0; i < FRAME; i++) {
+            so += (double)frame[i] * frame[i];
+            ss += (double)src[n + i] * src[n + i];
+        }
+        if (f == 59) before = sqrt(so / ss);
+        if (f == 61) after = sqrt(so / ss);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 0.0f, 20.0f * log10f(after / before));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_brings_quiet_talker_to_target);
+    RUN_TEST(test_backs_off_from_clipping);
+    RUN_TEST(test_silence_does_not_pump_gain);
+    RUN_TEST(test_pga_step_does_not_jump_level);
+    return UNITY_END();
+}
@@ -0,0 +1,139 @@
+// AudioDsp host tests.
+#include <unity.h>
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "AudioDsp.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_downmix_averages_channels() {
+    const int16_t stereo[] = {100, 200, -100, -300, 32767, 32767, -32768, -32768, 1, 0, -1, 0};
+    int16_t mono[6];
+    AudioDsp::downmixStereo(stereo, mono, 6);
+    const int16_t expected[] = {150, -200, 32767, -32768, 0, 0};
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, mono, 6);
+}
+
+void test_downmix_in_place_matches_reference() {
+    std::mt19937 rng(11);
+    std::vector<int16_t> stereo(2 * 1000);
+    for (auto& s : stereo) s = (int16_t)rng();
+
+    std::vector<int16_t> expected(1000);
+    for (size_t i = 0; i < 1000; i++) {
+        expected[i] = (int16_t)((stereo[2 * i] + stereo[2 * i + 1]) / 2);
+    }
+
+    AudioDsp::downmixStereo(stereo.data(), stereo.data(), 1000);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected.data(), stereo.data(), 1000);
+}
+
+void test_weighted_downmix_saturates() {
+    const int16_t stereo[] = {32767, 32767, -32768, -32768, 1000, -1000, 8000, 0};
+    const int16_t weights[] = {32767, 32767};  // ~1.0 each: sums can clip
+    int16_t mono[4];
+    AudioDsp::downmix(stereo, mono, 4, 2, weights);
+    TEST_ASSERT_EQUAL_INT16(32767, mono[0]);
+    TEST_ASSERT_EQUAL_INT16(-32768, mono[1]);
+    TEST_ASSERT_INT_WITHIN(1, 0, mono[2]);
+    TEST_ASSERT_INT_WITHIN(1, 8000, mono[3]);
+}
+
+void test_weighted_downmix_selects_channel_and_handles_n_channels() {
+    const int16_t quad[] = {100, 200, 300, 400, -4, -8, -12, -16};
+    const int16_t pickThird[] = {0, 0, 32767, 0};
+    int16_t mono[2];
+    AudioDsp::downmix(quad, mono, 2, 4, pickThird);
+    TEST_ASSERT_INT_WITHIN(1, 300, mono[0]);
+    TEST_ASSERT_INT_WITHIN(1, -12, mono[1]);
+}
+
+void test_gain_saturates_and_counts_clips() {
+    int16_t pcm[] = {1000, -1000, 20000, -20000, 0};
+    size_t clipped = AudioDsp::applyGain(pcm, 5, 2 * AudioDsp::GAIN_UNITY);
+    const int16_t expected[] = {2000, -2000, 32767, -32768, 0};
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, pcm, 5);
+    TEST_ASSERT_EQUAL_UINT32(2, clipped);
+
+    TEST_ASSERT_EQUAL_UINT32(0, AudioDsp::applyGain(pcm, 5, AudioDsp::GAIN_UNITY));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, pcm, 5);
+}
+
+void test_level_peak_and_rms() {
+    std::vector<int16_t> square(1000);
+    for (size_t i = 0; i < square.size(); i++) square[i] = (i & 1) ? 1000 : -1000;
+    square[3] = -32768;
+
+    AudioDsp::Level level = AudioDsp::measureLevel(square.data(), square.size());
+    TEST_ASSERT_EQUAL_UINT32(32768, level.peak);
+    TEST_ASSERT_EQUAL_UINT32(1000, level.count);
+
+    uint64_t expectedEnergy = 999ULL * 1000 * 1000 + 32768ULL * 32768;
+    TEST_ASSERT_TRUE(expectedEnergy == level.energy);
+    TEST_ASSERT_INT_WITHIN(1, (int)sqrt((double)expectedEnergy / 1000), level.rms());
+
+    AudioDsp::Level empty = AudioDsp::measureLevel(square.data(), 0);
+    TEST_ASSERT_EQUAL_UINT32(0, empty.peak);
+    TEST_ASSERT_EQUAL_UINT32(0, empty.rms());
+}
+
+void test_dc_blocker_removes_offset_and_keeps_tone() {
+    AudioDsp::DcBlocker dc;
+    std::vector<int16_t> pcm(24000);
+    for (size_t i = 0; i < pcm.size(); i++) {
+        pcm[i] = (int16_t)(3000 + 8000 * sin(2 * M_PI * 1000 * i / 24000.0));
+    }
+    // Process in capture-sized blocks so the state carries across calls
+    for (size_t i = 0; i < pcm.size(); i += 256) {
+        AudioDsp::removeDc(dc, &pcm[i], std::min<size_t>(256, pcm.size() - i));
+    }
+
+    // Last 100 ms: mean ~0, 1 kHz amplitude preserved
+    int64_t sum = 0;
+    int16_t peak = 0;
+    for (size_t i = pcm.size() - 2400; i < pcm.size(); i++) {
+        sum += pcm[i];
+        if (abs(pcm[i]) > peak) peak = abs(pcm[i]);
+    }
+    TEST_ASSERT_INT_WITHIN(50, 0, (int)(sum / 2400));
+    TEST_ASSERT_INT_WITHIN(200, 8000, peak);
+}
+
+void test_isqrt() {
+    TEST_ASSERT_EQUAL_UINT32(0, AudioDsp::isqrt64(0));
+    TEST_ASSERT_EQUAL_UINT32(1, AudioDsp::isqrt64(3));
+    TEST_ASSERT_EQUAL_UINT32(32768, AudioDsp::isqrt64(1ULL << 30));
+    TEST_ASSERT_EQUAL_UINT32(4294967295UL, AudioDsp::isqrt64(0xFFFFFFFFFFFFFFFFULL));
+}
+
+void test_goertzel_picks_out_one_tone() {
+    // 1 kHz at amplitude 8000 plus 3 kHz at 2000, stereo-interleaved on L
+    std::vector<int16_t> pcm(2 * 2400, 0);
+    for (size_t i = 0; i < 2400; i++) {
+        double t = i / 24000.0;
+        pcm[2 * i] = (int16_t)lround(8000 * sin(2 * M_PI * 1000 * t) + 2000 * sin(2 * M_PI * 3000 * t));
+    }
+    TEST_ASSERT_FLOAT_WITHIN(8000.0f * 8000 / 2 * 0.01f, 8000.0f * 8000 / 2,
+                             AudioDsp::goertzelPower(pcm.data(), 2400, 2, 1000, 24000));
+    TEST_ASSERT_FLOAT_WITHIN(2000.0f * 2000 / 2 * 0.01f, 2000.0f * 2000 / 2,
+                             AudioDsp::goertzelPower(pcm.data(), 2400, 2, 3000, 24000));
+    TEST_ASSERT_LESS_THAN_FLOAT(100.0f, AudioDsp::goertzelPower(pcm.data(), 2400, 2, 2000, 24000));
+    TEST_ASSERT_EQUAL_INT(0, (int)AudioDsp::goertzelPower(pcm.data() + 1, 2400, 2, 1000, 24000));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_downmix_averages_channels);
+    RUN_TEST(test_downmix_in_place_matches_reference);
+    RUN_TEST(test_weighted_downmix_saturates);
+    RUN_TEST(test_weighted_downmix_selects_channel_and_handles_n_channels);
+    RUN_TEST(test_gain_saturates_and_counts_clips);
+    RUN_TEST(test_level_peak_and_rms);
+    RUN_TEST(test_dc_blocker_removes_offset_and_keeps_tone);
+    RUN_TEST(test_isqrt);
+    RUN_TEST(test_goertzel_picks_out_one_tone);
+    return UNITY_END();
+}
@@ -0,0 +1,126 @@
+// AudioFraming host tests: base64 vectors and append message layout.
+#include <unity.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#include <random>
+#include <string>
+#include <vector>
+#include "AudioFraming.h"
+
+void setUp() {}
+void tearDown() {}
+
+static std::string b64(const char* s) {
+    char out[64];
+    size_t n = AudioFraming::base64Encode((const uint8_t*)s, strlen(s), out);
+    return std::string(out, n);
+}
+
+// Reference decoder to check arbitrary binary round trips
+static std::vector<uint8_t> decode(const char* in, size_t len) {
+    auto val = [](char c) -> int {
+        if (c >= 'A' && c <= 'Z') return c - 'A';
+        if (c >= 'a' && c <= 'z') return c - 'a' + 26;
+        if (c >= '0' && c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        return -1;
+    };
+    std::vector<uint8_t> out;
+    for (size_t i = 0; i + 4 <= len; i += 4) {
+        uint32_t v = 0;
+        int pad = 0;
+        for (int k = 0; k < 4; k++) {
+            int d = val(in[i + k]);
+            if (d < 0) { d = 0; pad++; }
+            v = (v << 6) | d;
+        }
+        out.push_back(v >> 16);
+        if (pad < 2) out.push_back((v >> 8) & 0xFF);
+        if (pad < 1) out.push_back(v & 0xFF);
+    }
+    return out;
+}
+
+void test_base64_rfc4648_vectors() {
+    TEST_ASSERT_EQUAL_STRING("", b64("").c_str());
+    TEST_ASSERT_EQUAL_STRING("Zg==", b64("f").c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm8=", b64("fo").c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9v", b64("foo").c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9vYg==", b64("foob").c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9vYmE=", b64("fooba").c_str());
+    TEST_ASSERT_EQUAL_STRING("Zm9vYmFy", b64("foobar").c_str());
+}
+
+void test_base64_random_roundtrip() {
+    std::mt19937 rng(5);
+    for (size_t len = 0; len < 700; len += 1 + rng() % 13) {
+        std::vector<uint8_t> data(len);
+        for (auto& b : data) b = (uint8_t)rng();
+        std::vector<char> text(AudioFraming::base64Length(len));
+        size_t n = AudioFraming::base64Encode(data.data(), len, text.data());
+        TEST_ASSERT_EQUAL_UINT32(AudioFraming::base64Length(len), n);
+        std::vector<uint8_t> back = decode(text.data(), n);
+        TEST_ASSERT_EQUAL_UINT32(len, back.size());
+        if (len) TEST_ASSERT_EQUAL_UINT8_ARRAY(data.data(), back.data(), len);
+    }
+}
+
+void test_append_frame_layout() {
+    const uint8_t pcm[] = {0x00, 0x01, 0xFF, 0x7F};
+    char out[128];
+    size_t n = AudioFraming::buildAppendFrame(out, sizeof(out), pcm, sizeof(pcm));
+    const char* expected = "{\"type\":\"input_audio_buffer.append\",\"audio\":\"AAH/fw==\"}";
+    TEST_ASSERT_EQUAL_UINT32(strlen(expected), n);
+    TEST_ASSERT_EQUAL_UINT32(AudioFraming::appendFrameLength(sizeof(pcm)), n);
+    TEST_ASSERT_EQUAL_STRING(expected, out);
+}
+
+void test_append_frame_rejects_small_buffer() {
+    uint8_t pcm[512] = {0};
+    size_t need = AudioFraming::appendFrameLength(sizeof(pcm)) + 1;
+    std::vector<char> out(need);
+    TEST_ASSERT_EQUAL_UINT32(0, AudioFraming::buildAppendFrame(out.data(), need - 1, pcm, sizeof(pcm)));
+    TEST_ASSERT_EQUAL_UINT32(need - 1, AudioFraming::buildAppendFrame(out.data(), need, pcm, sizeof(pcm)));
+}
+
+void test_builder_reuses_its_buffer() {
+    const size_t HEADROOM = 14;
+    AudioFraming::AppendFrameBuilder builder(HEADROOM, 512);
+    TEST_ASSERT_TRUE(builder.isAllocated());
+    uint8_t* buf = builder.buffer();
+
+    std::mt19937 rng(11);
+    std::vector<uint8_t> pcm(512);
+    std::vector<char> expected(AudioFraming::appendFrameLength(pcm.size()) + 1);
+
+#if defined(__GLIBC__)
+    size_t heapBefore = mallinfo2().uordblks;
+#endif
+    for (int round = 0; round < 200; round++) {
+        size_t len = 2 * (1 + rng() % 256);
+        for (size_t i = 0; i < len; i++) pcm[i] = (uint8_t)rng();
+        size_t n = builder.build(pcm.data(), len);
+        TEST_ASSERT_EQUAL_UINT32(AudioFraming::buildAppendFrame(expected.data(), expected.size(),
+                                                                pcm.data(), len), n);
+        TEST_ASSERT_EQUAL_STRING(expected.data(), builder.message());
+        TEST_ASSERT_TRUE(builder.buffer() == buf);
+        TEST_ASSERT_TRUE(builder.message() == (const char*)buf + HEADROOM);
+    }
+#if defined(__GLIBC__)
+    TEST_ASSERT_EQUAL_UINT32(heapBefore, mallinfo2().uordblks);
+#endif
+
+    TEST_ASSERT_EQUAL_UINT32(0, builder.build(pcm.data(), 514));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_base64_rfc4648_vectors);
+    RUN_TEST(test_base64_random_roundtrip);
+    RUN_TEST(test_append_frame_layout);
+    RUN_TEST(test_append_frame_rejects_small_buffer);
+    RUN_TEST(test_builder_reuses_its_buffer);
+    return UNITY_END();
+}
@@ -0,0 +1,237 @@
+// Beamformer host tests: synthetic far-field sources on the Korvo mic geometry,
+// plus optional validation against recorded multichannel WAV files.
+//
+// Recordings: set KORVO_WAV_DIR to a directory of N-channel 16-bit WAVs named
+// <anything>_azNNN.wav (NNN = true azimuth in degrees, same mic order and
+// geometry as MIC_POSITIONS below). Each one must localise within 30 degrees.
+#include <unity.h>
+#include <dirent.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "Beamformer.h"
+#include "AudioDsp.h"
+#include "WavFile.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t RATE = 24000;
+static const size_t FRAME = 256;
+
+// Nominal Korvo V1.1 triangle, ~32 mm from the centre
+static const MicPosition MIC_POSITIONS[] = {
+    {0.0f, 32.0f},
+    {-27.7f, -16.0f},
+    {27.7f, -16.0f},
+};
+static const size_t MICS = 3;
+
+// Windowed-sinc fractional delay of src (in samples), evaluated at index n
+static double delayed(const std::vector<double>& src, long n, double delay) {
+    const int HALF = 16;
+    double t = n - delay;
+    long centre = (long)floor(t);
+    double acc = 0;
+    for (long k = centre - HALF + 1; k <= centre + HALF; k++) {
+        if (k < 0 || k >= (long)src.size()) continue;
+        double x = t - k;
+        double sinc = fabs(x) < 1e-9 ? 1.0 : sin(M_PI * x) / (M_PI * x);
+        double w = 0.5 + 0.5 * cos(M_PI * x / HALF);
+        acc += src[k] * sinc * w;
+    }
+    return acc;
+}
+
+// Far-field source at azimuth az (degrees) plus independent noise per mic.
+// Returns interleaved MICS-channel PCM; clean[] gets the undelayed source.
+static std::vector<int16_t> simulate(double az, size_t frames, double sourceAmp,
+                                     double noiseAmp, std::vector<double>* clean,
+                                     uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<double> gauss(0.0, 1.0);
+
+    // Band-limited "speech-like" source: white noise through a one-pole lowpass
+    std::vector<double> src(frames);
+    double lp = 0;
+    for (auto& s : src) {
+        lp = 0.7 * lp + 0.3 * gauss(rng);
+        s = lp * sourceAmp;
+    }
+    if (clean) *clean = src;
+
+    double ux = cos(az * M_PI / 180.0);
+    double uy = sin(az * M_PI / 180.0);
+    std::vector<int16_t> out(frames * MICS);
+    for (size_t m = 0; m < MICS; m++) {
+        // Mics closer to the source (larger p.u) hear it earlier
+        double lead = (MIC_POSITIONS[m].xMm * ux + MIC_POSITIONS[m].yMm * uy) / 343000.0 * RATE;
+        for (size_t n = 0; n < frames; n++) {
+            double v = delayed(src, n, 8.0 - lead) + gauss(rng) * noiseAmp;
+            out[n * MICS + m] = AudioDsp::saturate16((int32_t)lround(v));
+        }
+    }
+    return out;
+}
+
+static int angleError(int a, int b) {
+    int d = abs(a - b) % 360;
+    return d > 180 ? 360 - d : d;
+}
+
+static std::vector<int16_t> runBeamformer(Beamformer& bf, const std::vector<int16_t>& in,
+                                          size_t channels) {
+    size_t frames = in.size() / channels;
+    std::vector<int16_t> out(frames);
+    for (size_t n = 0; n + FRAME <= frames; n += FRAME) {
+        bf.process(in.data() + n * channels, out.data() + n, FRAME);
+    }
+    return out;
+}
+
+void test_localises_synthetic_sources() {
+    for (int az = 0; az < 360; az += 30) {
+        Beamformer bf;
+        TEST_ASSERT_TRUE(bf.begin(MIC_POSITIONS, MICS, RATE));
+        auto pcm = simulate(az, RATE, 3000, 300, nullptr, 100 + az);
+        runBeamformer(bf, pcm, MICS);
+
+        char msg[64];
+        snprintf(msg, sizeof(msg), "source at %d, estimated %d", az, bf.directionDegrees());
+        TEST_ASSERT_TRUE_MESSAGE(angleError(az, bf.directionDegrees()) <= 30, msg);
+    }
+}
+
+void test_improves_snr_over_single_mic() {
+    Beamformer bf;
+    TEST_ASSERT_TRUE(bf.begin(MIC_POSITIONS, MICS, RATE));
+    bf.steer(4);  // 120 degrees
+
+    std::vector<double> clean;
+    auto pcm = simulate(120, RATE, 2000, 1500, &clean, 7);
+    auto out = runBeamformer(bf, pcm, MICS);
+
+    // Align the clean reference by least squares against each output, then
+    // compare residual noise power: mic 0 vs the steered beam.
+    auto snrDb = [&](const std::vector<int16_t>& y, size_t stride, size_t offset) {
+        double best = -1e9;
+        for (int lag = 0; lag < 24; lag++) {
+            double sxy = 0, sxx = 0, syy = 0;
+            for (size_t n = 64; n + lag < out.size(); n++) {
+                double x = clean[n];
+                double v = y[(n + lag) * stride + offset];
+                sxy += x * v;
+                sxx += x * x;
+                syy += v * v;
+            }
+            double g = sxy / sxx;
+            double sig = g * g * sxx;
+            double noise = syy - sig;
+            best = std::max(best, 10 * log10(sig / noise));
+        }
+        return best;
+    };
+
+    double single = snrDb(pcm, MICS, 0);
+    double beam = snrDb(out, 1, 0);
+    printf("single mic %.1f dB, beam %.1f dB\n", single, beam);
+    // Ideal gain for 3 mics with uncorrelated noise is 4.8 dB
+    TEST_ASSERT_GREATER_THAN_FLOAT((float)(single + 3.0), (float)beam);
+}
+
+void test_quiet_frames_keep_direction() {
+    Beamformer bf;
+    TEST_ASSERT_TRUE(bf.begin(MIC_POSITIONS, MICS, RATE));
+    auto loud = simulate(90, RATE / 2, 3000, 100, nullptr, 3);
+    runBeamformer(bf, loud, MICS);
+    int locked = bf.directionDegrees();
+    TEST_ASSERT_TRUE(angleError(90, locked) <= 30);
+
+    // Background noise below the DOA threshold must not drag the beam around
+    auto quiet = simulate(270, RATE / 2, 20, 40, nullptr, 4);
+    runBeamformer(bf, quiet, MICS);
+    TEST_ASSERT_EQUAL_INT(locked, bf.directionDegrees());
+}
+
+void test_rejects_array_too_wide() {
+    const MicPosition wide[] = {{-200.0f, 0.0f}, {200.0f, 0.0f}};
+    Beamformer bf;
+    TEST_ASSERT_FALSE(bf.begin(wide, 2, RATE));
+    TEST_ASSERT_FALSE(bf.begin(MIC_POSITIONS, 0, RATE));
+}
+
+void test_wav_round_trip() {
+    WavData wav;
+    wav.sampleRate = RATE;
+    wav.channels = MICS;
+    wav.samples = simulate(210, FRAME * 8, 3000, 100, nullptr, 9);
+
+    std::string path = "/tmp/korvo_beam_az210.wav";
+    TEST_ASSERT_TRUE(writeWav(path, wav));
+
+    WavData back;
+    TEST_ASSERT_TRUE(readWav(path, back));
+    TEST_ASSERT_EQUAL_UINT32(RATE, back.sampleRate);
+    TEST_ASSERT_EQUAL_INT(MICS, back.channels);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(wav.samples.data(), back.samples.data(), wav.samples.size());
+    remove(path.c_str());
+}
+
+void test_recorded_wavs() {
+    const char* dir = getenv("KORVO_WAV_DIR");
+    if (!dir) {
+        TEST_IGNORE_MESSAGE("KORVO_WAV_DIR not set");
+        return;
+    }
+
+    DIR* d = opendir(dir);
+    TEST_ASSERT_NOT_NULL(d);
+    int checked = 0;
+    while (dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        size_t tag = name.rfind("_az");
+        if (tag == std::string::npos || name.size() < 4 ||
+            name.compare(name.size() - 4, 4, ".wav") != 0) {
+            continue;
+        }
+
+        WavData wav;
+        TEST_ASSERT_TRUE(readWav(std::string(dir) + "/" + name, wav));
+        TEST_ASSERT_EQUAL_INT(MICS, wav.channels);
+
+        Beamformer bf;
+        TEST_ASSERT_TRUE(bf.begin(MIC_POSITIONS, MICS, wav.sampleRate));
+        runBeamformer(bf, wav.samples, wav.channels);
+
+        int truth = atoi(name.c_str() + tag + 3);
+        printf("%s: estimated %d\n", name.c_str(), bf.directionDegrees());
+        TEST_ASSERT_TRUE_MESSAGE(angleError(truth, bf.directionDegrees()) <= 30, name.c_str());
+        checked++;
+    }
+    closedir(d);
+    TEST_ASSERT_GREATER_THAN(0, checked);
+}
+
+void test_unpack_tdm_slots() {
+    // Two frames of 4 x 16-bit slots carried as 32-bit stereo words
+    const uint32_t words[] = {0x00010002, 0x00030004, 0xFFFF8000, 0x7FFF0000};
+    int16_t out[6];
+    AudioDsp::unpackTdm(words, 4, out, 2, 3);
+    const int16_t expected[] = {1, 2, 3, -1, -32768, 32767};
+    TEST_ASSERT_EQUAL_INT16_ARRAY(expected, out, 6);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_localises_synthetic_sources);
+    RUN_TEST(test_improves_snr_over_single_mic);
+    RUN_TEST(test_quiet_frames_keep_direction);
+    RUN_TEST(test_rejects_array_too_wide);
+    RUN_TEST(test_wav_round_trip);
+    RUN_TEST(test_recorded_wavs);
+    RUN_TEST(test_unpack_tdm_slots);
+    return UNITY_END();
+}
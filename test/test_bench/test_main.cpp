@@ -0,0 +1,199 @@
+// Host throughput benchmarks for the audio hot paths.
+// Run with: pio test -e native -f test_bench -v
+// Numbers are for spotting regressions between commits on the same machine,
+// not for predicting ESP32 timings.
+#include <unity.h>
+#include <chrono>
+#include <vector>
+#include "AudioRingBuffer.h"
+#include "AudioDsp.h"
+#include "AudioFraming.h"
+#include "Beamformer.h"
+#include "EchoCanceller.h"
+#include "NoiseSuppressor.h"
+#include "Resampler.h"
+
+void setUp() {}
+void tearDown() {}
+
+static volatile uint32_t sink;
+
+// Runs op until ~200 ms have elapsed and reports throughput per call.
+template <class Op>
+static void bench(const char* name, size_t bytesPerOp, Op op) {
+    using clock = std::chrono::steady_clock;
+    for (int i = 0; i < 100; i++) op();  // Warm-up
+
+    size_t ops = 0;
+    uint32_t startCycles = AudioDsp::cycleCount();
+    auto start = clock::now();
+    auto elapsed = clock::duration::zero();
+    while (elapsed < std::chrono::milliseconds(200)) {
+        for (int i = 0; i < 256; i++) op();
+        ops += 256;
+        elapsed = clock::now() - start;
+    }
+
+    uint32_t cycles = AudioDsp::cycleCount() - startCycles;
+
+    double ns = std::chrono::duration<double, std::nano>(elapsed).count();
+    double nsPerOp = ns / ops;
+    double mbps = (double)bytesPerOp * ops / (ns / 1e9) / (1024.0 * 1024.0);
+    printf("[bench] %-32s %10.1f MB/s %10.1f ns/op %8.2f cycles/sample\n",
+           name, mbps, nsPerOp, (double)cycles / ops / (bytesPerOp / 2));
+    TEST_ASSERT_GREATER_THAN(0.0, mbps);
+}
+
+void bench_ring_buffer_copy() {
+    AudioRingBuffer rb(64 * 1024);
+    std::vector<uint8_t> chunk(2048, 0x55);
+    // 2000 bytes is not a divisor of the capacity, so the wrap paths run too
+    bench("ring write+read 2000B", 2000, [&]() {
+        rb.write(chunk.data(), 2000);
+        rb.read(chunk.data(), 2000);
+        sink = chunk[0];
+    });
+}
+
+void bench_ring_buffer_spans() {
+    AudioRingBuffer rb(64 * 1024);
+    bench("ring acquire/commit 2000B", 2000, [&]() {
+        AudioRingBuffer::Span w = rb.acquireWrite(2000);
+        rb.commitWrite(w.len);
+        AudioRingBuffer::Span r = rb.acquireRead(2000);
+        rb.commitRead(r.len);
+        sink = r.len;
+    });
+}
+
+void bench_ring_buffer_tiered() {
+    AudioRingBuffer rb(256 * 1024);
+    rb.enableHotTier(16 * 1024);
+    std::vector<uint8_t> chunk(2048, 0x55);
+    bench("ring tiered write+read 2000B", 2000, [&]() {
+        rb.write(chunk.data(), 2000);
+        rb.read(chunk.data(), 2000);
+        sink = chunk[0];
+    });
+}
+
+void bench_downmix() {
+    std::vector<int16_t> stereo(512, 1234), mono(256);
+    bench("downmix 256 frames", stereo.size() * 2, [&]() {
+        AudioDsp::downmixStereo(stereo.data(), mono.data(), 256);
+        sink = mono[7];
+    });
+}
+
+void bench_downmix_weighted() {
+    std::vector<int16_t> stereo(512, 1234), mono(256);
+    const int16_t weights[] = {AudioDsp::Q15_HALF, AudioDsp::Q15_HALF};
+    bench("downmix weighted 256 frames", stereo.size() * 2, [&]() {
+        AudioDsp::downmix(stereo.data(), mono.data(), 256, 2, weights);
+        sink = mono[7];
+    });
+}
+
+void bench_gain() {
+    std::vector<int16_t> pcm(256, 1234);
+    bench("gain 256 samples", pcm.size() * 2, [&]() {
+        sink = AudioDsp::applyGain(pcm.data(), pcm.size(), AudioDsp::GAIN_UNITY + 1);
+    });
+}
+
+void bench_level() {
+    std::vector<int16_t> pcm(1024);
+    for (size_t i = 0; i < pcm.size(); i++) pcm[i] = (int16_t)(i * 37);
+    bench("peak+rms 1024 samples", pcm.size() * 2, [&]() {
+        sink = AudioDsp::measureLevel(pcm.data(), pcm.size()).peak;
+    });
+}
+
+void bench_dc_blocker() {
+    std::vector<int16_t> pcm(256, 1234);
+    AudioDsp::DcBlocker dc;
+    bench("dc blocker 256 samples", pcm.size() * 2, [&]() {
+        AudioDsp::removeDc(dc, pcm.data(), pcm.size());
+        sink = pcm[3];
+    });
+}
+
+void bench_append_frame() {
+    std::vector<uint8_t> pcm(512, 0xA5);
+    std::vector<char> out(AudioFraming::appendFrameLength(512) + 1);
+    bench("append frame 512B pcm", pcm.size(), [&]() {
+        sink = AudioFraming::buildAppendFrame(out.data(), out.size(), pcm.data(), pcm.size());
+    });
+}
+
+void bench_beamformer() {
+    const MicPosition mics[] = {{0.0f, 32.0f}, {-27.7f, -16.0f}, {27.7f, -16.0f}};
+    Beamformer bf;
+    bf.begin(mics, 3, 24000);
+    bf.setDoaMinRms(0);  // Always pay for the DOA scan when it is due
+    std::vector<int16_t> in(256 * 3);
+    for (size_t i = 0; i < in.size(); i++) in[i] = (int16_t)(i * 977);
+    std::vector<int16_t> out(256);
+    bench("beamformer 3ch x 256 frames", out.size() * 2, [&]() {
+        bf.process(in.data(), out.data(), 256);
+        sink = out[5];
+    });
+}
+
+void bench_echo_canceller() {
+    EchoCanceller aec;
+    aec.begin(6);
+    std::vector<int16_t> ref(AEC_BLOCK), mic(AEC_BLOCK);
+    for (size_t i = 0; i < AEC_BLOCK; i++) ref[i] = (int16_t)(i * 613);
+    bench("aec 6 partitions x 256", AEC_BLOCK * 2, [&]() {
+        for (size_t i = 0; i < AEC_BLOCK; i++) mic[i] = ref[(i + 7) % AEC_BLOCK] / 2;
+        aec.process(ref.data(), mic.data(), AEC_BLOCK);
+        sink = mic[3];
+    });
+}
+
+void bench_noise_suppressor() {
+    NoiseSuppressor ns;
+    ns.begin(24000);
+    std::vector<int16_t> pcm(NS_HOP);
+    uint32_t seed = 1;
+    bench("noise suppressor 512-pt STFT", NS_HOP * 2, [&]() {
+        for (size_t i = 0; i < NS_HOP; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            pcm[i] = (int16_t)(seed >> 23);
+        }
+        ns.process(pcm.data(), NS_HOP);
+        sink = pcm[3];
+    });
+}
+
+void bench_resampler() {
+    Resampler down, up;
+    down.begin(24000, 16000);
+    up.begin(16000, 24000);
+    std::vector<int16_t> in(256), mid(down.maxOutput(256)), out(up.maxOutput(mid.size()));
+    for (size_t i = 0; i < in.size(); i++) in[i] = (int16_t)(i * 977);
+    bench("resample 24k -> 16k -> 24k", in.size() * 2, [&]() {
+        size_t n = down.process(in.data(), in.size(), mid.data());
+        up.process(mid.data(), n, out.data());
+        sink = out[3];
+    });
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(bench_ring_buffer_copy);
+    RUN_TEST(bench_ring_buffer_spans);
+    RUN_TEST(bench_ring_buffer_tiered);
+    RUN_TEST(bench_downmix);
+    RUN_TEST(bench_downmix_weighted);
+    RUN_TEST(bench_gain);
+    RUN_TEST(bench_level);
+    RUN_TEST(bench_dc_blocker);
+    RUN_TEST(bench_append_frame);
+    RUN_TEST(bench_beamformer);
+    RUN_TEST(bench_echo_canceller);
+    RUN_TEST(bench_noise_suppressor);
+    RUN_TEST(bench_resampler);
+    return UNITY_END();
+}
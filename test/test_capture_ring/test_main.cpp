@@ -0,0 +1,76 @@
+// CaptureFrameRing host tests.
+#include <unity.h>
+#include <thread>
+#include "CaptureFrameRing.h"
+
+void setUp() {}
+void tearDown() {}
+
+void test_slot_count_rounds_down() {
+    CaptureFrameRing ring(40);
+    TEST_ASSERT_TRUE(ring.isAllocated());
+    TEST_ASSERT_EQUAL_UINT32(32, ring.capacity());
+}
+
+void test_full_ring_refuses_frames() {
+    CaptureFrameRing ring(4);
+    for (int i = 0; i < 4; i++) {
+        CaptureFrame* f = ring.acquireWrite();
+        TEST_ASSERT_NOT_NULL(f);
+        f->firstSample = i;
+        ring.commitWrite();
+    }
+    TEST_ASSERT_NULL(ring.acquireWrite());
+    TEST_ASSERT_EQUAL_UINT32(4, ring.available());
+
+    TEST_ASSERT_EQUAL_UINT32(0, ring.peek()->firstSample);
+    ring.pop();
+    TEST_ASSERT_NOT_NULL(ring.acquireWrite());
+}
+
+void test_discard_all_empties_ring() {
+    CaptureFrameRing ring(8);
+    for (int i = 0; i < 5; i++) {
+        ring.acquireWrite();
+        ring.commitWrite();
+    }
+    ring.discardAll();
+    TEST_ASSERT_EQUAL_UINT32(0, ring.available());
+    TEST_ASSERT_NULL(ring.peek());
+}
+
+void test_threaded_frames_arrive_in_order() {
+    const uint32_t FRAMES = 200000;
+    CaptureFrameRing ring(16);
+    uint32_t dropped = 0;
+
+    std::thread producer([&]() {
+        for (uint32_t i = 0; i < FRAMES; i++) {
+            CaptureFrame* f;
+            while (!(f = ring.acquireWrite())) std::this_thread::yield();
+            f->firstSample = i * CAPTURE_FRAME_SAMPLES;
+            f->samples = CAPTURE_FRAME_SAMPLES;
+            f->pcm[0] = (int16_t)i;
+            ring.commitWrite();
+        }
+    });
+
+    for (uint32_t i = 0; i < FRAMES;) {
+        const CaptureFrame* f = ring.peek();
+        if (!f) continue;
+        if (f->firstSample != i * CAPTURE_FRAME_SAMPLES || f->pcm[0] != (int16_t)i) dropped++;
+        ring.pop();
+        i++;
+    }
+    producer.join();
+    TEST_ASSERT_EQUAL_UINT32(0, dropped);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_slot_count_rounds_down);
+    RUN_TEST(test_full_ring_refuses_frames);
+    RUN_TEST(test_discard_all_empties_ring);
+    RUN_TEST(test_threaded_frames_arrive_in_order);
+    return UNITY_END();
+}
@@ -0,0 +1,260 @@
+// Echo canceller host tests: FFT accuracy, far-end reference alignment and
+// ERLE on a simulated room, plus optional replay of recorded sessions.
+//
+// Recordings: set KORVO_WAV_DIR to a directory containing 2-channel 16-bit
+// WAVs named <anything>_aec.wav, channel 0 = mic, channel 1 = the far-end
+// reference, time-aligned as the firmware would see them.
+#include <unity.h>
+#include <dirent.h>
+#include <math.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+#include "AudioFft.h"
+#include "EchoCanceller.h"
+#include "FarEndReference.h"
+#include "AudioDsp.h"
+#include "WavFile.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t RATE = 24000;
+
+void test_real_fft_matches_dft() {
+    const size_t n = 64;
+    RealFft fft;
+    TEST_ASSERT_TRUE(fft.begin(n));
+
+    std::mt19937 rng(1);
+    std::vector<float> x(n), spec(n + 2), back(n);
+    for (auto& v : x) v = (float)((int)(rng() % 2001) - 1000);
+    fft.forward(x.data(), spec.data());
+
+    for (size_t k = 0; k <= n / 2; k++) {
+        double re = 0, im = 0;
+        for (size_t t = 0; t < n; t++) {
+            re += x[t] * cos(2 * M_PI * k * t / n);
+            im -= x[t] * sin(2 * M_PI * k * t / n);
+        }
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, (float)re, spec[2 * k]);
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, (float)im, spec[2 * k + 1]);
+    }
+
+    fft.inverse(spec.data(), back.data());
+    for (size_t i = 0; i < n; i++) TEST_ASSERT_FLOAT_WITHIN(0.01f, x[i], back[i]);
+    TEST_ASSERT_FALSE(fft.begin(48));
+}
+
+void test_far_end_reference_aligns_by_time() {
+    FarEndReference ref(4096, RATE);
+    TEST_ASSERT_TRUE(ref.isAllocated());
+
+    // 1000 samples of a ramp starting at t = 1 s
+    std::vector<int16_t> pcm(1000);
+    for (size_t i = 0; i < pcm.size(); i++) pcm[i] = (int16_t)(i + 1);
+    ref.push(pcm.data(), pcm.size(), 1000000);
+
+    // Ask for 100 samples starting 50 samples before playback began
+    int16_t out[100];
+    int64_t start = 1000000 - 50 * 1000000 / RATE;
+    TEST_ASSERT_EQUAL_UINT32(50, ref.read(start, out, 100));
+    TEST_ASSERT_EQUAL_INT16(0, out[49]);
+    TEST_ASSERT_EQUAL_INT16(1, out[50]);
+    TEST_ASSERT_EQUAL_INT16(50, out[99]);
+
+    // After the segment: silence
+    TEST_ASSERT_EQUAL_UINT32(0, ref.read(3000000, out, 100));
+    TEST_ASSERT_EQUAL_INT16(0, out[0]);
+
+    // Mid-segment read
+    TEST_ASSERT_EQUAL_UINT32(100, ref.read(1000000 + 500 * 1000000 / RATE, out, 100));
+    TEST_ASSERT_EQUAL_INT16(501, out[0]);
+}
+
+void test_far_end_reference_drops_overwritten_audio() {
+    FarEndReference ref(1024, RATE);
+    std::vector<int16_t> pcm(512, 7);
+    int64_t t = 0;
+    for (int i = 0; i < 4; i++) {
+        ref.push(pcm.data(), pcm.size(), t);
+        t += 512 * 1000000 / RATE;
+    }
+
+    // The first segment has been overwritten by the last two
+    int16_t out[64];
+    TEST_ASSERT_EQUAL_UINT32(0, ref.read(0, out, 64));
+    TEST_ASSERT_EQUAL_UINT32(64, ref.read(3 * 512 * 1000000 / RATE, out, 64));
+}
+
+// Simulated room: bulk delay plus an exponentially decaying random tail
+static std::vector<float> roomResponse(size_t delay, size_t length, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::vector<float> h(delay + length, 0.0f);
+    for (size_t i = 0; i < length; i++) {
+        h[delay + i] = gauss(rng) * 0.5f * expf(-(float)i / (length / 6.0f));
+    }
+    return h;
+}
+
+// Speech-like far end: lowpassed noise with a slow syllable envelope
+static std::vector<int16_t> farEndSignal(size_t n, uint32_t seed, float amp) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    std::vector<int16_t> x(n);
+    float lp = 0;
+    for (size_t i = 0; i < n; i++) {
+        lp = 0.6f * lp + 0.4f * gauss(rng);
+        float env = 0.6f + 0.4f * sinf(2.0f * (float)M_PI * 3.0f * i / RATE);
+        x[i] = AudioDsp::saturate16((int32_t)(lp * amp * env));
+    }
+    return x;
+}
+
+static std::vector<int16_t> convolve(const std::vector<int16_t>& x, const std::vector<float>& h) {
+    std::vector<int16_t> y(x.size());
+    for (size_t n = 0; n < x.size(); n++) {
+        float acc = 0;
+        size_t taps = std::min(h.size(), n + 1);
+        for (size_t k = 0; k < taps; k++) acc += h[k] * x[n - k];
+        y[n] = AudioDsp::saturate16((int32_t)lrintf(acc));
+    }
+    return y;
+}
+
+static double energy(const int16_t* x, size_t n) {
+    double e = 0;
+    for (size_t i = 0; i < n; i++) e += (double)x[i] * x[i];
+    return e;
+}
+
+// Runs the canceller block by block; returns the output
+static std::vector<int16_t> cancel(EchoCanceller& aec, const std::vector<int16_t>& ref,
+                                   std::vector<int16_t> mic) {
+    for (size_t n = 0; n + AEC_BLOCK <= mic.size(); n += AEC_BLOCK) {
+        aec.process(ref.data() + n, mic.data() + n, AEC_BLOCK);
+    }
+    return mic;
+}
+
+void test_converges_on_simulated_room() {
+    const size_t n = RATE * 4;
+    auto far = farEndSignal(n, 1, 4000.0f);
+    auto echo = convolve(far, roomResponse(72, 960, 2));  // 3 ms + 40 ms tail
+
+    std::mt19937 rng(3);
+    std::normal_distribution<float> gauss(0.0f, 20.0f);
+    std::vector<int16_t> mic(n);
+    for (size_t i = 0; i < n; i++) mic[i] = AudioDsp::saturate16(echo[i] + (int32_t)gauss(rng));
+
+    EchoCanceller aec;
+    TEST_ASSERT_TRUE(aec.begin(6));
+    auto out = cancel(aec, far, mic);
+
+    // ERLE over the last second, after convergence
+    size_t tail = RATE;
+    double erle = 10 * log10(energy(mic.data() + n - tail, tail) / energy(out.data() + n - tail, tail));
+    printf("ERLE %.1f dB (canceller estimate %.1f dB), %u cycles/block max\n",
+           erle, aec.erleDb(), aec.maxBlockCycles());
+    TEST_ASSERT_GREATER_THAN_FLOAT(20.0f, (float)erle);
+    TEST_ASSERT_GREATER_THAN_FLOAT(15.0f, aec.erleDb());
+}
+
+void test_double_talk_keeps_near_end_and_filter() {
+    const size_t n = RATE * 6;
+    auto far = farEndSignal(n, 4, 4000.0f);
+    auto echo = convolve(far, roomResponse(48, 720, 5));
+    auto nearTalk = farEndSignal(n, 6, 3000.0f);
+
+    // Near-end talker from 3 s to 4.5 s, far end throughout
+    const size_t dtStart = RATE * 3, dtEnd = RATE * 9 / 2;
+    std::vector<int16_t> mic(echo);
+    for (size_t i = dtStart; i < dtEnd; i++) mic[i] = AudioDsp::saturate16(mic[i] + nearTalk[i]);
+
+    EchoCanceller aec;
+    TEST_ASSERT_TRUE(aec.begin(6));
+    auto out = cancel(aec, far, mic);
+    TEST_ASSERT_GREATER_THAN(0, aec.doubleTalkBlocks());
+
+    // Near-end speech comes through: output ~ near-end alone during double talk
+    std::vector<int16_t> residual(dtEnd - dtStart);
+    for (size_t i = dtStart; i < dtEnd; i++) residual[i - dtStart] = out[i] - nearTalk[i];
+    double passDb = 10 * log10(energy(nearTalk.data() + dtStart, dtEnd - dtStart) /
+                               energy(residual.data(), residual.size()));
+    printf("near-end to residual %.1f dB during double talk\n", passDb);
+    TEST_ASSERT_GREATER_THAN_FLOAT(10.0f, (float)passDb);
+
+    // The filter did not diverge: echo is still cancelled afterwards
+    size_t from = RATE * 5;
+    double erle = 10 * log10(energy(mic.data() + from, n - from) / energy(out.data() + from, n - from));
+    printf("ERLE after double talk %.1f dB\n", erle);
+    TEST_ASSERT_GREATER_THAN_FLOAT(15.0f, (float)erle);
+}
+
+void test_silent_far_end_passes_mic_through() {
+    const size_t n = AEC_BLOCK * 20;
+    std::vector<int16_t> ref(n, 0);
+    std::vector<int16_t> mic = farEndSignal(n, 8, 2000.0f);
+
+    EchoCanceller aec;
+    TEST_ASSERT_TRUE(aec.begin(4));
+    auto out = cancel(aec, ref, mic);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(mic.data(), out.data(), n);
+    TEST_ASSERT_FALSE(aec.farEndActive());
+}
+
+void test_recorded_sessions() {
+    const char* dir = getenv("KORVO_WAV_DIR");
+    if (!dir) {
+        TEST_IGNORE_MESSAGE("KORVO_WAV_DIR not set");
+        return;
+    }
+
+    DIR* d = opendir(dir);
+    TEST_ASSERT_NOT_NULL(d);
+    int checked = 0;
+    while (dirent* e = readdir(d)) {
+        std::string name = e->d_name;
+        if (name.size() < 8 || name.compare(name.size() - 8, 8, "_aec.wav") != 0) continue;
+
+        WavData wav;
+        TEST_ASSERT_TRUE(readWav(std::string(dir) + "/" + name, wav));
+        TEST_ASSERT_EQUAL_INT(2, wav.channels);
+
+        size_t frames = wav.frames();
+        std::vector<int16_t> mic(frames), ref(frames);
+        for (size_t i = 0; i < frames; i++) {
+            mic[i] = wav.samples[2 * i];
+            ref[i] = wav.samples[2 * i + 1];
+        }
+
+        EchoCanceller aec;
+        TEST_ASSERT_TRUE(aec.begin(6));
+        auto out = cancel(aec, ref, mic);
+
+        // Skip the first second (convergence)
+        size_t from = std::min(frames, (size_t)wav.sampleRate);
+        double erle = 10 * log10(energy(mic.data() + from, frames - from) /
+                                 (energy(out.data() + from, frames - from) + 1));
+        printf("%s: ERLE %.1f dB, double-talk blocks %u\n", name.c_str(), erle, aec.doubleTalkBlocks());
+        TEST_ASSERT_GREATER_THAN_FLOAT(6.0f, (float)erle);
+        checked++;
+    }
+    closedir(d);
+    TEST_ASSERT_GREATER_THAN(0, checked);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_real_fft_matches_dft);
+    RUN_TEST(test_far_end_reference_aligns_by_time);
+    RUN_TEST(test_far_end_reference_drops_overwritten_audio);
+    RUN_TEST(test_converges_on_simulated_room);
+    RUN_TEST(test_double_talk_keeps_near_end_and_filter);
+    RUN_TEST(test_silent_far_end_passes_mic_through);
+    RUN_TEST(test_recorded_sessions);
+    return UNITY_END();
+}
@@ -0,0 +1,102 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <vector>
+#include "G711.h"
+
+void setUp() {}
+void tearDown() {}
+
+typedef void (*Encoder)(const int16_t*, uint8_t*, size_t);
+typedef int16_t (*Decoder)(uint8_t);
+
+// Round-trip SNR of a 1 kHz tone at 8 kHz with the given peak
+static double toneSnrDb(Encoder enc, Decoder dec, double peak) {
+    const size_t N = 8000;
+    std::vector<int16_t> pcm(N);
+    for (size_t i = 0; i < N; i++) pcm[i] = (int16_t)lround(peak * sin(2 * M_PI * 1003 * i / 8000.0));
+    std::vector<uint8_t> coded(N);
+    enc(pcm.data(), coded.data(), N);
+
+    double sig = 0, err = 0;
+    for (size_t i = 0; i < N; i++) {
+        double e = dec(coded[i]) - pcm[i];
+        sig += (double)pcm[i] * pcm[i];
+        err += e * e;
+    }
+    return 10 * log10(sig / err);
+}
+
+static void checkSnr(Encoder enc, Decoder dec, const char* name) {
+    // G.711 keeps ~38 dB over most of the range; the small end has fewer steps
+    const double levelsDb[] = {-1, -6, -20, -30, -40};
+    const double minSnr[] = {35, 35, 35, 33, 30};
+    for (size_t i = 0; i < sizeof(levelsDb) / sizeof(levelsDb[0]); i++) {
+        double snr = toneSnrDb(enc, dec, 32767 * pow(10, levelsDb[i] / 20));
+        printf("%s %.0f dBFS: SNR %.1f dB\n", name, levelsDb[i], snr);
+        TEST_ASSERT_GREATER_THAN_FLOAT((float)minSnr[i], (float)snr);
+    }
+}
+
+void test_ulaw_round_trip_snr() {
+    checkSnr(G711::encodeUlaw, G711::decodeUlaw, "u-law");
+}
+
+void test_alaw_round_trip_snr() {
+    checkSnr(G711::encodeAlaw, G711::decodeAlaw, "A-law");
+}
+
+// Every code's reconstruction level must encode back to the same level, and
+// the encoder must be monotonic over the whole 16-bit range
+static void checkCodebook(Encoder enc, Decoder dec) {
+    for (int c = 0; c < 256; c++) {
+        int16_t level = dec((uint8_t)c);
+        uint8_t back;
+        enc(&level, &back, 1);
+        TEST_ASSERT_EQUAL_INT16(level, dec(back));
+    }
+
+    int16_t prev = -32768;
+    for (int32_t x = -32768; x <= 32767; x++) {
+        int16_t s = (int16_t)x;
+        uint8_t code;
+        enc(&s, &code, 1);
+        int16_t y = dec(code);
+        TEST_ASSERT_TRUE(y >= prev);
+        prev = y;
+    }
+}
+
+void test_ulaw_codebook() {
+    checkCodebook(G711::encodeUlaw, G711::decodeUlaw);
+    // Reference points from the G.711 tables
+    uint8_t code;
+    int16_t zero = 0, full = 32767, neg = -32768;
+    G711::encodeUlaw(&zero, &code, 1);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, code);
+    G711::encodeUlaw(&full, &code, 1);
+    TEST_ASSERT_EQUAL_HEX8(0x80, code);
+    G711::encodeUlaw(&neg, &code, 1);
+    TEST_ASSERT_EQUAL_HEX8(0x00, code);
+}
+
+void test_alaw_codebook() {
+    checkCodebook(G711::encodeAlaw, G711::decodeAlaw);
+    uint8_t code;
+    int16_t zero = 0, full = 32767, neg = -32768;
+    G711::encodeAlaw(&zero, &code, 1);
+    TEST_ASSERT_EQUAL_HEX8(0xD5, code);
+    G711::encodeAlaw(&full, &code, 1);
+    TEST_ASSERT_EQUAL_HEX8(0xAA, code);
+    G711::encodeAlaw(&neg, &code, 1);
+    TEST_ASSERT_EQUAL_HEX8(0x2A, code);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_ulaw_round_trip_snr);
+    RUN_TEST(test_alaw_round_trip_snr);
+    RUN_TEST(test_ulaw_codebook);
+    RUN_TEST(test_alaw_codebook);
+    return UNITY_END();
+}
@@ -0,0 +1,215 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "HistoryStore.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Message {
+    HistoryRole role;
+    std::string text;
+};
+
+static std::vector<Message> contents(const HistoryStore& h) {
+    std::vector<Message> out;
+    h.forEach([&](HistoryRole role, const char* text, size_t len) { out.push_back({role, std::string(text, len)}); });
+    return out;
+}
+
+static void addStr(HistoryStore& h, HistoryRole role, const std::string& s) {
+    h.add(role, s.data(), s.size());
+}
+
+void test_keeps_messages_in_order() {
+    HistoryStore h;
+    TEST_ASSERT_TRUE(h.begin(1024, 8, 1000));
+    addStr(h, ROLE_USER, "What time is it?");
+    addStr(h, ROLE_ASSISTANT, "It is noon.");
+    std::vector<Message> m = contents(h);
+    TEST_ASSERT_EQUAL(2, m.size());
+    TEST_ASSERT_EQUAL(ROLE_USER, m[0].role);
+    TEST_ASSERT_EQUAL_STRING("What time is it?", m[0].text.c_str());
+    TEST_ASSERT_EQUAL(ROLE_ASSISTANT, m[1].role);
+    TEST_ASSERT_EQUAL_STRING("It is noon.", m[1].text.c_str());
+    TEST_ASSERT_EQUAL(HistoryStore::estimateTokens("What time is it?", 16) +
+                      HistoryStore::estimateTokens("It is noon.", 11), h.tokens());
+}
+
+void test_estimates_tokens_by_characters() {
+    // 8 characters either way: accents don't count double
+    TEST_ASSERT_EQUAL(HistoryStore::estimateTokens("ca fe ok", 8),
+                      HistoryStore::estimateTokens("caf\xc3\xa9 ol\xc3\xa1", 10));
+    TEST_ASSERT_EQUAL(HistoryStore::estimateTokens("", 0) + 25, HistoryStore::estimateTokens(std::string(100, 'a').c_str(), 100));
+}
+
+void test_evicts_oldest_by_token_budget() {
+    HistoryStore h;
+    std::string text(40, 'x');    // 14 tokens each
+    uint32_t each = HistoryStore::estimateTokens(text.data(), text.size());
+    TEST_ASSERT_TRUE(h.begin(4096, 64, each * 5));
+
+    for (int i = 0; i < 10; i++) {
+        text[0] = 'a' + i;
+        addStr(h, i % 2 ? ROLE_ASSISTANT : ROLE_USER, text);
+        TEST_ASSERT_TRUE(h.tokens() <= each * 5);
+    }
+    // Five would fit, but that would start with an answer
+    std::vector<Message> m = contents(h);
+    TEST_ASSERT_EQUAL(4, m.size());
+    TEST_ASSERT_EQUAL(ROLE_USER, m[0].role);
+    TEST_ASSERT_EQUAL('g', m[0].text[0]);
+    TEST_ASSERT_EQUAL('j', m[3].text[0]);
+    TEST_ASSERT_EQUAL(6, h.evicted());
+}
+
+void test_evicts_when_slots_run_out() {
+    HistoryStore h;
+    TEST_ASSERT_TRUE(h.begin(4096, 4, 100000));
+    for (int i = 0; i < 9; i++) addStr(h, i % 2 ? ROLE_ASSISTANT : ROLE_USER, std::string(1, 'a' + i));
+    std::vector<Message> m = contents(h);
+    // Slots for 4, but the oldest left would be an answer
+    TEST_ASSERT_EQUAL(3, m.size());
+    TEST_ASSERT_EQUAL_STRING("g", m[0].text.c_str());
+    TEST_ASSERT_EQUAL_STRING("i", m[2].text.c_str());
+}
+
+void test_arena_wrap_matches_reference() {
+    // Small arena, generous budget: space runs out first and the ring wraps
+    HistoryStore h;
+    TEST_ASSERT_TRUE(h.begin(300, 32, 100000));
+    std::vector<Message> ref;
+    uint32_t seed = 7;
+    for (int i = 0; i < 500; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        size_t len = 1 + (seed >> 8) % 90;
+        std::string text(len, 'a' + i % 26);
+        HistoryRole role = i % 2 ? ROLE_ASSISTANT : ROLE_USER;
+        addStr(h, role, text);
+        ref.push_back({role, text});
+
+        std::vector<Message> m = contents(h);
+        TEST_ASSERT_TRUE(m.size() > 0 && m.size() <= ref.size());
+        // What is kept is the newest messages, intact and in order
+        size_t skip = ref.size() - m.size();
+        for (size_t k = 0; k < m.size(); k++) {
+            TEST_ASSERT_EQUAL(ref[skip + k].role, m[k].role);
+            TEST_ASSERT_TRUE(ref[skip + k].text == m[k].text);
+        }
+        // An exchange always fits, so the oldest kept is a question
+        TEST_ASSERT_EQUAL(ROLE_USER, m[0].role);
+    }
+}
+
+void test_remove_last_frees_its_space() {
+    HistoryStore h;
+    TEST_ASSERT_TRUE(h.begin(64, 8, 1000));
+    addStr(h, ROLE_USER, std::string(30, 'u'));
+    addStr(h, ROLE_ASSISTANT, std::string(30, 'a'));
+    uint32_t before = h.tokens();
+    h.removeLast();
+    TEST_ASSERT_EQUAL(1, h.size());
+    TEST_ASSERT_TRUE(h.tokens() < before);
+
+    // Fits where the removed one was, so the first message survives
+    addStr(h, ROLE_ASSISTANT, std::string(30, 'b'));
+    std::vector<Message> m = contents(h);
+    TEST_ASSERT_EQUAL(2, m.size());
+    TEST_ASSERT_EQUAL('u', m[0].text[0]);
+    TEST_ASSERT_EQUAL('b', m[1].text[0]);
+    TEST_ASSERT_EQUAL(0, h.evicted());
+}
+
+void test_cuts_oversized_message_on_character_boundary() {
+    HistoryStore h;
+    TEST_ASSERT_TRUE(h.begin(4096, 8, 10));    // 6 tokens of text: at most 24 bytes
+    std::string text;
+    for (int i = 0; i < 20; i++) text += "\xc3\xa9";   // 2 bytes each
+    addStr(h, ROLE_USER, text);
+    std::vector<Message> m = contents(h);
+    TEST_ASSERT_EQUAL(1, m.size());
+    TEST_ASSERT_EQUAL(24, m[0].text.size());
+    TEST_ASSERT_TRUE(h.tokens() <= 10);
+}
+
+void test_oversized_exchange_keeps_its_question() {
+    HistoryStore h;
+    TEST_ASSERT_TRUE(h.begin(4096, 8, 100));
+    addStr(h, ROLE_USER, "Hi");
+    addStr(h, ROLE_ASSISTANT, "Hello!");
+    std::string question(60, 'q');
+    std::string answer(2000, 'a');     // Alone it would take the whole budget
+    h.addExchange(question.data(), question.size(), answer.data(), answer.size());
+
+    std::vector<Message> m = contents(h);
+    TEST_ASSERT_EQUAL(2, m.size());
+    TEST_ASSERT_EQUAL(ROLE_USER, m[0].role);
+    TEST_ASSERT_TRUE(question == m[0].text);
+    TEST_ASSERT_EQUAL(ROLE_ASSISTANT, m[1].role);
+    TEST_ASSERT_TRUE(m[1].text.size() > 0 && m[1].text.size() < answer.size());
+    TEST_ASSERT_TRUE(h.tokens() <= 100);
+
+    // Taking it back (a cancelled turn) leaves a consistent history
+    TEST_ASSERT_TRUE(h.removeLastExchange());
+    TEST_ASSERT_EQUAL(0, h.size());
+    TEST_ASSERT_EQUAL(0, h.tokens());
+    TEST_ASSERT_FALSE(h.removeLastExchange());
+    h.addExchange("Again?", 6, "Yes.", 4);
+    m = contents(h);
+    TEST_ASSERT_EQUAL(2, m.size());
+    TEST_ASSERT_EQUAL_STRING("Again?", m[0].text.c_str());
+    TEST_ASSERT_EQUAL_STRING("Yes.", m[1].text.c_str());
+}
+
+void test_cancel_after_exchange_restores_previous() {
+    HistoryStore h;
+    TEST_ASSERT_TRUE(h.begin(200, 8, 1000));
+    h.addExchange("One?", 4, "First.", 6);
+    uint32_t before = h.tokens();
+    // Both halves oversized for the arena: the question is cut to half of it
+    std::string big(500, 'z');
+    h.addExchange(big.data(), big.size(), big.data(), big.size());
+    std::vector<Message> m = contents(h);
+    TEST_ASSERT_EQUAL(ROLE_USER, m[0].role);
+    TEST_ASSERT_EQUAL(ROLE_ASSISTANT, m.back().role);
+
+    TEST_ASSERT_TRUE(h.removeLastExchange());
+    m = contents(h);
+    for (size_t i = 0; i < m.size(); i++) TEST_ASSERT_EQUAL(i % 2 ? ROLE_ASSISTANT : ROLE_USER, m[i].role);
+    TEST_ASSERT_TRUE(h.tokens() <= before);
+}
+
+void test_exchanges_wrap_arena_in_pairs() {
+    HistoryStore h;
+    TEST_ASSERT_TRUE(h.begin(300, 32, 100000));
+    uint32_t seed = 11;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1664525u + 1013904223u;
+        std::string q(1 + (seed >> 8) % 200, 'a' + i % 26);
+        std::string a(1 + (seed >> 16) % 400, 'A' + i % 26);
+        h.addExchange(q.data(), q.size(), a.data(), a.size());
+
+        std::vector<Message> m = contents(h);
+        TEST_ASSERT_TRUE(m.size() >= 2 && m.size() % 2 == 0);
+        TEST_ASSERT_EQUAL(ROLE_USER, m[m.size() - 2].role);
+        TEST_ASSERT_EQUAL('a' + i % 26, m[m.size() - 2].text[0]);
+        TEST_ASSERT_EQUAL('A' + i % 26, m.back().text[0]);
+        for (size_t k = 0; k < m.size(); k++) TEST_ASSERT_EQUAL(k % 2 ? ROLE_ASSISTANT : ROLE_USER, m[k].role);
+    }
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_keeps_messages_in_order);
+    RUN_TEST(test_estimates_tokens_by_characters);
+    RUN_TEST(test_evicts_oldest_by_token_budget);
+    RUN_TEST(test_evicts_when_slots_run_out);
+    RUN_TEST(test_arena_wrap_matches_reference);
+    RUN_TEST(test_remove_last_frees_its_space);
+    RUN_TEST(test_cuts_oversized_message_on_character_boundary);
+    RUN_TEST(test_oversized_exchange_keeps_its_question);
+    RUN_TEST(test_cancel_after_exchange_restores_previous);
+    RUN_TEST(test_exchanges_wrap_arena_in_pairs);
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+// Noise suppressor host tests: fixed-point FFT accuracy, transparency, and
+// noise reduction on synthetic voiced speech in white noise.
+#include <unity.h>
+#include <math.h>
+#include <stdlib.h>
+#include <random>
+#include <vector>
+#include "NoiseSuppressor.h"
+#include "AudioFft.h"
+#include "AudioDsp.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t RATE = 24000;
+
+// Voiced "vowel": 140 Hz pulse train through two formant-ish resonances
+static void addVowel(std::vector<float>& x, size_t from, size_t to, float amp) {
+    for (size_t i = from; i < to && i < x.size(); i++) {
+        float t = (float)i / RATE;
+        float v = 0;
+        for (int h = 1; h <= 25; h++) {
+            float f = 140.0f * h;
+            float g = expf(-powf((f - 700.0f) / 300.0f, 2)) + 0.6f * expf(-powf((f - 1800.0f) / 400.0f, 2));
+            v += g * sinf(2.0f * (float)M_PI * f * t);
+        }
+        x[i] += amp * v;
+    }
+}
+
+static void addNoise(std::vector<float>& x, size_t from, size_t to, float amp, uint32_t seed) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    for (size_t i = from; i < to && i < x.size(); i++) x[i] += amp * gauss(rng);
+}
+
+static std::vector<int16_t> run(NoiseSuppressor& ns, const std::vector<float>& x) {
+    std::vector<int16_t> pcm(x.size());
+    for (size_t i = 0; i < x.size(); i++) pcm[i] = AudioDsp::saturate16((int32_t)lrintf(x[i]));
+    for (size_t n = 0; n + NS_HOP <= pcm.size(); n += NS_HOP) ns.process(pcm.data() + n, NS_HOP);
+    return pcm;
+}
+
+static double energy(const std::vector<int16_t>& x, size_t from, size_t to) {
+    double e = 0;
+    for (size_t i = from; i < to; i++) e += (double)x[i] * x[i];
+    return e / (to - from);
+}
+
+static double energy(const std::vector<float>& x, size_t from, size_t to) {
+    double e = 0;
+    for (size_t i = from; i < to; i++) e += (double)x[i] * x[i];
+    return e / (to - from);
+}
+
+void test_fixed_fft_matches_float() {
+    const size_t N = 512;
+    RealFftFixed fixed;
+    RealFft ref;
+    TEST_ASSERT_TRUE(fixed.begin(N));
+    TEST_ASSERT_TRUE(ref.begin(N));
+
+    std::mt19937 rng(5);
+    std::vector<int32_t> x(N), X(N + 2), y(N);
+    std::vector<float> xf(N), Xf(N + 2);
+    for (size_t i = 0; i < N; i++) {
+        x[i] = ((int32_t)(rng() % 20001) - 10000) << 6;
+        xf[i] = (float)x[i];
+    }
+    fixed.forward(x.data(), X.data());
+    ref.forward(xf.data(), Xf.data());
+
+    // out = DFT * 2 / N; allow 1e-4 of full scale
+    double peak = 10000.0 * 64 * N * 2 / N;
+    for (size_t k = 0; k < N + 2; k++) {
+        TEST_ASSERT_FLOAT_WITHIN((float)(peak * 1e-4), Xf[k] * 2.0f / N, (float)X[k]);
+    }
+
+    fixed.inverse(X.data(), y.data());
+    for (size_t i = 0; i < N; i++) {
+        TEST_ASSERT_INT32_WITHIN(64 * 4, x[i], y[i]);
+    }
+}
+
+void test_transparent_without_attenuation() {
+    NoiseSuppressor ns;
+    TEST_ASSERT_TRUE(ns.begin(RATE));
+    ns.setMaxAttenuationDb(0);
+
+    std::vector<float> x(NS_HOP * 90, 0.0f);
+    addNoise(x, 0, x.size(), 300.0f, 2);
+    addVowel(x, 0, x.size(), 3000.0f);
+    auto out = run(ns, x);
+
+    // Pure NS_HOP delay, up to Q15 rounding (~-70 dB)
+    for (size_t i = NS_HOP; i < x.size(); i++) {
+        int expected = AudioDsp::saturate16((int32_t)lrintf(x[i - NS_HOP]));
+        TEST_ASSERT_INT_WITHIN(2 + abs(expected) / 1024, expected, out[i]);
+    }
+}
+
+void test_removes_stationary_noise() {
+    // 2 s noise, 1 s vowel in noise, 2 s noise
+    std::vector<float> noise(RATE * 5, 0.0f), speech(RATE * 5, 0.0f);
+    addNoise(noise, 0, noise.size(), 300.0f, 3);
+    addVowel(speech, RATE * 2, RATE * 3, 600.0f);
+    std::vector<float> x(noise.size());
+    for (size_t i = 0; i < x.size(); i++) x[i] = noise[i] + speech[i];
+
+    NoiseSuppressor ns;
+    TEST_ASSERT_TRUE(ns.begin(RATE));
+    auto out = run(ns, x);
+
+    // Noise-only tail, and the vowel (shifted by the NS_HOP latency)
+    double noiseIn = energy(noise, RATE * 4, RATE * 5);
+    double noiseOut = energy(out, RATE * 4, RATE * 5);
+    double speechIn = energy(speech, RATE * 2 + 2400, RATE * 3);
+    double mixOut = energy(out, RATE * 2 + 2400 + NS_HOP, RATE * 3 + NS_HOP);
+
+    double attenuation = 10 * log10(noiseIn / noiseOut);
+    double snrIn = 10 * log10(speechIn / noiseIn);
+    double snrOut = 10 * log10((mixOut - noiseOut) / noiseOut);
+    double speechLoss = 10 * log10(speechIn / (mixOut - noiseOut));
+    printf("noise -%.1f dB, SNR %.1f -> %.1f dB, speech loss %.1f dB, gain %.1f dB\n",
+           attenuation, snrIn, snrOut, speechLoss, ns.lastGainDb());
+
+    TEST_ASSERT_GREATER_THAN_FLOAT(10.0f, (float)attenuation);
+    TEST_ASSERT_GREATER_THAN_FLOAT((float)(snrIn + 8.0), (float)snrOut);
+    TEST_ASSERT_LESS_THAN_FLOAT(2.0f, (float)speechLoss);
+}
+
+void test_tracks_rising_noise() {
+    // Noise steps up 12 dB at 2 s; minimum statistics needs ~1.4-2.8 s
+    std::vector<float> x(RATE * 6, 0.0f);
+    addNoise(x, 0, RATE * 2, 100.0f, 4);
+    addNoise(x, RATE * 2, x.size(), 400.0f, 5);
+
+    NoiseSuppressor ns;
+    TEST_ASSERT_TRUE(ns.begin(RATE));
+    auto out = run(ns, x);
+
+    double attenuation = 10 * log10(energy(x, RATE * 5, RATE * 6) / energy(out, RATE * 5, RATE * 6));
+    printf("after the step: -%.1f dB\n", attenuation);
+    TEST_ASSERT_GREATER_THAN_FLOAT(10.0f, (float)attenuation);
+}
+
+void test_seeded_floor_suppresses_immediately() {
+    std::vector<float> x(RATE / 2, 0.0f);
+    addNoise(x, 0, x.size(), 300.0f, 6);
+    addVowel(x, 0, RATE / 10, 3000.0f);   // Speech from the first frame
+
+    NoiseSuppressor ns;
+    TEST_ASSERT_TRUE(ns.begin(RATE));
+    ns.setNoiseFloorRms(300.0f);
+    auto out = run(ns, x);
+
+    // Without the seed the vowel would have been learned as noise
+    double speechIn = energy(x, NS_HOP, RATE / 10);
+    double speechOut = energy(out, 2 * NS_HOP, RATE / 10 + NS_HOP);
+    double noiseIn = energy(x, RATE / 4, RATE / 2 - NS_HOP);
+    double noiseOut = energy(out, RATE / 4 + NS_HOP, RATE / 2);
+    TEST_ASSERT_LESS_THAN_FLOAT(2.0f, (float)(10 * log10(speechIn / speechOut)));
+    TEST_ASSERT_GREATER_THAN_FLOAT(10.0f, (float)(10 * log10(noiseIn / noiseOut)));
+}
+
+void test_reports_cycles_and_ignores_odd_sizes() {
+    NoiseSuppressor ns;
+    int16_t pcm[NS_HOP];
+    for (size_t i = 0; i < NS_HOP; i++) pcm[i] = (int16_t)(i * 37);
+    ns.process(pcm, NS_HOP);   // Not begun: untouched
+    TEST_ASSERT_EQUAL_INT16(37, pcm[1]);
+
+    TEST_ASSERT_TRUE(ns.begin(RATE));
+    ns.process(pcm, 100);
+    TEST_ASSERT_EQUAL_INT16(37, pcm[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, ns.framesProcessed());
+
+    ns.process(pcm, NS_HOP);
+    TEST_ASSERT_EQUAL_UINT32(1, ns.framesProcessed());
+#if defined(__x86_64__) || defined(__i386__)
+    TEST_ASSERT_GREATER_THAN(0, ns.lastFrameCycles());
+#endif
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_fixed_fft_matches_float);
+    RUN_TEST(test_transparent_without_attenuation);
+    RUN_TEST(test_removes_stationary_noise);
+    RUN_TEST(test_tracks_rising_noise);
+    RUN_TEST(test_seeded_floor_suppresses_immediately);
+    RUN_TEST(test_reports_cycles_and_ignores_odd_sizes);
+    return UNITY_END();
+}
@@ -0,0 +1,64 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "PartialTranscript.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t QUIET = 150;
+
+void test_accumulates_deltas() {
+    PartialTranscript t;
+    t.append("What's the", 0);
+    t.append(" weather", 10);
+    t.append(" today?", 20);
+    TEST_ASSERT_EQUAL_STRING("What's the weather today?", t.text());
+    TEST_ASSERT_EQUAL(25, t.length());
+    t.reset();
+    TEST_ASSERT_EQUAL_STRING("", t.text());
+}
+
+void test_stable_after_sentence_end_and_quiet() {
+    PartialTranscript t;
+    t.append("Turn on the", 1000);
+    TEST_ASSERT_FALSE(t.isStable(5000, QUIET));     // Mid-sentence
+    t.append(" lights.", 1100);
+    TEST_ASSERT_FALSE(t.isStable(1200, QUIET));     // Too recent
+    TEST_ASSERT_TRUE(t.isStable(1250, QUIET));
+    t.append(" ", 1300);                            // Trailing space is fine
+    TEST_ASSERT_TRUE(t.isStable(1450, QUIET));
+}
+
+void test_never_stable_when_empty_or_truncated() {
+    PartialTranscript t;
+    TEST_ASSERT_FALSE(t.isStable(10000, QUIET));
+    t.append(".", 0);
+    TEST_ASSERT_FALSE(t.isStable(10000, QUIET));    // No words
+
+    std::string longText(PARTIAL_TRANSCRIPT_MAX + 20, 'a');
+    longText += ".";
+    t.reset();
+    t.append(longText.c_str(), 0);
+    TEST_ASSERT_EQUAL(PARTIAL_TRANSCRIPT_MAX - 1, t.length());
+    TEST_ASSERT_FALSE(t.isStable(10000, QUIET));
+}
+
+void test_matches_ignores_case_punctuation_spacing() {
+    TEST_ASSERT_TRUE(PartialTranscript::matches("what's the weather today?", "What's the weather today?"));
+    TEST_ASSERT_TRUE(PartialTranscript::matches("Hello, world.", "hello world"));
+    TEST_ASSERT_TRUE(PartialTranscript::matches(" Olá, tudo bem? ", "olá tudo bem"));
+    TEST_ASSERT_FALSE(PartialTranscript::matches("Turn on the lights.", "Turn off the lights."));
+    TEST_ASSERT_FALSE(PartialTranscript::matches("Set a timer.", "Set a timer for ten minutes."));
+    TEST_ASSERT_FALSE(PartialTranscript::matches("", "Hi."));
+    TEST_ASSERT_TRUE(PartialTranscript::matches("", "..."));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_accumulates_deltas);
+    RUN_TEST(test_stable_after_sentence_end_and_quiet);
+    RUN_TEST(test_never_stable_when_empty_or_truncated);
+    RUN_TEST(test_matches_ignores_case_punctuation_spacing);
+    return UNITY_END();
+}
@@ -0,0 +1,70 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "RealtimeEvents.h"
+
+using namespace RealtimeEvents;
+
+void setUp() {}
+void tearDown() {}
+
+static Type classifyStr(const std::string& json) {
+    return classify(json.data(), json.size());
+}
+
+void test_classifies_handled_events() {
+    TEST_ASSERT_EQUAL(SPEECH_STARTED, classifyStr(
+        "{\"type\":\"input_audio_buffer.speech_started\",\"event_id\":\"event_1\",\"audio_start_ms\":120}"));
+    TEST_ASSERT_EQUAL(TRANSCRIPT_COMPLETED, classifyStr(
+        "{\"event_id\":\"event_2\",\"type\":\"conversation.item.input_audio_transcription.completed\","
+        "\"item_id\":\"item_1\",\"content_index\":0,\"transcript\":\"hello\"}"));
+    TEST_ASSERT_EQUAL(TRANSCRIPT_DELTA, classifyStr(
+        "{\"type\":\"conversation.item.input_audio_transcription.delta\",\"delta\":\"he\"}"));
+    TEST_ASSERT_EQUAL(SESSION_UPDATED, classifyStr("{\"type\":\"transcription_session.updated\"}"));
+    TEST_ASSERT_EQUAL(SERVER_ERROR, classifyStr(
+        "{\"type\":\"error\",\"error\":{\"type\":\"invalid_request_error\",\"message\":\"bad\"}}"));
+}
+
+void test_ignores_unhandled_events() {
+    TEST_ASSERT_EQUAL(IGNORED, classifyStr("{\"type\":\"input_audio_buffer.committed\",\"item_id\":\"x\"}"));
+    TEST_ASSERT_EQUAL(IGNORED, classifyStr("{\"type\":\"conversation.item.created\",\"item\":{\"type\":\"message\"}}"));
+    TEST_ASSERT_EQUAL(IGNORED, classifyStr("{\"type\":\"rate_limits.updated\"}"));
+    // Prefix of a handled name is not that name
+    TEST_ASSERT_EQUAL(IGNORED, classifyStr("{\"type\":\"error.extra\"}"));
+    TEST_ASSERT_EQUAL(IGNORED, classifyStr("{\"type\":\"err\"}"));
+}
+
+void test_tolerates_whitespace() {
+    TEST_ASSERT_EQUAL(SPEECH_STOPPED, classifyStr(
+        "{\n  \"type\" :  \"input_audio_buffer.speech_stopped\",\n  \"audio_end_ms\": 900\n}"));
+}
+
+void test_falls_back_when_unsure() {
+    // No type near the start, an escaped value, or a truncated frame: parse fully
+    std::string late = "{\"event_id\":\"" + std::string(200, 'x') + "\",\"type\":\"error\"}";
+    TEST_ASSERT_EQUAL(TYPE_NOT_FOUND, classifyStr(late));
+    TEST_ASSERT_EQUAL(TYPE_NOT_FOUND, classifyStr("{\"type\":\"err\\u006fr\"}"));
+    TEST_ASSERT_EQUAL(TYPE_NOT_FOUND, classifyStr("{\"type\":\"inp"));
+    TEST_ASSERT_EQUAL(TYPE_NOT_FOUND, classifyStr("{\"type\":42}"));
+    TEST_ASSERT_EQUAL(TYPE_NOT_FOUND, classifyStr(""));
+
+    // "type" as a value is skipped, the real key after it is found
+    TEST_ASSERT_EQUAL(SPEECH_STARTED, classifyStr(
+        "{\"kind\":\"type\",\"type\":\"input_audio_buffer.speech_started\"}"));
+}
+
+void test_from_name() {
+    const char* name = "session.updated";
+    TEST_ASSERT_EQUAL(SESSION_UPDATED, fromName(name, strlen(name)));
+    TEST_ASSERT_EQUAL(IGNORED, fromName(name, 7));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_classifies_handled_events);
+    RUN_TEST(test_ignores_unhandled_events);
+    RUN_TEST(test_tolerates_whitespace);
+    RUN_TEST(test_falls_back_when_unsure);
+    RUN_TEST(test_from_name);
+    return UNITY_END();
+}
@@ -0,0 +1,148 @@
+// Resampler host tests: THD+N, passband ripple and alias rejection on the
+// rate pairs the firmware can be configured for, plus streaming behaviour.
+#include <unity.h>
+#include <math.h>
+#include <random>
+#include <vector>
+#include "Resampler.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t PAIRS[][2] = {
+    {24000, 16000}, {16000, 24000}, {24000, 8000}, {8000, 24000}, {22050, 24000}, {44100, 24000},
+};
+
+static std::vector<int16_t> tone(uint32_t rate, double hz, double amp, size_t n) {
+    std::vector<int16_t> x(n);
+    for (size_t i = 0; i < n; i++) x[i] = (int16_t)lrint(amp * sin(2 * M_PI * hz * i / rate));
+    return x;
+}
+
+static std::vector<int16_t> convert(Resampler& r, const std::vector<int16_t>& in) {
+    std::vector<int16_t> out(r.maxOutput(in.size()));
+    out.resize(r.process(in.data(), in.size(), out.data()));
+    return out;
+}
+
+// Least-squares fit of a sine at hz over the settled part of y:
+// gain re amp (dB) and everything else re the fit (dB)
+struct Fit {
+    double gainDb;
+    double thdnDb;
+};
+
+static Fit fitTone(const std::vector<int16_t>& y, uint32_t rate, double hz, double amp) {
+    double ss = 0, cc = 0, sc = 0, sy = 0, cy = 0, yy = 0;
+    size_t from = y.size() / 4;
+    for (size_t i = from; i < y.size(); i++) {
+        double s = sin(2 * M_PI * hz * i / rate), c = cos(2 * M_PI * hz * i / rate), v = y[i];
+        ss += s * s;
+        cc += c * c;
+        sc += s * c;
+        sy += s * v;
+        cy += c * v;
+        yy += v * v;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (sy * cc - cy * sc) / det, b = (cy * ss - sy * sc) / det;
+    double sig = a * a * ss + b * b * cc + 2 * a * b * sc;
+    Fit f;
+    f.gainDb = 10 * log10(sig / (y.size() - from) / (amp * amp / 2));
+    f.thdnDb = 10 * log10((yy - sig) / sig);
+    return f;
+}
+
+void test_thd_at_1khz() {
+    for (auto& p : PAIRS) {
+        Resampler r;
+        TEST_ASSERT_TRUE(r.begin(p[0], p[1]));
+        Fit f = fitTone(convert(r, tone(p[0], 1000, 16000, p[0])), p[1], 1000, 16000);
+        printf("%u -> %u: THD+N %.1f dB, %.0f cycles/sample\n", p[0], p[1], f.thdnDb,
+               r.cyclesPerOutputSample());
+        TEST_ASSERT_LESS_THAN_FLOAT(-70.0f, (float)f.thdnDb);
+    }
+}
+
+void test_passband_ripple() {
+    for (auto& p : PAIRS) {
+        Resampler r;
+        TEST_ASSERT_TRUE(r.begin(p[0], p[1]));
+        double edge = 0.4 * (p[0] < p[1] ? p[0] : p[1]);
+        double lo = 1e9, hi = -1e9;
+        for (double hz = 100; hz <= edge; hz *= 1.25) {
+            r.reset();
+            double g = fitTone(convert(r, tone(p[0], hz, 10000, p[0] / 2)), p[1], hz, 10000).gainDb;
+            lo = fmin(lo, g);
+            hi = fmax(hi, g);
+        }
+        printf("%u -> %u: passband %.3f .. %.3f dB up to %.0f Hz\n", p[0], p[1], lo, hi, edge);
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, (float)lo);
+        TEST_ASSERT_FLOAT_WITHIN(0.05f, 0.0f, (float)hi);
+    }
+}
+
+void test_rejects_aliases() {
+    // 10 kHz has no place at 16 kHz; it would fold to 6 kHz
+    Resampler r;
+    TEST_ASSERT_TRUE(r.begin(24000, 16000));
+    auto out = convert(r, tone(24000, 10000, 16000, 24000));
+    double e = 0;
+    for (size_t i = out.size() / 4; i < out.size(); i++) e += (double)out[i] * out[i];
+    double db = 10 * log10(e / (out.size() - out.size() / 4) / (16000.0 * 16000.0 / 2));
+    printf("10 kHz at 24 -> 16 kHz: %.1f dB\n", db);
+    TEST_ASSERT_LESS_THAN_FLOAT(-60.0f, (float)db);
+}
+
+void test_streaming_matches_one_shot() {
+    std::mt19937 rng(3);
+    std::vector<int16_t> in(8000);
+    for (auto& v : in) v = (int16_t)((int)(rng() % 20000) - 10000);
+
+    for (auto& p : PAIRS) {
+        Resampler whole, chunked;
+        TEST_ASSERT_TRUE(whole.begin(p[0], p[1]));
+        TEST_ASSERT_TRUE(chunked.begin(p[0], p[1]));
+        auto expected = convert(whole, in);
+
+        std::vector<int16_t> got;
+        size_t pos = 0;
+        while (pos < in.size()) {
+            size_t n = 1 + rng() % 300;
+            if (n > in.size() - pos) n = in.size() - pos;
+            std::vector<int16_t> out(chunked.maxOutput(n));
+            size_t made = chunked.process(in.data() + pos, n, out.data());
+            TEST_ASSERT_TRUE(made <= chunked.maxOutput(n));
+            got.insert(got.end(), out.begin(), out.begin() + made);
+            pos += n;
+        }
+        TEST_ASSERT_EQUAL_INT(expected.size(), got.size());
+        TEST_ASSERT_EQUAL_INT16_ARRAY(expected.data(), got.data(), got.size());
+
+        // One second in, one second (give or take a sample) out
+        TEST_ASSERT_INT_WITHIN(1, (int)((uint64_t)in.size() * p[1] / p[0]), (int)got.size());
+    }
+}
+
+void test_passthrough_and_bad_ratios() {
+    Resampler r;
+    TEST_ASSERT_TRUE(r.begin(24000, 24000));
+    TEST_ASSERT_TRUE(r.isPassthrough());
+    const int16_t in[] = {1, -2, 3, 32767, -32768};
+    int16_t out[8];
+    TEST_ASSERT_EQUAL_INT(5, r.process(in, 5, out));
+    TEST_ASSERT_EQUAL_INT16_ARRAY(in, out, 5);
+
+    TEST_ASSERT_FALSE(r.begin(0, 16000));
+    TEST_ASSERT_FALSE(r.begin(24000, 23999));   // 23999 phases
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_thd_at_1khz);
+    RUN_TEST(test_passband_ripple);
+    RUN_TEST(test_rejects_aliases);
+    RUN_TEST(test_streaming_matches_one_shot);
+    RUN_TEST(test_passthrough_and_bad_ratios);
+    return UNITY_END();
+}
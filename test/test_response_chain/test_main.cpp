@@ -0,0 +1,140 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include "ResponseChain.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const char CREATED[] =
+    "{\"type\":\"response.created\",\"sequence_number\":0,\"response\":{\"id\":\"resp_68a1b2\","
+    "\"object\":\"response\",\"status\":\"in_progress\",\"previous_response_id\":\"resp_0001\"}}";
+
+static const char NOT_FOUND[] =
+    "{\n  \"error\": {\n    \"message\": \"Previous response with id 'resp_0001' not found.\",\n"
+    "    \"type\": \"invalid_request_error\",\n    \"param\": \"previous_response_id\",\n"
+    "    \"code\": \"previous_response_not_found\"\n  }\n}";
+
+static const char BAD_REQUEST[] =
+    "{\"error\":{\"message\":\"Invalid value for 'max_output_tokens'.\",\"type\":\"invalid_request_error\","
+    "\"param\":\"max_output_tokens\",\"code\":\"integer_below_min_value\"}}";
+
+static bool findId(const std::string& json, char* out, size_t outSize) {
+    return ResponseChain::findResponseId(json.data(), json.size(), out, outSize);
+}
+
+// Chain on a response whose created event carried id
+static void completeExchange(ResponseChain& chain, const char* id) {
+    std::string json = std::string("{\"type\":\"response.created\",\"response\":{\"id\":\"") + id + "\"}}";
+    chain.beginRequest();
+    TEST_ASSERT_TRUE(chain.onCreated(json.data(), json.size()));
+    chain.commit();
+}
+
+void test_finds_the_response_id() {
+    char id[RESPONSE_ID_MAX];
+    TEST_ASSERT_TRUE(findId(CREATED, id, sizeof(id)));
+    TEST_ASSERT_EQUAL_STRING("resp_68a1b2", id);
+    TEST_ASSERT_TRUE(findId("{\"response\": {\"id\" :\n \"resp_x\"}}", id, sizeof(id)));
+    TEST_ASSERT_EQUAL_STRING("resp_x", id);
+}
+
+void test_truncated_created_event() {
+    std::string full(CREATED);
+    size_t idEnd = full.find("resp_68a1b2") + strlen("resp_68a1b2");
+    char id[RESPONSE_ID_MAX];
+
+    // Cut anywhere after the id: still found
+    for (size_t len = idEnd + 1; len <= full.size(); len++) {
+        TEST_ASSERT_TRUE(findId(full.substr(0, len), id, sizeof(id)));
+        TEST_ASSERT_EQUAL_STRING("resp_68a1b2", id);
+    }
+    // Cut before its closing quote: nothing, not a partial id
+    strcpy(id, "unchanged");
+    for (size_t len = 0; len <= idEnd; len++) {
+        TEST_ASSERT_FALSE(findId(full.substr(0, len), id, sizeof(id)));
+    }
+    TEST_ASSERT_EQUAL_STRING("unchanged", id);
+}
+
+void test_rejects_escaped_empty_and_oversized_ids() {
+    char id[16];
+    TEST_ASSERT_FALSE(findId("{\"response\":{\"id\":\"resp_\\\"x\"}}", id, sizeof(id)));
+    TEST_ASSERT_FALSE(findId("{\"response\":{\"id\":\"resp\\u005fx\"}}", id, sizeof(id)));
+    TEST_ASSERT_FALSE(findId("{\"response\":{\"id\":\"\"}}", id, sizeof(id)));
+    TEST_ASSERT_FALSE(findId("{\"response\":{\"id\":\"resp_0123456789a\"}}", id, sizeof(id)));   // No room for the NUL
+    TEST_ASSERT_TRUE(findId("{\"response\":{\"id\":\"resp_0123456789\"}}", id, sizeof(id)));
+    TEST_ASSERT_EQUAL_STRING("resp_0123456789", id);
+    // A number is not an id; nor is a key merely ending in id
+    TEST_ASSERT_FALSE(findId("{\"id\":42,\"item_id\":\"x\"}", id, sizeof(id)));
+
+    // An oversized id never becomes the chain
+    ResponseChain chain;
+    std::string longId(RESPONSE_ID_MAX, 'r');
+    std::string json = "{\"response\":{\"id\":\"" + longId + "\"}}";
+    chain.beginRequest();
+    TEST_ASSERT_FALSE(chain.onCreated(json.data(), json.size()));
+    chain.commit();
+    TEST_ASSERT_FALSE(chain.active());
+}
+
+void test_commit_and_rollback() {
+    ResponseChain chain;
+    TEST_ASSERT_FALSE(chain.active());
+    completeExchange(chain, "resp_1");
+    TEST_ASSERT_EQUAL_STRING("resp_1", chain.id());
+    completeExchange(chain, "resp_2");
+    TEST_ASSERT_EQUAL_STRING("resp_2", chain.id());
+
+    // Cancelled after completing: continue from the one before
+    chain.rollback();
+    TEST_ASSERT_EQUAL_STRING("resp_1", chain.id());
+
+    // Created event lost: start over from the local history
+    chain.beginRequest();
+    chain.commit();
+    TEST_ASSERT_FALSE(chain.active());
+}
+
+void test_resends_only_when_chain_is_gone() {
+    ResponseChain chain;
+    completeExchange(chain, "resp_1");
+
+    // Ordinary request errors keep the chain
+    TEST_ASSERT_FALSE(chain.onRejected(400, BAD_REQUEST, strlen(BAD_REQUEST)));
+    TEST_ASSERT_FALSE(chain.onRejected(404, "", 0));
+    TEST_ASSERT_FALSE(chain.onRejected(500, NOT_FOUND, strlen(NOT_FOUND)));
+    TEST_ASSERT_EQUAL_STRING("resp_1", chain.id());
+
+    // Body cut before the code: not enough to drop it
+    size_t cut = strstr(NOT_FOUND, "previous_response_not_found") - NOT_FOUND + 10;
+    TEST_ASSERT_FALSE(chain.onRejected(400, NOT_FOUND, cut));
+    TEST_ASSERT_TRUE(chain.active());
+
+    TEST_ASSERT_TRUE(chain.onRejected(400, NOT_FOUND, strlen(NOT_FOUND)));
+    TEST_ASSERT_FALSE(chain.active());
+
+    // The resend completes and chains on again; nothing to roll back to
+    completeExchange(chain, "resp_2");
+    TEST_ASSERT_EQUAL_STRING("resp_2", chain.id());
+    chain.rollback();
+    TEST_ASSERT_FALSE(chain.active());
+}
+
+void test_unchained_request_is_never_resent() {
+    ResponseChain chain;
+    TEST_ASSERT_FALSE(chain.onRejected(404, NOT_FOUND, strlen(NOT_FOUND)));
+    TEST_ASSERT_TRUE(ResponseChain::isChainNotFound(NOT_FOUND, strlen(NOT_FOUND)));
+    TEST_ASSERT_FALSE(ResponseChain::isChainNotFound(BAD_REQUEST, strlen(BAD_REQUEST)));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_finds_the_response_id);
+    RUN_TEST(test_truncated_created_event);
+    RUN_TEST(test_rejects_escaped_empty_and_oversized_ids);
+    RUN_TEST(test_commit_and_rollback);
+    RUN_TEST(test_resends_only_when_chain_is_gone);
+    RUN_TEST(test_unchained_request_is_never_resent);
+    return UNITY_END();
+}
@@ -0,0 +1,285 @@
+// AudioRingBuffer host tests: wraparound, spans, watermarks, tiering, SPSC.
+#include <unity.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <random>
+#include "AudioRingBuffer.h"
+
+static std::vector<uint8_t> pattern(size_t len, uint32_t seed) {
+    std::vector<uint8_t> v(len);
+    std::mt19937 rng(seed);
+    for (auto& b : v) b = (uint8_t)rng();
+    return v;
+}
+
+void setUp() {
+    ESP.psramSize = 4 * 1024 * 1024;
+}
+
+void tearDown() {}
+
+void test_capacity_rounds_down_to_power_of_two() {
+    AudioRingBuffer rb(3000);
+    TEST_ASSERT_TRUE(rb.isAllocated());
+    TEST_ASSERT_EQUAL_UINT32(2048, rb.capacity());
+    TEST_ASSERT_EQUAL_UINT32(2048, rb.space());
+    TEST_ASSERT_EQUAL_UINT32(0, rb.available());
+}
+
+void test_internal_fallback_without_psram() {
+    ESP.psramSize = 0;
+    AudioRingBuffer rb(1024 * 1024);
+    TEST_ASSERT_TRUE(rb.isAllocated());
+    TEST_ASSERT_EQUAL_UINT32(128 * 1024, rb.capacity());
+    TEST_ASSERT_FALSE(rb.enableHotTier(4096));
+}
+
+void test_write_stops_when_full() {
+    AudioRingBuffer rb(64);
+    auto data = pattern(100, 1);
+    TEST_ASSERT_EQUAL_UINT32(64, rb.write(data.data(), data.size()));
+    TEST_ASSERT_EQUAL_UINT32(0, rb.space());
+    TEST_ASSERT_EQUAL_UINT32(0, rb.write(data.data(), 1));
+}
+
+// The read() that straddles the end of storage must land the second segment
+// after the first one, not on top of it.
+void test_read_across_wrap() {
+    AudioRingBuffer rb(64);
+    auto junk = pattern(48, 2);
+    uint8_t sink[64];
+    rb.write(junk.data(), junk.size());
+    rb.read(sink, junk.size());
+
+    auto data = pattern(40, 3);  // 16 bytes at the end, 24 at the start
+    TEST_ASSERT_EQUAL_UINT32(40, rb.write(data.data(), data.size()));
+
+    memset(sink, 0, sizeof(sink));
+    TEST_ASSERT_EQUAL_UINT32(40, rb.read(sink, sizeof(sink)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(data.data(), sink, 40);
+    TEST_ASSERT_EQUAL_UINT32(0, rb.available());
+}
+
+void test_spans_are_contiguous_and_stop_at_wrap() {
+    AudioRingBuffer rb(64);
+    AudioRingBuffer::Span w = rb.acquireWrite();
+    TEST_ASSERT_EQUAL_UINT32(64, w.len);
+    rb.commitWrite(60);
+
+    AudioRingBuffer::Span r = rb.acquireRead(50);
+    TEST_ASSERT_EQUAL_UINT32(50, r.len);
+    rb.commitRead(50);
+
+    w = rb.acquireWrite();
+    TEST_ASSERT_EQUAL_UINT32(4, w.len);  // Up to the end of storage only
+    rb.commitWrite(4);
+    w = rb.acquireWrite();
+    TEST_ASSERT_EQUAL_UINT32(50, w.len);
+
+    r = rb.acquireRead();
+    TEST_ASSERT_EQUAL_UINT32(14, r.len);
+}
+
+static void randomized_roundtrip(AudioRingBuffer& rb, size_t total, uint32_t seed, bool useSpans) {
+    auto src = pattern(total, seed);
+    std::vector<uint8_t> dst(total);
+    std::mt19937 rng(seed ^ 0x5A5A);
+    size_t maxOp = rb.capacity() + rb.capacity() / 2;
+    size_t w = 0, r = 0;
+
+    while (r < total) {
+        size_t n = rng() % maxOp + 1;
+        if (w < total) {
+            if (n > total - w) n = total - w;
+            if (useSpans) {
+                AudioRingBuffer::Span s = rb.acquireWrite(n);
+                memcpy(s.data, &src[w], s.len);
+                rb.commitWrite(s.len);
+                w += s.len;
+            } else {
+                w += rb.write(&src[w], n);
+            }
+        }
+
+        n = rng() % maxOp + 1;
+        if (useSpans) {
+            AudioRingBuffer::Span s = rb.acquireRead(n);
+            memcpy(&dst[r], s.data, s.len);
+            rb.commitRead(s.len);
+            r += s.len;
+        } else {
+            r += rb.read(&dst[r], n);
+        }
+        TEST_ASSERT_EQUAL_UINT32(w - r, rb.available());
+    }
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(src.data(), dst.data(), total);
+}
+
+void test_randomized_wraparound_copy_api() {
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        AudioRingBuffer rb(64u << (seed % 6));
+        randomized_roundtrip(rb, 50000, seed, false);
+    }
+}
+
+void test_randomized_wraparound_span_api() {
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        AudioRingBuffer rb(64u << (seed % 6));
+        randomized_roundtrip(rb, 50000, seed, true);
+    }
+}
+
+void test_randomized_wraparound_tiered() {
+    for (uint32_t seed = 1; seed <= 20; seed++) {
+        AudioRingBuffer rb(4096);
+        TEST_ASSERT_TRUE(rb.enableHotTier(256u << (seed % 3)));
+        randomized_roundtrip(rb, 50000, seed, seed & 1);
+        TEST_ASSERT_EQUAL_UINT32(50000, rb.psramBytesWritten());
+        TEST_ASSERT_EQUAL_UINT32(50000, rb.psramBytesRead());
+    }
+}
+
+void test_watermark_and_drain_events() {
+    AudioRingBuffer rb(1024);
+    rb.setWatermarks(100, 200);
+    auto data = pattern(1024, 4);
+
+    TEST_ASSERT_FALSE(rb.waitForHighWater(0));
+    rb.write(data.data(), 99);
+    TEST_ASSERT_FALSE(rb.waitForHighWater(0));
+    rb.write(data.data(), 1);
+    TEST_ASSERT_TRUE(rb.waitForHighWater(0));
+    TEST_ASSERT_TRUE(rb.waitForData(0));
+
+    rb.write(data.data(), 924);  // Full
+    TEST_ASSERT_FALSE(rb.waitForSpace(0));
+    uint8_t sink[1024];
+    rb.read(sink, 900);  // 124 left: crosses the low watermark
+    TEST_ASSERT_TRUE(rb.waitForSpace(0));
+
+    TEST_ASSERT_FALSE(rb.waitForDrain(0));
+    rb.markEndOfStream();
+    TEST_ASSERT_FALSE(rb.waitForDrain(0));
+    rb.read(sink, sizeof(sink));
+    TEST_ASSERT_TRUE(rb.waitForDrain(0));
+    TEST_ASSERT_FALSE(rb.waitForData(0));
+
+    rb.clear();
+    TEST_ASSERT_FALSE(rb.isEndOfStream());
+    TEST_ASSERT_FALSE(rb.waitForDrain(0));
+}
+
+void test_end_of_stream_on_empty_buffer_drains_immediately() {
+    AudioRingBuffer rb(256);
+    rb.markEndOfStream();
+    TEST_ASSERT_TRUE(rb.waitForDrain(0));
+    TEST_ASSERT_TRUE(rb.waitForHighWater(0));
+}
+
+// Real producer and consumer threads, blocking on the event group only.
+static void threaded_stream(bool tiered) {
+    const size_t TOTAL = 4 * 1024 * 1024;
+    AudioRingBuffer rb(16 * 1024);
+    rb.setWatermarks(2048, 8 * 1024);
+    if (tiered) TEST_ASSERT_TRUE(rb.enableHotTier(2048));
+
+    std::thread producer([&]() {
+        std::mt19937 rng(7);
+        size_t w = 0;
+        while (w < TOTAL) {
+            AudioRingBuffer::Span s = rb.acquireWrite(rng() % 3000 + 1);
+            if (s.len == 0) {
+                rb.waitForSpace(pdMS_TO_TICKS(50));
+                continue;
+            }
+            if (s.len > TOTAL - w) s.len = TOTAL - w;
+            for (size_t i = 0; i < s.len; i++) s.data[i] = (uint8_t)((w + i) * 31);
+            rb.commitWrite(s.len);
+            w += s.len;
+        }
+        rb.markEndOfStream();
+    });
+
+    size_t r = 0;
+    bool ok = true;
+    rb.waitForHighWater(pdMS_TO_TICKS(5000));
+    while (true) {
+        AudioRingBuffer::Span s = rb.acquireRead(2048);
+        if (s.len == 0) {
+            if (!rb.waitForData(pdMS_TO_TICKS(50)) && rb.isEndOfStream()) break;
+            continue;
+        }
+        for (size_t i = 0; i < s.len && ok; i++) ok = s.data[i] == (uint8_t)((r + i) * 31);
+        rb.commitRead(s.len);
+        r += s.len;
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(ok);
+    TEST_ASSERT_EQUAL_UINT32(TOTAL, r);
+    TEST_ASSERT_TRUE(rb.waitForDrain(0));
+}
+
+void test_threaded_spsc_stream() {
+    threaded_stream(false);
+}
+
+void test_threaded_spsc_stream_tiered() {
+    threaded_stream(true);
+}
+
+// The producer reads the level, the consumer drains the ring and blocks,
+// then the producer publishes: the sleeping consumer must still wake.
+void test_wakeup_when_consumer_blocks_before_publish() {
+    AudioRingBuffer rb(256);
+    uint8_t byte = 0x5a;
+    TEST_ASSERT_EQUAL_UINT32(1, rb.write(&byte, 1));
+
+    std::thread consumer;
+    std::atomic<long> wokeAfterMs(-1);
+    std::chrono::steady_clock::time_point published;
+    bool once = false;
+    rb.beforePublish = [&]() {
+        if (once) return;
+        once = true;
+        uint8_t sink;
+        TEST_ASSERT_EQUAL_UINT32(1, rb.read(&sink, 1));
+        consumer = std::thread([&]() {
+            bool ok = rb.waitForData(pdMS_TO_TICKS(2000));
+            long ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                          std::chrono::steady_clock::now() - published).count();
+            wokeAfterMs = ok ? ms : -2;
+        });
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));  // Let it block
+        published = std::chrono::steady_clock::now();
+    };
+
+    AudioRingBuffer::Span s = rb.acquireWrite(1);
+    s.data[0] = 0xa5;
+    rb.commitWrite(1);    // Its level read still counts the byte just drained
+    consumer.join();
+
+    TEST_ASSERT_TRUE(wokeAfterMs.load() >= 0);
+    TEST_ASSERT_TRUE(wokeAfterMs.load() < 500);
+    TEST_ASSERT_EQUAL_UINT32(1, rb.available());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_capacity_rounds_down_to_power_of_two);
+    RUN_TEST(test_internal_fallback_without_psram);
+    RUN_TEST(test_write_stops_when_full);
+    RUN_TEST(test_read_across_wrap);
+    RUN_TEST(test_spans_are_contiguous_and_stop_at_wrap);
+    RUN_TEST(test_randomized_wraparound_copy_api);
+    RUN_TEST(test_randomized_wraparound_span_api);
+    RUN_TEST(test_randomized_wraparound_tiered);
+    RUN_TEST(test_watermark_and_drain_events);
+    RUN_TEST(test_end_of_stream_on_empty_buffer_drains_immediately);
+    RUN_TEST(test_threaded_spsc_stream);
+    RUN_TEST(test_threaded_spsc_stream_tiered);
+    RUN_TEST(test_wakeup_when_consumer_blocks_before_publish);
+    return UNITY_END();
+}
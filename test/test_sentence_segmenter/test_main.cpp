@@ -0,0 +1,124 @@
+#include <unity.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+#include <string>
+#include <vector>
+#include "SentenceSegmenter.h"
+
+void setUp() {}
+void tearDown() {}
+
+static std::vector<std::string> out;
+
+static void collect(SentenceSegmenter& s) {
+    out.clear();
+    s.setSink([](const char* text, size_t len) {
+        TEST_ASSERT_EQUAL(len, strlen(text));
+        out.push_back(std::string(text, len));
+    });
+}
+
+static const char ANSWER[] =
+    "Sure, here is the plan. First we check the weather in Lisbon, then we book the train. "
+    "It leaves at 9.30 and costs 12.5 euros! Want me to set a reminder?";
+
+void test_splits_at_sentences() {
+    SentenceSegmenter s;
+    collect(s);
+    s.push(ANSWER);
+    s.flush();
+
+    TEST_ASSERT_EQUAL(4, out.size());
+    TEST_ASSERT_EQUAL_STRING("Sure, here is the plan.", out[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("First we check the weather in Lisbon, then we book the train.", out[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("It leaves at 9.30 and costs 12.5 euros!", out[2].c_str());
+    TEST_ASSERT_EQUAL_STRING("Want me to set a reminder?", out[3].c_str());
+}
+
+void test_same_segments_for_any_delta_split() {
+    SentenceSegmenter ref;
+    collect(ref);
+    ref.push(ANSWER);
+    ref.flush();
+    std::vector<std::string> expected = out;
+
+    std::mt19937 rng(5);
+    size_t total = strlen(ANSWER);
+    for (int trial = 0; trial < 50; trial++) {
+        SentenceSegmenter s;
+        collect(s);
+        size_t pos = 0;
+        while (pos < total) {
+            size_t n = 1 + rng() % 9;
+            if (n > total - pos) n = total - pos;
+            s.push(ANSWER + pos, n);
+            pos += n;
+        }
+        s.flush();
+        TEST_ASSERT_EQUAL(expected.size(), out.size());
+        for (size_t i = 0; i < out.size(); i++) TEST_ASSERT_EQUAL_STRING(expected[i].c_str(), out[i].c_str());
+    }
+}
+
+void test_first_clause_splits_early() {
+    SentenceSegmenter s;
+    collect(s);
+    s.push("Well, the short answer is yes, although it depends on the details, "
+           "which vary quite a lot from one case to another, as you would expect.");
+    s.flush();
+
+    // First segment at the first clause past 24 chars; later ones need 80
+    TEST_ASSERT_EQUAL(3, out.size());
+    TEST_ASSERT_EQUAL_STRING("Well, the short answer is yes,", out[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("although it depends on the details, which vary quite a lot from one case to another,",
+                             out[1].c_str());
+    TEST_ASSERT_EQUAL_STRING("as you would expect.", out[2].c_str());
+}
+
+void test_short_sentences_merge() {
+    SentenceSegmenter s;
+    collect(s);
+    s.push("Hi. Ok. That works for me.");
+    s.flush();
+    TEST_ASSERT_EQUAL(1, out.size());
+    TEST_ASSERT_EQUAL_STRING("Hi. Ok. That works for me.", out[0].c_str());
+}
+
+void test_long_run_splits_at_space() {
+    SentenceSegmenter s;
+    collect(s);
+    std::string words;
+    while (words.size() < 600) words += "lorem ipsum ";
+    s.push(words.c_str());
+    s.flush();
+
+    TEST_ASSERT_TRUE(out.size() >= 3);
+    std::string joined;
+    for (auto& seg : out) {
+        TEST_ASSERT_TRUE(seg.size() <= SEGMENT_MAX_CHARS);
+        TEST_ASSERT_TRUE(seg.back() != ' ');
+        joined += seg + " ";
+    }
+    TEST_ASSERT_EQUAL_STRING(words.c_str(), joined.c_str());
+}
+
+void test_whitespace_only_emits_nothing() {
+    SentenceSegmenter s;
+    collect(s);
+    s.push("   \n  ");
+    s.flush();
+    TEST_ASSERT_EQUAL(0, out.size());
+    TEST_ASSERT_EQUAL_UINT32(0, s.segments());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_splits_at_sentences);
+    RUN_TEST(test_same_segments_for_any_delta_split);
+    RUN_TEST(test_first_clause_splits_early);
+    RUN_TEST(test_short_sentences_merge);
+    RUN_TEST(test_long_run_splits_at_space);
+    RUN_TEST(test_whitespace_only_emits_nothing);
+    return UNITY_END();
+}
@@ -0,0 +1,106 @@
+#include <unity.h>
+#include <vector>
+#include "SessionPreroll.h"
+
+void setUp() {}
+void tearDown() {}
+
+static std::vector<uint32_t> sent;
+
+static CaptureFrame frame(uint32_t index) {
+    CaptureFrame f = {};
+    f.firstSample = index * CAPTURE_FRAME_SAMPLES;
+    f.samples = CAPTURE_FRAME_SAMPLES;
+    f.pcm[0] = (int16_t)index;
+    return f;
+}
+
+static void makePreroll(SessionPreroll& p) {
+    sent.clear();
+    p.setSink([](const CaptureFrame& f) { sent.push_back(f.firstSample / CAPTURE_FRAME_SAMPLES); });
+}
+
+void test_passes_through_when_ready() {
+    SessionPreroll p(8);
+    makePreroll(p);
+    for (uint32_t i = 0; i < 5; i++) p.process(frame(i), true);
+    TEST_ASSERT_EQUAL(5, sent.size());
+    TEST_ASSERT_EQUAL(0, p.pending());
+}
+
+void test_replays_held_frames_in_order() {
+    SessionPreroll p(8);
+    makePreroll(p);
+    for (uint32_t i = 0; i < 3; i++) p.process(frame(i), false);
+    TEST_ASSERT_EQUAL(0, sent.size());
+    TEST_ASSERT_EQUAL(3, p.pending());
+
+    p.process(frame(3), true);
+    const uint32_t expected[] = {0, 1, 2, 3};
+    TEST_ASSERT_EQUAL(4, sent.size());
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, sent.data(), 4);
+    TEST_ASSERT_EQUAL_UINT32(3, p.framesReplayed());
+}
+
+void test_keeps_most_recent_when_full() {
+    SessionPreroll p(4);
+    makePreroll(p);
+    for (uint32_t i = 0; i < 10; i++) p.process(frame(i), false);
+    TEST_ASSERT_EQUAL_UINT32(6, p.framesLost());
+
+    p.flush();
+    const uint32_t expected[] = {6, 7, 8, 9};
+    TEST_ASSERT_EQUAL(4, sent.size());
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, sent.data(), 4);
+}
+
+void test_skips_frames_already_sent() {
+    SessionPreroll p(8);
+    makePreroll(p);
+    for (uint32_t i = 0; i < 4; i++) p.process(frame(i), true);
+
+    // Session drops; the same frames arrive again (e.g. replayed upstream)
+    // together with new ones
+    for (uint32_t i = 2; i < 6; i++) p.process(frame(i), false);
+    p.flush();
+
+    const uint32_t expected[] = {0, 1, 2, 3, 4, 5};
+    TEST_ASSERT_EQUAL(6, sent.size());
+    TEST_ASSERT_EQUAL_UINT32_ARRAY(expected, sent.data(), 6);
+    TEST_ASSERT_EQUAL_UINT32(2, p.duplicatesSkipped());
+}
+
+void test_reset_drops_held_frames() {
+    SessionPreroll p(8);
+    makePreroll(p);
+    for (uint32_t i = 0; i < 3; i++) p.process(frame(i), false);
+    p.reset();
+    p.process(frame(10), true);
+    TEST_ASSERT_EQUAL(1, sent.size());
+    TEST_ASSERT_EQUAL_UINT32(10, sent[0]);
+}
+
+void test_index_wraps() {
+    SessionPreroll p(4);
+    makePreroll(p);
+    CaptureFrame a = frame(0);
+    a.firstSample = 0xFFFFFFFFu - CAPTURE_FRAME_SAMPLES + 1;
+    CaptureFrame b = frame(0);
+    b.firstSample = 0;   // Right after a, across the wrap
+    p.process(a, true);
+    p.process(b, true);
+    p.process(a, true);  // Behind: duplicate
+    TEST_ASSERT_EQUAL(2, sent.size());
+    TEST_ASSERT_EQUAL_UINT32(1, p.duplicatesSkipped());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_passes_through_when_ready);
+    RUN_TEST(test_replays_held_frames_in_order);
+    RUN_TEST(test_keeps_most_recent_when_full);
+    RUN_TEST(test_skips_frames_already_sent);
+    RUN_TEST(test_reset_drops_held_frames);
+    RUN_TEST(test_index_wraps);
+    return UNITY_END();
+}
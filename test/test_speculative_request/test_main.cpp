@@ -0,0 +1,139 @@
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "SpeculativeRequest.h"
+
+void setUp() {}
+void tearDown() {}
+
+// Stands in for LLMClient: requests run until fail() or answer()
+struct FakeClient {
+    std::vector<std::string> sent;
+    std::string response;
+    bool running = false;
+    bool refuse = false;
+    int cancels = 0;
+
+    bool startChat(const char* text) {
+        if (refuse) return false;
+        sent.push_back(text);
+        response = "";
+        running = true;
+        return true;
+    }
+    bool poll() { return running; }
+    const std::string& responseSoFar() const { return response; }
+    void cancel() {
+        cancels++;
+        running = false;
+        response = "";
+    }
+
+    // LLMClient::finish(false): done, text cleared
+    void fail() {
+        running = false;
+        response = "";
+    }
+    void answer(const char* text) {
+        running = false;
+        response = text;
+    }
+};
+
+void test_hit_takes_over_running_request() {
+    FakeClient llm;
+    SpeculativeRequest<FakeClient> spec;
+    spec.setClient(&llm);
+    TEST_ASSERT_TRUE(spec.start("What time is it?", 100));
+    TEST_ASSERT_TRUE(spec.service());
+
+    TEST_ASSERT_TRUE(spec.ask("what time is it"));
+    TEST_ASSERT_EQUAL(SpeculativeRequest<FakeClient>::HIT, spec.outcome());
+    TEST_ASSERT_EQUAL(1, llm.sent.size());      // Not asked again
+    TEST_ASSERT_EQUAL(0, llm.cancels);
+    TEST_ASSERT_FALSE(spec.active());
+}
+
+void test_finished_with_text_is_still_a_hit() {
+    FakeClient llm;
+    SpeculativeRequest<FakeClient> spec;
+    spec.setClient(&llm);
+    spec.start("Hello there.", 0);
+    llm.answer("Hi!");
+    TEST_ASSERT_TRUE(spec.service());
+    TEST_ASSERT_TRUE(spec.ask("Hello there."));
+    TEST_ASSERT_EQUAL(SpeculativeRequest<FakeClient>::HIT, spec.outcome());
+    TEST_ASSERT_EQUAL(1, llm.sent.size());
+}
+
+void test_failed_speculation_still_sends_final_text() {
+    FakeClient llm;
+    SpeculativeRequest<FakeClient> spec;
+    spec.setClient(&llm);
+    spec.start("Turn on the lights.", 0);
+    llm.fail();
+
+    // Same words, but the request is dead: the final text goes out itself
+    TEST_ASSERT_TRUE(spec.ask("Turn on the lights."));
+    TEST_ASSERT_EQUAL(SpeculativeRequest<FakeClient>::DEAD, spec.outcome());
+    TEST_ASSERT_EQUAL(2, llm.sent.size());
+    TEST_ASSERT_EQUAL_STRING("Turn on the lights.", llm.sent[1].c_str());
+    TEST_ASSERT_TRUE(llm.running);
+    TEST_ASSERT_EQUAL(1, spec.failed());
+    TEST_ASSERT_EQUAL(0, spec.hits());
+}
+
+void test_service_drops_dead_request_for_a_retry() {
+    FakeClient llm;
+    SpeculativeRequest<FakeClient> spec;
+    spec.setClient(&llm);
+    spec.start("Play some music.", 0);
+    llm.fail();
+
+    TEST_ASSERT_FALSE(spec.service());
+    TEST_ASSERT_FALSE(spec.active());
+    TEST_ASSERT_EQUAL(1, llm.cancels);
+
+    // A later partial can speculate again
+    TEST_ASSERT_TRUE(spec.start("Play some music please.", 50));
+    TEST_ASSERT_TRUE(spec.ask("Play some music please"));
+    TEST_ASSERT_EQUAL(SpeculativeRequest<FakeClient>::HIT, spec.outcome());
+    TEST_ASSERT_EQUAL(2, llm.sent.size());
+}
+
+void test_miss_cancels_and_sends_final_text() {
+    FakeClient llm;
+    SpeculativeRequest<FakeClient> spec;
+    spec.setClient(&llm);
+    spec.start("What is the weather.", 0);
+
+    TEST_ASSERT_TRUE(spec.ask("What is the weather tomorrow?"));
+    TEST_ASSERT_EQUAL(SpeculativeRequest<FakeClient>::MISS, spec.outcome());
+    TEST_ASSERT_EQUAL(1, llm.cancels);
+    TEST_ASSERT_EQUAL_STRING("What is the weather tomorrow?", llm.sent.back().c_str());
+}
+
+void test_no_speculation_just_asks() {
+    FakeClient llm;
+    SpeculativeRequest<FakeClient> spec;
+    spec.setClient(&llm);
+    TEST_ASSERT_TRUE(spec.ask("Hello"));
+    TEST_ASSERT_EQUAL(SpeculativeRequest<FakeClient>::NONE, spec.outcome());
+    TEST_ASSERT_EQUAL(1, llm.sent.size());
+
+    llm.refuse = true;
+    TEST_ASSERT_FALSE(spec.start("Hi.", 0));
+    TEST_ASSERT_FALSE(spec.active());
+    TEST_ASSERT_FALSE(spec.ask("Hi"));
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_hit_takes_over_running_request);
+    RUN_TEST(test_finished_with_text_is_still_a_hit);
+    RUN_TEST(test_failed_speculation_still_sends_final_text);
+    RUN_TEST(test_service_drops_dead_request_for_a_retry);
+    RUN_TEST(test_miss_cancels_and_sends_final_text);
+    RUN_TEST(test_no_speculation_just_asks);
+    return UNITY_END();
+}
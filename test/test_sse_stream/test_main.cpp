@@ -0,0 +1,209 @@
+#include <unity.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "ChunkedDecoder.h"
+#include "SseParser.h"
+
+void setUp() {}
+void tearDown() {}
+
+struct Event {
+    std::string name;
+    std::string data;
+    bool truncated;
+};
+
+// Shaped like a Responses API stream: event + data lines, tokens that are
+// all hex digits ("add", "cafe", "0"), a keep-alive comment
+static std::string sampleStream() {
+    const char* deltas[] = {"He", "llo", " add", " cafe", " 0", "!", " \\u00e9t\\u00e9", " done."};
+    std::string s = "event: response.created\ndata: {\"type\":\"response.created\",\"response\":{\"id\":\"resp_1\"}}\n\n";
+    s += ": keep-alive\n\n";
+    for (const char* d : deltas) {
+        s += "event: response.output_text.delta\n";
+        s += "data: {\"type\":\"response.output_text.delta\",\"item_id\":\"msg_1\",\"delta\":\"";
+        s += d;
+        s += "\"}\n\n";
+    }
+    s += "event: response.completed\ndata: {\"type\":\"response.completed\",\"response\":{\"status\":\"completed\"}}\n\n";
+    return s;
+}
+
+static uint32_t nextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed >> 8;
+}
+
+// Chunked encoding with chunk sizes that cut lines anywhere
+static std::string encodeChunked(const std::string& body, uint32_t seed) {
+    std::string out;
+    size_t pos = 0;
+    char size[16];
+    while (pos < body.size()) {
+        size_t n = 1 + nextRandom(seed) % 97;
+        if (n > body.size() - pos) n = body.size() - pos;
+        snprintf(size, sizeof(size), "%zx\r\n", n);
+        out += size;
+        out.append(body, pos, n);
+        out += "\r\n";
+        pos += n;
+    }
+    out += "0\r\n\r\n";
+    return out;
+}
+
+// Feeds in pieces of 1..maxPiece bytes
+template <class Feed>
+static void feedSplit(const std::string& s, uint32_t seed, size_t maxPiece, Feed feed) {
+    size_t pos = 0;
+    while (pos < s.size()) {
+        size_t n = 1 + nextRandom(seed) % maxPiece;
+        if (n > s.size() - pos) n = s.size() - pos;
+        feed(s.data() + pos, n);
+        pos += n;
+    }
+}
+
+static std::vector<Event> parseWhole(const std::string& s) {
+    std::vector<Event> events;
+    SseParser parser;
+    parser.setHandler([&](SseEvent& e) { events.push_back({e.name, std::string(e.data, e.dataLen), e.truncated}); });
+    parser.feed(s.data(), s.size());
+    return events;
+}
+
+void test_chunked_decodes_random_splits() {
+    std::string body = sampleStream();
+    for (uint32_t seed = 1; seed <= 200; seed++) {
+        std::string wire = encodeChunked(body, seed);
+        std::string out;
+        ChunkedDecoder dec;
+        dec.setSink([&](const char* d, size_t n) { out.append(d, n); });
+        size_t consumed = 0;
+        feedSplit(wire, seed * 7, 1 + seed % 64, [&](const char* d, size_t n) { consumed += dec.feed(d, n); });
+        TEST_ASSERT_TRUE(dec.done());
+        TEST_ASSERT_EQUAL(wire.size(), consumed);
+        TEST_ASSERT_TRUE(out == body);
+    }
+}
+
+void test_chunked_extensions_trailers_and_bare_lf() {
+    std::string wire = "5;name=value\r\nHello\r\n6\n World\n0\r\nX-Trailer: 1\r\n\r\n";
+    std::string out;
+    ChunkedDecoder dec;
+    dec.setSink([&](const char* d, size_t n) { out.append(d, n); });
+    TEST_ASSERT_EQUAL(wire.size(), dec.feed(wire.data(), wire.size()));
+    TEST_ASSERT_TRUE(dec.done());
+    TEST_ASSERT_EQUAL_STRING("Hello World", out.c_str());
+}
+
+void test_chunked_stops_at_end_of_body() {
+    // Whatever follows the body belongs to the next response
+    std::string wire = "3\r\nabc\r\n0\r\n\r\nHTTP/1.1 200 OK";
+    ChunkedDecoder dec;
+    size_t consumed = dec.feed(wire.data(), wire.size());
+    TEST_ASSERT_TRUE(dec.done());
+    TEST_ASSERT_EQUAL(wire.size() - strlen("HTTP/1.1 200 OK"), consumed);
+    TEST_ASSERT_EQUAL(0, dec.feed("x", 1));
+}
+
+void test_chunked_rejects_malformed() {
+    const char* bad[] = {
+        "zz\r\nabc\r\n",            // Not a size
+        "3\r\nabcd\r\n",            // Data longer than the size
+        "\r\nabc\r\n",              // Empty size
+        "123456789\r\n",            // Size too large
+    };
+    for (const char* w : bad) {
+        ChunkedDecoder dec;
+        dec.feed(w, strlen(w));
+        TEST_ASSERT_TRUE(dec.failed());
+        TEST_ASSERT_FALSE(dec.done());
+    }
+}
+
+void test_sse_parses_events() {
+    std::string s =
+        ": comment\n"
+        "event: first\n"
+        "data: one\n\n"
+        "data:two\r\n"
+        "data:  three\r\n"
+        "id: 7\r\n"
+        "\r\n"
+        "retry: 100\n\n"            // No data: no event
+        "data\rdata: x\r\r";        // Empty data line, CR line ends
+    std::vector<Event> ev = parseWhole(s);
+    TEST_ASSERT_EQUAL(3, ev.size());
+    TEST_ASSERT_EQUAL_STRING("first", ev[0].name.c_str());
+    TEST_ASSERT_EQUAL_STRING("one", ev[0].data.c_str());
+    TEST_ASSERT_EQUAL_STRING("", ev[1].name.c_str());
+    TEST_ASSERT_EQUAL_STRING("two\n three", ev[1].data.c_str());
+    TEST_ASSERT_EQUAL_STRING("\nx", ev[2].data.c_str());
+}
+
+void test_sse_random_splits_match_whole() {
+    std::string body = sampleStream();
+    std::vector<Event> whole = parseWhole(body);
+    TEST_ASSERT_EQUAL(10, whole.size());
+    TEST_ASSERT_EQUAL_STRING("response.output_text.delta", whole[3].name.c_str());
+    TEST_ASSERT_TRUE(whole[3].data.find("\"delta\":\" add\"") != std::string::npos);
+
+    // Captured stream through the decoder, the socket cutting it anywhere
+    for (uint32_t seed = 1; seed <= 200; seed++) {
+        std::string wire = encodeChunked(body, seed + 1000);
+        std::vector<Event> events;
+        SseParser parser;
+        parser.setHandler([&](SseEvent& e) { events.push_back({e.name, std::string(e.data, e.dataLen), e.truncated}); });
+        ChunkedDecoder dec;
+        dec.setSink([&](const char* d, size_t n) { parser.feed(d, n); });
+        feedSplit(wire, seed, 1 + seed % 32, [&](const char* d, size_t n) { dec.feed(d, n); });
+
+        TEST_ASSERT_TRUE(dec.done());
+        TEST_ASSERT_EQUAL(whole.size(), events.size());
+        for (size_t i = 0; i < whole.size(); i++) {
+            TEST_ASSERT_TRUE(whole[i].name == events[i].name);
+            TEST_ASSERT_TRUE(whole[i].data == events[i].data);
+        }
+    }
+}
+
+void test_sse_crlf_split_between_pieces() {
+    // A CR at the end of one piece and its LF at the start of the next is one line end
+    std::vector<Event> events;
+    SseParser parser;
+    parser.setHandler([&](SseEvent& e) { events.push_back({e.name, std::string(e.data, e.dataLen), e.truncated}); });
+    parser.feed("data: a\r", 8);
+    parser.feed("\ndata: b\r", 9);
+    parser.feed("\n\r", 2);
+    parser.feed("\n", 1);
+    TEST_ASSERT_EQUAL(1, events.size());
+    TEST_ASSERT_EQUAL_STRING("a\nb", events[0].data.c_str());
+}
+
+void test_sse_truncates_oversized_event() {
+    std::string big = "{\"type\":\"response.completed\",\"response\":{\"output_text\":\"" +
+                      std::string(SSE_DATA_MAX * 2, 'x') + "\"}}";
+    std::string s = "data: " + big + "\n\ndata: next\n\n";
+    std::vector<Event> ev = parseWhole(s);
+    TEST_ASSERT_EQUAL(2, ev.size());
+    TEST_ASSERT_TRUE(ev[0].truncated);
+    TEST_ASSERT_EQUAL(SSE_DATA_MAX - 1, ev[0].data.size());
+    TEST_ASSERT_TRUE(ev[0].data.compare(0, 40, big, 0, 40) == 0);
+    TEST_ASSERT_FALSE(ev[1].truncated);
+    TEST_ASSERT_EQUAL_STRING("next", ev[1].data.c_str());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_chunked_decodes_random_splits);
+    RUN_TEST(test_chunked_extensions_trailers_and_bare_lf);
+    RUN_TEST(test_chunked_stops_at_end_of_body);
+    RUN_TEST(test_chunked_rejects_malformed);
+    RUN_TEST(test_sse_parses_events);
+    RUN_TEST(test_sse_random_splits_match_whole);
+    RUN_TEST(test_sse_crlf_split_between_pieces);
+    RUN_TEST(test_sse_truncates_oversized_event);
+    return UNITY_END();
+}
@@ -0,0 +1,143 @@
+#include <unity.h>
+#include <vector>
+#include "UplinkPacketizer.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t RATE = 24000;
+static const size_t FRAME = 256;   // One capture frame, ~10.7 ms
+
+// Feeds frames of a ramp until a packet is ready; returns the packet size
+static size_t fillPacket(UplinkPacketizer& p, int16_t& next) {
+    int16_t frame[FRAME];
+    for (int guard = 0; guard < 1000 && !p.packetReady(); guard++) {
+        for (size_t i = 0; i < FRAME; i++) frame[i] = next + (int16_t)i;
+        size_t used = p.append(frame, FRAME);
+        next += (int16_t)used;  // The unused tail is dropped; only sizes matter here
+    }
+    return p.packetSamples();
+}
+
+void test_coalesces_frames_in_order() {
+    UplinkPacketizer p;
+    TEST_ASSERT_TRUE(p.begin(RATE, 20, 200, 40));
+    TEST_ASSERT_EQUAL_UINT32(40, p.packetMs());
+
+    std::vector<int16_t> in(FRAME * 10);
+    for (size_t i = 0; i < in.size(); i++) in[i] = (int16_t)i;
+
+    std::vector<int16_t> out;
+    const int16_t* src = in.data();
+    size_t left = in.size();
+    int packets = 0;
+    while (left > 0) {
+        size_t used = p.append(src, left < FRAME ? left : FRAME);
+        src += used;
+        left -= used;
+        if (p.packetReady()) {
+            TEST_ASSERT_EQUAL(960, p.packetSamples());  // 40 ms, split mid-frame
+            out.insert(out.end(), p.packet(), p.packet() + p.packetSamples());
+            p.packetSent(100, true);
+            packets++;
+        }
+    }
+    out.insert(out.end(), p.packet(), p.packet() + p.packetSamples());
+    p.packetSent(100, true);
+
+    TEST_ASSERT_EQUAL(2, packets);
+    TEST_ASSERT_EQUAL(in.size(), out.size());
+    TEST_ASSERT_EQUAL_INT16_ARRAY(in.data(), out.data(), in.size());
+    TEST_ASSERT_EQUAL(0, p.packetSamples());
+}
+
+void test_slow_or_failed_sends_grow_packets() {
+    UplinkPacketizer p;
+    TEST_ASSERT_TRUE(p.begin(RATE, 20, 200, 40));
+    int16_t next = 0;
+
+    // 40 ms of audio took 15 ms to send: over a quarter, so double
+    fillPacket(p, next);
+    p.packetSent(15000, true);
+    TEST_ASSERT_EQUAL_UINT32(80, p.packetMs());
+
+    fillPacket(p, next);
+    p.packetSent(0, false);
+    TEST_ASSERT_EQUAL_UINT32(160, p.packetMs());
+
+    fillPacket(p, next);
+    p.packetSent(100000, true);
+    TEST_ASSERT_EQUAL_UINT32(200, p.packetMs());  // Capped
+    TEST_ASSERT_EQUAL(4800, fillPacket(p, next));
+    TEST_ASSERT_EQUAL_UINT32(3, p.stats().grows);
+}
+
+void test_cheap_sends_shrink_back_to_minimum() {
+    UplinkPacketizer p;
+    TEST_ASSERT_TRUE(p.begin(RATE, 20, 200, 200));
+    int16_t next = 0;
+
+    // A middling send interrupts the calm run
+    for (int i = 0; i < 15; i++) {
+        fillPacket(p, next);
+        p.packetSent(500, true);
+    }
+    fillPacket(p, next);
+    p.packetSent(30000, true);   // 15% of 200 ms: neither cheap nor slow
+    TEST_ASSERT_EQUAL_UINT32(200, p.packetMs());
+
+    for (int i = 0; i < 16 * 20; i++) {
+        fillPacket(p, next);
+        p.packetSent(500, true);
+    }
+    TEST_ASSERT_EQUAL_UINT32(20, p.packetMs());
+    TEST_ASSERT_TRUE(p.stats().shrinks > 0);
+    TEST_ASSERT_EQUAL_UINT32(0, p.stats().grows);
+}
+
+void test_partial_flush_does_not_adapt() {
+    UplinkPacketizer p;
+    TEST_ASSERT_TRUE(p.begin(RATE, 20, 200, 40));
+    int16_t frame[FRAME] = {0};
+    TEST_ASSERT_EQUAL(FRAME, p.append(frame, FRAME));
+    TEST_ASSERT_FALSE(p.packetReady());
+
+    // A one-frame flush that took "long" says nothing about the link
+    p.packetSent(20000, true);
+    TEST_ASSERT_EQUAL_UINT32(40, p.packetMs());
+    TEST_ASSERT_EQUAL_UINT32(1, p.stats().packets);
+    TEST_ASSERT_EQUAL_UINT32(20000, p.stats().maxSendUs);
+}
+
+void test_wire_estimate() {
+    // Small frame: 2 + 4 mask, one record
+    TEST_ASSERT_EQUAL(1, UplinkPacketizer::tlsRecords(100));
+    TEST_ASSERT_EQUAL(100 + 6 + 29, UplinkPacketizer::wireBytes(100));
+    // Extended 16-bit length, split over two 4 KB records
+    TEST_ASSERT_EQUAL(2, UplinkPacketizer::tlsRecords(5000));
+    TEST_ASSERT_EQUAL(5000 + 8 + 2 * 29, UplinkPacketizer::wireBytes(5000));
+}
+
+void test_rejects_bad_config() {
+    UplinkPacketizer p;
+    TEST_ASSERT_FALSE(p.begin(0, 20, 200, 40));
+    TEST_ASSERT_FALSE(p.begin(RATE, 0, 200, 40));
+    TEST_ASSERT_FALSE(p.begin(RATE, 200, 20, 40));
+    TEST_ASSERT_FALSE(p.isReady());
+
+    // Start outside the range is clamped
+    TEST_ASSERT_TRUE(p.begin(RATE, 20, 200, 500));
+    TEST_ASSERT_EQUAL_UINT32(200, p.packetMs());
+    TEST_ASSERT_EQUAL(4800, p.maxPacketSamples());
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_coalesces_frames_in_order);
+    RUN_TEST(test_slow_or_failed_sends_grow_packets);
+    RUN_TEST(test_cheap_sends_shrink_back_to_minimum);
+    RUN_TEST(test_partial_flush_does_not_adapt);
+    RUN_TEST(test_wire_estimate);
+    RUN_TEST(test_rejects_bad_config);
+    return UNITY_END();
+}
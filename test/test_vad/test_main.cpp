@@ -0,0 +1,168 @@
+// VAD and uplink gate host tests on synthetic voiced speech and noise.
+#include <unity.h>
+#include <math.h>
+#include <random>
+#include <vector>
+#include "VoiceActivityDetector.h"
+#include "UplinkGate.h"
+#include "AudioDsp.h"
+
+void setUp() {}
+void tearDown() {}
+
+static const uint32_t RATE = 24000;
+static const size_t FRAME = 256;
+
+// Voiced "vowel": 140 Hz pulse train through two formant-ish resonances
+static void addVowel(std::vector<float>& x, size_t from, size_t to, float amp) {
+    for (size_t i = from; i < to && i < x.size(); i++) {
+        float t = (float)i / RATE;
+        float v = 0;
+        for (int h = 1; h <= 25; h++) {
+            float f = 140.0f * h;
+            float g = expf(-powf((f - 700.0f) / 300.0f, 2)) + 0.6f * expf(-powf((f - 1800.0f) / 400.0f, 2));
+            v += g * sinf(2.0f * (float)M_PI * f * t);
+        }
+        x[i] += amp * v;
+    }
+}
+
+static void addNoise(std::vector<float>& x, float amp, uint32_t seed, bool lowpass) {
+    std::mt19937 rng(seed);
+    std::normal_distribution<float> gauss(0.0f, 1.0f);
+    float lp = 0;
+    for (auto& v : x) {
+        float n = gauss(rng);
+        if (lowpass) {
+            lp = 0.95f * lp + 0.05f * n;  // Rumble: fans, HVAC
+            n = lp * 4.0f;
+        }
+        v += amp * n;
+    }
+}
+
+static std::vector<CaptureFrame> toFrames(const std::vector<float>& x) {
+    std::vector<CaptureFrame> frames(x.size() / FRAME);
+    for (size_t f = 0; f < frames.size(); f++) {
+        frames[f].firstSample = f * FRAME;
+        frames[f].samples = FRAME;
+        for (size_t i = 0; i < FRAME; i++) {
+            frames[f].pcm[i] = AudioDsp::saturate16((int32_t)lrintf(x[f * FRAME + i]));
+        }
+    }
+    return frames;
+}
+
+void test_detects_speech_in_noise() {
+    std::vector<float> x(RATE * 4, 0.0f);
+    addNoise(x, 150.0f, 1, false);
+    addVowel(x, RATE * 2, RATE * 3, 2000.0f);   // Speech from 2 s to 3 s
+
+    VoiceActivityDetector vad;
+    TEST_ASSERT_TRUE(vad.begin(RATE));
+    vad.setHangoverFrames(10);
+    int starts = 0, stops = 0;
+    size_t startFrame = 0, stopFrame = 0, frame = 0;
+    vad.onSpeechStart([&]() { starts++; startFrame = frame; });
+    vad.onSpeechStop([&]() { stops++; stopFrame = frame; });
+
+    for (auto& f : toFrames(x)) {
+        vad.process(f.pcm, f.samples);
+        frame++;
+    }
+
+    TEST_ASSERT_EQUAL_INT(1, starts);
+    TEST_ASSERT_EQUAL_INT(1, stops);
+    size_t onset = RATE * 2 / FRAME;
+    size_t offset = RATE * 3 / FRAME;
+    TEST_ASSERT_TRUE(startFrame >= onset && startFrame <= onset + 3);
+    TEST_ASSERT_TRUE(stopFrame > offset + 9 && stopFrame <= offset + 13);
+}
+
+void test_ignores_loud_stationary_noise() {
+    // Broadband hiss and low rumble, both well above the initial floor guess
+    for (int lowpass = 0; lowpass < 2; lowpass++) {
+        std::vector<float> x(RATE * 5, 0.0f);
+        addNoise(x, 2500.0f, 7 + lowpass, lowpass);
+
+        VoiceActivityDetector vad;
+        TEST_ASSERT_TRUE(vad.begin(RATE));
+        auto frames = toFrames(x);
+        size_t speech = 0;
+        for (size_t i = 0; i < frames.size(); i++) {
+            bool s = vad.process(frames[i].pcm, frames[i].samples);
+            if (i > frames.size() / 2 && s) speech++;  // After the floor has adapted
+        }
+        TEST_ASSERT_EQUAL_UINT32(0, speech);
+    }
+}
+
+void test_seeded_floor_detects_first_word() {
+    std::vector<float> x(RATE, 0.0f);
+    addNoise(x, 100.0f, 3, false);
+    addVowel(x, 0, RATE / 2, 1500.0f);  // Speaking from the very first frame
+
+    VoiceActivityDetector vad;
+    TEST_ASSERT_TRUE(vad.begin(RATE));
+    vad.setNoiseFloorRms(100.0f);
+    auto frames = toFrames(x);
+    bool detected = false;
+    for (size_t i = 0; i < 4; i++) detected |= vad.process(frames[i].pcm, frames[i].samples);
+    TEST_ASSERT_TRUE(detected);
+}
+
+void test_gate_sends_preroll_then_speech_in_order() {
+    std::vector<float> x(RATE * 3, 0.0f);
+    addNoise(x, 100.0f, 5, false);
+    addVowel(x, RATE, RATE * 2, 2000.0f);
+
+    UplinkGate gate(8);
+    TEST_ASSERT_TRUE(gate.begin(RATE));
+    gate.vad().setHangoverFrames(5);
+
+    std::vector<uint32_t> sent;
+    gate.setSink([&](const CaptureFrame& f) { sent.push_back(f.firstSample); });
+    auto frames = toFrames(x);
+    for (auto& f : frames) gate.process(f);
+
+    TEST_ASSERT_TRUE(sent.size() > 8);
+    // Contiguous, in order, and starting up to 8 frames before the onset
+    for (size_t i = 1; i < sent.size(); i++) TEST_ASSERT_EQUAL_UINT32(sent[i - 1] + FRAME, sent[i]);
+    uint32_t onset = RATE;
+    TEST_ASSERT_TRUE(sent.front() <= onset && sent.front() + 9 * FRAME >= onset);
+
+    // Most of the 3 s was silence
+    float suppressed = gate.suppressedPercent();
+    printf("suppressed %.1f%%\n", suppressed);
+    TEST_ASSERT_FLOAT_WITHIN(8.0f, 100.0f * (1.0f - (float)sent.size() / frames.size()), suppressed);
+    TEST_ASSERT_GREATER_THAN_FLOAT(50.0f, suppressed);
+}
+
+void test_gate_reset_drops_preroll() {
+    UplinkGate gate(4);
+    TEST_ASSERT_TRUE(gate.begin(RATE));
+    std::vector<float> quiet(FRAME * 6, 0.0f);
+    addNoise(quiet, 50.0f, 9, false);
+    for (auto& f : toFrames(quiet)) gate.process(f);
+    gate.reset();
+
+    std::vector<float> loud(FRAME * 6, 0.0f);
+    addNoise(loud, 50.0f, 10, false);
+    addVowel(loud, 0, loud.size(), 2000.0f);
+    size_t sent = 0;
+    gate.setSink([&](const CaptureFrame&) { sent++; });
+    for (auto& f : toFrames(loud)) gate.process(f);
+
+    // Only frames from after the reset (1 stored onset frame + live ones)
+    TEST_ASSERT_TRUE(sent > 0 && sent <= 6);
+}
+
+int main(int argc, char** argv) {
+    UNITY_BEGIN();
+    RUN_TEST(test_detects_speech_in_noise);
+    RUN_TEST(test_ignores_loud_stationary_noise);
+    RUN_TEST(test_seeded_floor_detects_first_word);
+    RUN_TEST(test_gate_sends_preroll_then_speech_in_order);
+    RUN_TEST(test_gate_reset_drops_preroll);
+    return UNITY_END();
+}